@@ -0,0 +1,88 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include "AttributeRuns.hpp"
+
+// Сравнивает прежние декораторы, оборачивавшие весь текст в теги, с
+// деревом отрезков форматирования.
+// Использование: attribute_runs_benchmark [размер в МБ] [операций]
+
+namespace {
+
+// Прежние ItalicDecorator/BoldDecorator/ColorDecorator: getFormattedText()
+// и getText() копировали весь документ на каждом уровне
+QString legacyFormatted(const QString& text) {
+    QString result = QString("<font color='%1'>%2</font>").arg("#0000ff").arg(text);
+    result = QString("<i>%1</i>").arg(result);
+    return QString("<b>%1</b>").arg(result);
+}
+
+QString legacyText(const QString& formatted) {
+    QString result = formatted;
+    result.remove("<b>");
+    result.remove("</b>");
+    result.remove("<i>");
+    result.remove("</i>");
+    static QRegularExpression colorTagRegex("<font color='[^']*'>(.*?)</font>",
+                                            QRegularExpression::DotMatchesEverythingOption);
+    QRegularExpressionMatch match = colorTagRegex.match(result);
+    return match.hasMatch() ? match.captured(1) : result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    int megabytes = argc > 1 ? std::atoi(argv[1]) : 16;
+    int operations = argc > 2 ? std::atoi(argv[2]) : 200000;
+    const int length = megabytes * 1024 * 1024;
+
+    QString text(length, QLatin1Char('x'));
+    std::printf("Document: %d MB, %d operations\n", megabytes, operations);
+
+    QElapsedTimer timer;
+    timer.start();
+    int checksum = 0;
+    for (int i = 0; i < 10; ++i) {
+        checksum += legacyText(legacyFormatted(text)).size();
+    }
+    std::printf("%-26s %8.2f ms per read (%d)\n", "Tag-wrapping decorators",
+                timer.elapsed() / 10.0, checksum);
+
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> position(0, length - 1);
+    AttributeRuns attributes(length);
+
+    timer.restart();
+    for (int i = 0; i < operations; ++i) {
+        int start = position(random);
+        bool bold = i % 2 == 0;
+        attributes.apply(start, 64, [bold](TextStyle& style) { style.bold = bold; });
+    }
+    qint64 applyMs = timer.elapsed();
+
+    timer.restart();
+    qint64 runsSeen = 0;
+    for (int i = 0; i < operations; ++i) {
+        runsSeen += attributes.query(position(random), 256).size();
+    }
+    qint64 queryMs = timer.elapsed();
+
+    timer.restart();
+    for (int i = 0; i < operations; ++i) {
+        attributes.edit(position(random), 1, 2);
+    }
+    qint64 editMs = timer.elapsed();
+
+    std::printf("%-26s %d runs\n", "Attribute runs", attributes.runCount());
+    std::printf("  apply  %8lld ms  %10.0f ops/s\n", static_cast<long long>(applyMs),
+                applyMs ? operations * 1000.0 / applyMs : 0.0);
+    std::printf("  query  %8lld ms  %10.0f ops/s (%lld runs)\n", static_cast<long long>(queryMs),
+                queryMs ? operations * 1000.0 / queryMs : 0.0, static_cast<long long>(runsSeen));
+    std::printf("  edit   %8lld ms  %10.0f ops/s\n", static_cast<long long>(editMs),
+                editMs ? operations * 1000.0 / editMs : 0.0);
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "BatchConverter.hpp"
+
+// Измеряет масштабирование пакетного преобразования HTML -> TXT по числу
+// потоков. Использование: batch_convert_benchmark [число файлов] [размер файла в КБ]
+
+namespace {
+
+void generateFiles(const QString& directory, int count, int kilobytes) {
+    QByteArray html = "<!DOCTYPE html>\n<html><body>\n";
+    for (int i = 0; html.size() < kilobytes * 1024; ++i) {
+        html += "<p>Paragraph " + QByteArray::number(i) +
+                " with <b>bold</b> &amp; <i>italic</i> text.</p>\n";
+    }
+    html += "</body></html>\n";
+
+    for (int i = 0; i < count; ++i) {
+        QFile file(QString("%1/doc%2.html").arg(directory).arg(i));
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(html);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    int count = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int kilobytes = argc > 2 ? std::atoi(argv[2]) : 64;
+
+    QTemporaryDir input;
+    QTemporaryDir output;
+    generateFiles(input.path(), count, kilobytes);
+    std::printf("Batch: %d files of %d KB\n", count, kilobytes);
+
+    int maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+    for (int threads = 1; threads <= qMax(1, maxThreads); threads *= 2) {
+        BatchOptions options;
+        options.inputDirectory = input.path();
+        options.outputDirectory = output.path();
+        options.targetFormat = DocumentFormat::PlainText;
+        options.threads = threads;
+
+        BatchResult result = BatchConverter(options).run();
+        std::printf("%3d threads  %8lld ms  %9.1f files/s  %8.1f MB/s\n", threads,
+                    static_cast<long long>(result.elapsedMs), result.filesPerSecond(),
+                    result.megabytesPerSecond());
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include "ContentHash.hpp"
+
+// Сравнивает полное сравнение буфера с текстом файла и проверки по хэшу
+// фрагментов: пересчет после правки, "изменен ли документ" и поиск
+// измененных областей.
+// Использование: content_hash_benchmark [размер в МБ] [правок]
+
+namespace {
+
+QString generateText(int megabytes) {
+    const int targetSize = megabytes * 1024 * 1024;
+    QString text;
+    text.reserve(targetSize);
+    for (int line = 0; text.size() < targetSize; ++line) {
+        text += QStringLiteral("%1 Lorem ipsum dolor sit amet, consectetur adipiscing elit\n").arg(line);
+    }
+    text.truncate(targetSize);
+    return text;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    int megabytes = argc > 1 ? std::atoi(argv[1]) : 32;
+    int edits = argc > 2 ? std::atoi(argv[2]) : 10000;
+
+    QString saved = generateText(megabytes);
+    QString text = saved;
+    std::printf("Document: %d MB, %d edits\n", megabytes, edits);
+
+    QElapsedTimer timer;
+    timer.start();
+    ContentHash hash;
+    hash.reset(text);
+    hash.markSaved();
+    qint64 buildMs = timer.elapsed();
+    std::printf("Initial hash     %8lld ms (%.0f MB/s), %d chunks\n", static_cast<long long>(buildMs),
+                buildMs ? megabytes * 1000.0 / buildMs : 0.0, hash.chunks().size());
+
+    // Набор символов в случайных местах документа
+    std::mt19937 random(1);
+    auto read = [&text](int start, int length) { return text.mid(start, length); };
+    timer.restart();
+    for (int i = 0; i < edits; ++i) {
+        int position = static_cast<int>(random() % (text.size() + 1));
+        text.insert(position, QLatin1Char('x'));
+        hash.edit(position, 0, 1, text.size(), read);
+    }
+    qint64 editNs = timer.nsecsElapsed();
+    std::printf("Incremental edit %8.2f us/edit\n", double(editNs) / edits / 1000.0);
+
+    const int checks = 100;
+    timer.restart();
+    int differing = 0;
+    for (int i = 0; i < checks; ++i) {
+        differing += text != saved;
+    }
+    double compareMs = double(timer.nsecsElapsed()) / checks / 1e6;
+
+    timer.restart();
+    int dirty = 0;
+    for (int i = 0; i < checks; ++i) {
+        dirty += hash.isDirty();
+    }
+    double dirtyMs = double(timer.nsecsElapsed()) / checks / 1e6;
+
+    timer.restart();
+    int regions = hash.changedRegions().size();
+    qint64 regionsMs = timer.elapsed();
+
+    std::printf("Full compare     %8.3f ms/check\n", compareMs);
+    std::printf("Hash dirty check %8.3f ms/check\n", dirtyMs);
+    std::printf("Changed regions  %8lld ms (%d regions)\n", static_cast<long long>(regionsMs), regions);
+    std::printf("(checksum %d)\n", differing + dirty);
+    return 0;
+}
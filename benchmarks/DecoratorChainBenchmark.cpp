@@ -0,0 +1,95 @@
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QTextEdit>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include "DecoratedText.hpp"
+
+// Сравнивает цепочку TextDecorator (shared_ptr и виртуальный вызов на
+// каждом уровне) с шаблонной Decorated<SimpleTextEdit, Italic, Color, Bold>.
+// Использование: decorator_chain_benchmark [размер в МБ] [операций]
+
+namespace {
+
+QString generateText(int megabytes) {
+    const qint64 targetSize = qint64(megabytes) * 1024 * 1024;
+    QString text;
+    text.reserve(static_cast<int>(targetSize));
+    for (int line = 0; text.size() < targetSize; ++line) {
+        text += QStringLiteral("%1 Lorem ipsum dolor sit amet, consectetur adipiscing elit\n").arg(line);
+    }
+    return text;
+}
+
+struct Timing {
+    qint64 setTextMs;
+    qint64 applyMs;
+    qint64 readMs;
+    int outputSize;
+};
+
+// Format - функция, форматирующая диапазон всеми уровнями цепочки
+template <typename Format>
+Timing measure(TextComponent& component, Format format, const QString& text, int operations) {
+    Timing timing;
+    QElapsedTimer timer;
+    timer.start();
+    component.setText(text);
+    timing.setTextMs = timer.elapsed();
+
+    std::mt19937 random(3);
+    std::uniform_int_distribution<int> position(0, text.size() - 1);
+    timer.restart();
+    for (int i = 0; i < operations; ++i) {
+        format(position(random), 32);
+    }
+    timing.applyMs = timer.elapsed();
+
+    timer.restart();
+    timing.outputSize = component.getFormattedText().size();
+    timing.readMs = timer.elapsed();
+    return timing;
+}
+
+void report(const char* name, const Timing& timing) {
+    std::printf("%-22s setText %7lld ms  format %7lld ms  getFormattedText %7lld ms  (%d chars)\n", name,
+                static_cast<long long>(timing.setTextMs), static_cast<long long>(timing.applyMs),
+                static_cast<long long>(timing.readMs), timing.outputSize);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    int megabytes = argc > 1 ? std::atoi(argv[1]) : 4;
+    int operations = argc > 2 ? std::atoi(argv[2]) : 100000;
+
+    QString text = generateText(megabytes);
+    std::printf("Document: %d MB, %d formatted ranges\n", megabytes, operations);
+
+    {
+        QTextEdit editor;
+        auto simple = std::make_shared<SimpleTextEdit>(&editor);
+        auto italic = std::make_shared<ItalicDecorator>(simple);
+        auto color = std::make_shared<ColorDecorator>(italic);
+        BoldDecorator bold(color);
+        report("TextDecorator chain", measure(bold, [&](int start, int length) {
+            italic->applyTo(start, length);
+            color->applyTo(start, length);
+            bold.applyTo(start, length);
+        }, text, operations));
+    }
+    {
+        QTextEdit editor;
+        Decorated<SimpleTextEdit, Italic, Color, Bold> decorated(&editor);
+        report("Decorated<...>", measure(decorated, [&](int start, int length) {
+            decorated.applyTo(start, length);
+        }, text, operations));
+    }
+    return 0;
+}
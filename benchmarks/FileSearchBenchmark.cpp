@@ -0,0 +1,106 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "FileSearch.hpp"
+
+// Измеряет поиск по синтетическому дереву файлов: последовательное чтение
+// с QString::indexOf против FileSearch на разном числе потоков, литерал и
+// регулярное выражение. Дерево создается, если каталога еще нет; каждый
+// двадцатый файл двоичный. Повторный запуск идет по кэшу страниц.
+// Использование: file_search_benchmark [каталог] [размер в ГБ]
+
+namespace {
+
+const int fileSize = 1024 * 1024;
+const int filesPerDirectory = 100;
+
+void generateTree(const QString& root, int gigabytes) {
+    QByteArray text;
+    for (int line = 0; text.size() < fileSize; ++line) {
+        text += QByteArray::number(line) + " Lorem ipsum dolor sit amet, consectetur adipiscing elit\n";
+        if (line % 5000 == 0) text += "an occasional needle in the haystack\n";
+    }
+    text.truncate(fileSize);
+    QByteArray binary = text;
+    binary[100] = '\0';
+
+    const int count = gigabytes * 1024;
+    for (int i = 0; i < count; ++i) {
+        QString directory = QString("%1/dir%2").arg(root).arg(i / filesPerDirectory);
+        if (i % filesPerDirectory == 0) QDir().mkpath(directory);
+        QFile file(QString("%1/file%2.txt").arg(directory).arg(i));
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(i % 20 == 19 ? binary : text);
+        }
+    }
+}
+
+void baseline(const QString& root, const QString& pattern) {
+    QElapsedTimer timer;
+    timer.start();
+    qint64 bytes = 0;
+    int matches = 0;
+    QDirIterator it(root, QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QFile file(it.next());
+        if (!file.open(QIODevice::ReadOnly)) continue;
+        QString text = QString::fromUtf8(file.readAll());
+        bytes += file.size();
+        for (int from = text.indexOf(pattern); from >= 0; from = text.indexOf(pattern, from + pattern.size())) {
+            ++matches;
+        }
+    }
+    qint64 ms = timer.elapsed();
+    std::printf("%-26s %8lld ms  %8.0f MB/s  %d matches\n", "readAll + indexOf, 1 thread",
+                static_cast<long long>(ms), ms ? bytes / (1024.0 * 1024.0) * 1000.0 / ms : 0.0, matches);
+}
+
+void measure(const QString& root, const TextSearch& search, const char* name, int threads) {
+    FileSearchSummary summary;
+    FileSearch fileSearch([](quint64, const QVector<FileMatch>&) {},
+                          [&summary](quint64, const FileSearchSummary& result) { summary = result; });
+    FileSearchOptions options;
+    options.directories.append(root);
+    options.threads = threads;
+    options.maxMatches = 1 << 30;
+    fileSearch.start(QVector<OpenBuffer>(), options, search);
+    fileSearch.wait();
+
+    std::printf("%-12s %2d threads %8lld ms  %8.0f MB/s  %d matches, %d binary skipped\n", name, threads,
+                static_cast<long long>(summary.elapsedMs),
+                summary.elapsedMs ? summary.bytes / (1024.0 * 1024.0) * 1000.0 / summary.elapsedMs : 0.0,
+                summary.matches, summary.binaryFiles);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QString root = argc > 1 ? QString::fromLocal8Bit(argv[1]) : QDir::temp().filePath("file_search_tree");
+    int gigabytes = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    if (!QDir(root).exists()) {
+        std::printf("Generating %d GB under %s...\n", gigabytes, qPrintable(root));
+        generateTree(root, gigabytes);
+    }
+    std::printf("Tree: %s\n", qPrintable(root));
+
+    baseline(root, QStringLiteral("needle"));
+    TextSearch literal(QStringLiteral("needle"));
+    SearchOptions regex;
+    regex.regularExpression = true;
+    TextSearch pattern(QStringLiteral("occasional \\w+"), regex);
+
+    int maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+    for (int threads = 1; threads <= qMax(1, maxThreads); threads *= 2) {
+        measure(root, literal, "literal", threads);
+    }
+    measure(root, pattern, "regex", 1);
+    measure(root, pattern, "regex", qMax(1, maxThreads));
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <cstdio>
+#include <cstdlib>
+#include "TextSearch.hpp"
+
+// Сравнивает поиск и замену TextSearch с QString::indexOf, QString::replace
+// и обходом QRegularExpression::globalMatch на большом документе.
+// Использование: find_replace_benchmark [размер в МБ]
+
+namespace {
+
+QString generateText(int megabytes) {
+    const int targetSize = megabytes * 1024 * 1024;
+    QString text;
+    text.reserve(targetSize);
+    for (int line = 0; text.size() < targetSize; ++line) {
+        text += QStringLiteral("%1 Lorem ipsum dolor sit amet, consectetur adipiscing elit\n").arg(line);
+    }
+    text.truncate(targetSize);
+    return text;
+}
+
+void report(const char* name, qint64 ms, int megabytes, int matches) {
+    std::printf("%-24s %8lld ms (%.0f MB/s), %d matches\n", name, static_cast<long long>(ms),
+                ms ? megabytes * 1000.0 / ms : 0.0, matches);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    int megabytes = argc > 1 ? std::atoi(argv[1]) : 64;
+
+    QString text = generateText(megabytes);
+    std::printf("Document: %d MB\n", megabytes);
+
+    // Редкое слово: время уходит на просмотр текста, а не на совпадения
+    const QString rare = QStringLiteral("adipiscing");
+    QElapsedTimer timer;
+    timer.start();
+    int count = 0;
+    for (int from = text.indexOf(rare); from >= 0; from = text.indexOf(rare, from + rare.size())) {
+        ++count;
+    }
+    report("QString::indexOf", timer.elapsed(), megabytes, count);
+
+    TextSearch literal(rare);
+    timer.restart();
+    count = literal.findAll(text).size();
+    report("TextSearch literal", timer.elapsed(), megabytes, count);
+
+    SearchOptions ignoreCase;
+    ignoreCase.caseSensitive = false;
+    TextSearch folded(rare, ignoreCase);
+    timer.restart();
+    count = folded.findAll(text).size();
+    report("TextSearch ignore case", timer.elapsed(), megabytes, count);
+
+    QRegularExpression words(QStringLiteral("\\d+ Lorem"), QRegularExpression::MultilineOption);
+    timer.restart();
+    count = 0;
+    for (QRegularExpressionMatchIterator it = words.globalMatch(text); it.hasNext(); it.next()) {
+        ++count;
+    }
+    report("globalMatch", timer.elapsed(), megabytes, count);
+
+    SearchOptions regex;
+    regex.regularExpression = true;
+    TextSearch pattern(QStringLiteral("\\d+ Lorem"), regex);
+    timer.restart();
+    count = pattern.findAll(text).size();
+    report("TextSearch regex", timer.elapsed(), megabytes, count);
+
+    QString copy = text;
+    timer.restart();
+    copy.replace(QStringLiteral("ipsum"), QStringLiteral("lorem ipsum"));
+    report("QString::replace", timer.elapsed(), megabytes, 0);
+
+    QVector<Replacement> replaced;
+    timer.restart();
+    QString result = TextSearch(QStringLiteral("ipsum")).replaceAll(text, QStringLiteral("lorem ipsum"), &replaced);
+    report("TextSearch replaceAll", timer.elapsed(), megabytes, replaced.size());
+    std::printf("(result %s)\n", result == copy ? "ok" : "FAILED");
+    return 0;
+}
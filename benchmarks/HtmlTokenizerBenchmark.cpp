@@ -0,0 +1,73 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <cstdio>
+#include <cstdlib>
+#include "HtmlTokenizer.hpp"
+
+// Сравнивает однопроходный HtmlTokenizer с прежней реализацией на регулярных
+// выражениях. Использование: html_tokenizer_benchmark [размер в МБ]
+
+namespace {
+
+// Прежняя реализация HtmlDocumentAdapter::stripHtmlTags
+QString legacyStripHtmlTags(const QString& htmlText) {
+    QString text = htmlText;
+    text.remove(QRegularExpression(R"(<!DOCTYPE[^>]*>|<!--[\s\S]*?-->)"));
+    text.remove(QRegularExpression(R"(<style[^>]*>.*?</style>)", QRegularExpression::DotMatchesEverythingOption));
+    text.remove(QRegularExpression(R"(<[^>]*>)"));
+    text.replace("&amp;", "&");
+    text.replace("&lt;", "<");
+    text.replace("&gt;", ">");
+    text.replace("&quot;", "\"");
+    text.replace("&nbsp;", " ");
+    return text.simplified();
+}
+
+QString generateHtml(int megabytes) {
+    const qint64 targetSize = qint64(megabytes) * 1024 * 1024;
+    QString html;
+    html.reserve(static_cast<int>(targetSize + 1024));
+    html += "<!DOCTYPE html>\n<html>\n<head><style>p { margin: 0; }</style></head>\n<body>\n";
+    for (int i = 0; html.size() < targetSize; ++i) {
+        html += QStringLiteral("<p class=\"row\">Paragraph %1 with <b>bold</b>, <i>italic</i> &amp; "
+                               "&lt;escaped&gt; text&nbsp;and a <a href=\"#%1\">link</a>.</p>\n"
+                               "<!-- comment %1 -->\n").arg(i);
+    }
+    html += "</body>\n</html>\n";
+    return html;
+}
+
+template <typename Function>
+qint64 measure(Function function, int& outputSize) {
+    QElapsedTimer timer;
+    timer.start();
+    QString result = function();
+    qint64 elapsed = timer.elapsed();
+    outputSize = result.size();
+    return elapsed;
+}
+
+void report(const char* name, qint64 elapsedMs, int outputSize, int megabytes) {
+    double seconds = elapsedMs / 1000.0;
+    std::printf("%-14s %8lld ms  %8.1f MB/s  output %d chars\n", name,
+                static_cast<long long>(elapsedMs), seconds > 0 ? megabytes / seconds : 0.0, outputSize);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    int megabytes = argc > 1 ? std::atoi(argv[1]) : 100;
+
+    QString html = generateHtml(megabytes);
+    std::printf("Document: %d MB of HTML\n", megabytes);
+
+    int outputSize = 0;
+    qint64 tokenizerMs = measure([&]() { return HtmlTokenizer::toPlainText(html); }, outputSize);
+    report("HtmlTokenizer", tokenizerMs, outputSize, megabytes);
+
+    qint64 legacyMs = measure([&]() { return legacyStripHtmlTags(html); }, outputSize);
+    report("regex passes", legacyMs, outputSize, megabytes);
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QPlainTextEdit>
+#include <QTextEdit>
+#include <QScrollBar>
+#include <cstdio>
+#include <cstdlib>
+
+// Сравнивает загрузку и прокрутку большого документа в QTextEdit (текущий
+// режим форматированного текста) и QPlainTextEdit (облегченный режим).
+// Использование: large_file_benchmark [размер в МБ] [шагов прокрутки]
+
+namespace {
+
+QString generateText(int megabytes) {
+    const qint64 targetSize = qint64(megabytes) * 1024 * 1024;
+    QString text;
+    text.reserve(static_cast<int>(targetSize));
+    for (int line = 0; text.size() < targetSize; ++line) {
+        text += QStringLiteral("%1 Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod\n")
+                    .arg(line, 8, 10, QLatin1Char('0'));
+    }
+    return text;
+}
+
+struct Timing {
+    qint64 loadMs;
+    qint64 scrollMs;
+};
+
+template <typename Editor>
+Timing measure(const QString& text, int scrollSteps) {
+    Editor editor;
+    editor.resize(1000, 800);
+    editor.show();
+    QCoreApplication::processEvents();
+
+    QElapsedTimer timer;
+    timer.start();
+    editor.setPlainText(text);
+    // size() дожидается полной компоновки документа
+    editor.document()->size();
+    QCoreApplication::processEvents();
+    Timing timing;
+    timing.loadMs = timer.elapsed();
+
+    QScrollBar* scrollBar = editor.verticalScrollBar();
+    timer.restart();
+    for (int step = 0; step < scrollSteps; ++step) {
+        scrollBar->setValue(static_cast<int>(qint64(scrollBar->maximum()) * step / scrollSteps));
+        editor.viewport()->repaint();
+    }
+    timing.scrollMs = timer.elapsed();
+    return timing;
+}
+
+void report(const char* name, const Timing& timing, int scrollSteps) {
+    std::printf("%-16s load %8lld ms   scroll %8lld ms (%.2f ms/step)\n", name,
+                static_cast<long long>(timing.loadMs), static_cast<long long>(timing.scrollMs),
+                scrollSteps ? double(timing.scrollMs) / scrollSteps : 0.0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    int megabytes = argc > 1 ? std::atoi(argv[1]) : 8;
+    int scrollSteps = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    QString text = generateText(megabytes);
+    std::printf("Document: %d MB, %d scroll steps\n", megabytes, scrollSteps);
+
+    report("QTextEdit", measure<QTextEdit>(text, scrollSteps), scrollSteps);
+    report("QPlainTextEdit", measure<QPlainTextEdit>(text, scrollSteps), scrollSteps);
+    return 0;
+}
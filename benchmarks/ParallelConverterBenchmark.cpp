@@ -0,0 +1,80 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <cstdio>
+#include <climits>
+#include <cstdlib>
+#include <thread>
+#include "ParallelConverter.hpp"
+#include "HtmlTokenizer.hpp"
+
+// Сравнивает последовательное и параллельное преобразование одного большого
+// HTML/XML документа при разном числе потоков.
+// Использование: parallel_converter_benchmark [размер в МБ]
+
+namespace {
+
+QString generateHtml(qint64 targetSize) {
+    QString html;
+    html.reserve(static_cast<int>(targetSize + 1024));
+    html += "<!DOCTYPE html>\n<html><body>\n";
+    for (int i = 0; html.size() < targetSize; ++i) {
+        html += QStringLiteral("<p class=\"row\">Paragraph %1 with <b>bold</b> &amp; <i>italic</i> "
+                               "text.</p><!-- comment -->\n").arg(i);
+    }
+    return html + "</body></html>\n";
+}
+
+QString generateXml(qint64 targetSize) {
+    QString xml;
+    xml.reserve(static_cast<int>(targetSize + 1024));
+    xml += "<?xml version=\"1.0\"?>\n<export>\n";
+    for (int i = 0; xml.size() < targetSize; ++i) {
+        xml += QStringLiteral("  <record id=\"%1\"><name>Record %1</name>"
+                              "<value>Text &amp; more text</value></record>\n").arg(i);
+    }
+    return xml + "</export>\n";
+}
+
+template <typename Function>
+void run(const char* name, int threads, Function function, const QString& expected, double megabytes) {
+    QElapsedTimer timer;
+    timer.start();
+    QString result = function();
+    qint64 elapsed = timer.elapsed();
+    double seconds = elapsed / 1000.0;
+    std::printf("%-5s %3d threads  %8lld ms  %8.1f MB/s  %s\n", name, threads,
+                static_cast<long long>(elapsed), seconds > 0 ? megabytes / seconds : 0.0,
+                result == expected ? "identical" : "MISMATCH");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    int megabytes = argc > 1 ? std::atoi(argv[1]) : 200;
+    const qint64 targetSize = qint64(megabytes) * 1024 * 1024;
+    int maxThreads = qMax(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    QString html = generateHtml(targetSize);
+    QElapsedTimer timer;
+    timer.start();
+    QString expected = HtmlTokenizer::toPlainText(html);
+    std::printf("HTML sequential             %8lld ms\n", static_cast<long long>(timer.elapsed()));
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        ParallelConverter converter(threads);
+        run("HTML", threads, [&]() { return converter.htmlToPlainText(html); }, expected, megabytes);
+    }
+    html.clear();
+    expected.clear();
+
+    QString xml = generateXml(targetSize);
+    ParallelConverter sequential(1, INT_MAX);
+    timer.restart();
+    expected = sequential.xmlToPlainText(xml);
+    std::printf("XML  sequential             %8lld ms\n", static_cast<long long>(timer.elapsed()));
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        ParallelConverter converter(threads);
+        run("XML", threads, [&]() { return converter.xmlToPlainText(xml); }, expected, megabytes);
+    }
+    return 0;
+}
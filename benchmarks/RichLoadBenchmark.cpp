@@ -0,0 +1,103 @@
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextDocument>
+#include <QTextEdit>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include "DocumentAdapter.hpp"
+
+// Сравнивает открытие HTML и RTF в QTextEdit: прежний путь (текст без
+// форматирования через setPlainText) и сборку отдельного QTextDocument с
+// форматированием и последующим setDocument.
+// Использование: rich_load_benchmark [размер в МБ]
+
+namespace {
+
+QString generateHtml(int megabytes) {
+    const qint64 targetSize = qint64(megabytes) * 1024 * 1024;
+    QString html = "<!DOCTYPE html><html><body>\n";
+    html.reserve(static_cast<int>(targetSize + 1024));
+    for (int i = 0; html.size() < targetSize; ++i) {
+        html += QStringLiteral("<p>Paragraph %1 with <b>bold</b>, <i>italic</i> and "
+                               "<font color=\"#c00000\">colored</font> words.</p>\n").arg(i);
+    }
+    html += "</body></html>";
+    return html;
+}
+
+QString generateRtf(int megabytes) {
+    const qint64 targetSize = qint64(megabytes) * 1024 * 1024;
+    QString rtf = "{\\rtf1\\ansi\\deff0{\\colortbl ;\\red192\\green0\\blue0;}\\pard ";
+    rtf.reserve(static_cast<int>(targetSize + 1024));
+    for (int i = 0; rtf.size() < targetSize; ++i) {
+        rtf += QStringLiteral("Paragraph %1 with {\\b bold}, {\\i italic} and "
+                              "{\\cf1 colored} words.\\par\n").arg(i);
+    }
+    rtf += "}";
+    return rtf;
+}
+
+// Время до полной компоновки документа в показанном редакторе
+template <typename Load>
+qint64 measure(Load load) {
+    QTextEdit editor;
+    editor.resize(1000, 800);
+    editor.show();
+    QCoreApplication::processEvents();
+
+    QElapsedTimer timer;
+    timer.start();
+    load(editor);
+    editor.document()->size();
+    QCoreApplication::processEvents();
+    return timer.elapsed();
+}
+
+void compare(const char* name, IDocumentAdapter& adapter, const QString& path) {
+    qint64 plainMs = measure([&](QTextEdit& editor) {
+        editor.setPlainText(adapter.loadDocument(path));
+    });
+    qint64 richMs = measure([&](QTextEdit& editor) {
+        std::unique_ptr<QTextDocument> document(new QTextDocument());
+        adapter.loadIntoDocument(path, document.get());
+        document->setParent(&editor);
+        editor.setDocument(document.release());
+    });
+    std::printf("%-5s setPlainText %8lld ms   builder %8lld ms (%.2fx)\n", name,
+                static_cast<long long>(plainMs), static_cast<long long>(richMs),
+                plainMs > 0 ? double(richMs) / plainMs : 0.0);
+}
+
+bool writeFile(const QString& path, const QString& content) {
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(content.toUtf8()) >= 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    int megabytes = argc > 1 ? std::atoi(argv[1]) : 2;
+
+    QTemporaryDir dir;
+    QString htmlPath = dir.filePath("document.html");
+    QString rtfPath = dir.filePath("document.rtf");
+    if (!dir.isValid() || !writeFile(htmlPath, generateHtml(megabytes)) ||
+        !writeFile(rtfPath, generateRtf(megabytes))) {
+        std::fprintf(stderr, "Failed to write test documents\n");
+        return 1;
+    }
+    std::printf("Documents: %d MB each\n", megabytes);
+
+    HtmlDocumentAdapter html;
+    RtfDocumentAdapter rtf;
+    compare("HTML", html, htmlPath);
+    compare("RTF", rtf, rtfPath);
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <cstdio>
+#include <cstdlib>
+#include "RtfParser.hpp"
+
+// Сравнивает однопроходный RtfParser с прежней реализацией на регулярных
+// выражениях. Использование: rtf_parser_benchmark [размер в МБ]
+
+namespace {
+
+// Прежняя реализация RtfDocumentAdapter::stripRtfFormatting
+QString legacyStripRtfFormatting(const QString& rtfText) {
+    QString text = rtfText;
+    text.remove(QRegularExpression(R"(\{\\rtf1.*?\})"));
+    text.remove(QRegularExpression(R"(\\[a-zA-Z]+[-]?[0-9]*)"));
+    text.remove(QRegularExpression(R"(\{|\})"));
+    text.remove(QRegularExpression(R"(\\[\''][0-9a-fA-F]{2})"));
+    return text.simplified();
+}
+
+QString generateRtf(int megabytes) {
+    const qint64 targetSize = qint64(megabytes) * 1024 * 1024;
+    QString rtf;
+    rtf.reserve(static_cast<int>(targetSize + 1024));
+    rtf += "{\\rtf1\\ansi\\ansicpg1252\\deff0{\\fonttbl{\\f0\\fnil\\fcharset0 Arial;}}\n"
+           "{\\colortbl ;\\red255\\green0\\blue0;}\n\\viewkind4\\uc1\\pard\\f0\\fs24 ";
+    for (int i = 0; rtf.size() < targetSize; ++i) {
+        rtf += QStringLiteral("Paragraph %1 with {\\b bold}, {\\i italic}, caf\\'e9, "
+                              "\\u1055?\\u1088?\\u1080? and \\{braces\\}.\\par\n").arg(i);
+    }
+    rtf += "}";
+    return rtf;
+}
+
+template <typename Function>
+qint64 measure(Function function, int& outputSize) {
+    QElapsedTimer timer;
+    timer.start();
+    QString result = function();
+    qint64 elapsed = timer.elapsed();
+    outputSize = result.size();
+    return elapsed;
+}
+
+void report(const char* name, qint64 elapsedMs, int outputSize, int megabytes) {
+    double seconds = elapsedMs / 1000.0;
+    std::printf("%-14s %8lld ms  %8.1f MB/s  output %d chars\n", name,
+                static_cast<long long>(elapsedMs), seconds > 0 ? megabytes / seconds : 0.0, outputSize);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    int megabytes = argc > 1 ? std::atoi(argv[1]) : 100;
+
+    QString rtf = generateRtf(megabytes);
+    std::printf("Document: %d MB of RTF\n", megabytes);
+
+    int outputSize = 0;
+    qint64 parserMs = measure([&]() { return RtfParser::toPlainText(rtf); }, outputSize);
+    report("RtfParser", parserMs, outputSize, megabytes);
+
+    qint64 legacyMs = measure([&]() { return legacyStripRtfFormatting(rtf); }, outputSize);
+    report("regex passes", legacyMs, outputSize, megabytes);
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "VirtualTextView.hpp"
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QScrollBar>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Измеряет построение индекса строк, плавную прокрутку и переходы к
+// случайным строкам в VirtualTextView. Файл создается во временном каталоге.
+// Использование: virtual_view_benchmark [размер в МБ] [шагов прокрутки] [переходов]
+
+namespace {
+
+QString generateFile(int megabytes) {
+    QString path = QDir::tempPath() + "/virtual_view_benchmark.log";
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return QString();
+
+    const qint64 targetSize = qint64(megabytes) * 1024 * 1024;
+    QByteArray block;
+    for (qint64 line = 0, written = 0; written < targetSize; ++line) {
+        block += QByteArray::number(line).rightJustified(10, '0');
+        block += " INFO worker-3 request handled in 12 ms, status=200 path=/api/v1/items\n";
+        if (block.size() >= (1 << 20)) {
+            file.write(block);
+            written += block.size();
+            block.clear();
+        }
+    }
+    file.write(block);
+    return path;
+}
+
+struct Latency {
+    double averageMs;
+    double maxMs;
+    int slowFrames;  // дольше 16.7 мс, то есть ниже 60 кадров в секунду
+};
+
+template <typename Step>
+Latency measure(VirtualTextView& view, int steps, Step step) {
+    std::vector<double> times;
+    times.reserve(steps);
+    QElapsedTimer timer;
+    for (int i = 0; i < steps; ++i) {
+        timer.start();
+        step(i);
+        view.viewport()->repaint();
+        times.push_back(timer.nsecsElapsed() / 1e6);
+    }
+
+    Latency latency = {0, 0, 0};
+    for (double time : times) {
+        latency.averageMs += time;
+        latency.maxMs = std::max(latency.maxMs, time);
+        if (time > 1000.0 / 60) ++latency.slowFrames;
+    }
+    latency.averageMs /= qMax(1, steps);
+    return latency;
+}
+
+void report(const char* name, const Latency& latency, int steps) {
+    std::printf("%-8s avg %7.3f ms   max %7.3f ms   slow frames %d/%d\n", name,
+                latency.averageMs, latency.maxMs, latency.slowFrames, steps);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    int megabytes = argc > 1 ? std::atoi(argv[1]) : 512;
+    int scrollSteps = argc > 2 ? std::atoi(argv[2]) : 600;
+    int jumps = argc > 3 ? std::atoi(argv[3]) : 200;
+
+    QString path = generateFile(megabytes);
+    if (path.isEmpty()) {
+        std::fprintf(stderr, "Cannot create the test file\n");
+        return 1;
+    }
+
+    {
+        QElapsedTimer timer;
+        timer.start();
+        auto buffer = std::make_shared<LineBuffer>(path);
+        qint64 indexMs = timer.elapsed();
+        std::printf("File: %d MB, %lld lines, index built in %lld ms (%lld KB)\n", megabytes,
+                    static_cast<long long>(buffer->lineCount()), static_cast<long long>(indexMs),
+                    static_cast<long long>(buffer->memoryUsage() / 1024));
+
+        VirtualTextView view;
+        view.resize(1000, 800);
+        view.show();
+        view.setBuffer(buffer);
+        QCoreApplication::processEvents();
+
+        // Прокрутка колесом: по три строки за шаг, как QAbstractScrollArea по умолчанию
+        QScrollBar* scrollBar = view.verticalScrollBar();
+        report("scroll", measure(view, scrollSteps, [scrollBar](int) {
+            scrollBar->setValue(scrollBar->value() + 3);
+        }), scrollSteps);
+
+        std::mt19937_64 random(42);
+        qint64 lineCount = buffer->lineCount();
+        report("jump", measure(view, jumps, [&view, &random, lineCount](int) {
+            view.scrollToLine(static_cast<qint64>(random() % static_cast<quint64>(lineCount)));
+        }), jumps);
+        std::printf("Cached lines: %d\n", view.cachedLineCount());
+    }
+
+    QFile::remove(path);
+    return 0;
+}
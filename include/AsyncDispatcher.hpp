@@ -0,0 +1,94 @@
+#pragma once
+
+#include "DocumentObserver.hpp"
+#include "MpscQueue.hpp"
+#include "WorkStealingPool.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// What happens to a new event when an observer's queue is full
+enum class BackpressurePolicy {
+    DropToLatest,  // events that do not fit collapse into one "whole document changed" event
+    Block,         // the posting thread waits for room
+    Coalesce       // deltas are merged into one pending event
+};
+
+struct ObserverMetrics {
+    int queueDepth = 0;
+    int capacity = 0;
+    quint64 delivered = 0;
+    quint64 dropped = 0;
+    quint64 coalesced = 0;
+    // Time from posting an event to the start of its delivery
+    qint64 lastLagUs = 0;
+    qint64 maxLagUs = 0;
+};
+
+// Delivers document deltas to observers on worker threads.
+//
+// Each observer has its own bounded lock-free queue, so a slow observer
+// only delays itself. At most one pool task drains a queue at a time,
+// which keeps deliveries to one observer ordered and never concurrent.
+// Events that do not fit wait in a small overflow slot that is drained
+// after the queue, so order is kept under every policy.
+class AsyncDispatcher {
+public:
+    AsyncDispatcher(const SnapshotSource& snapshots, int threadCount = 0);
+    ~AsyncDispatcher();
+
+    void subscribe(std::shared_ptr<IDocumentObserver> observer, BackpressurePolicy policy, int capacity);
+    void unsubscribe(const std::shared_ptr<IDocumentObserver>& observer);
+    bool isSubscribed(const std::shared_ptr<IDocumentObserver>& observer) const;
+
+    void dispatch(const QVector<DocumentDelta>& deltas);
+    ObserverMetrics metrics(const std::shared_ptr<IDocumentObserver>& observer) const;
+    // Blocks until every queued event has been delivered
+    void waitIdle();
+
+    // Запрет копирования
+    AsyncDispatcher(const AsyncDispatcher&) = delete;
+    AsyncDispatcher& operator=(const AsyncDispatcher&) = delete;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        QVector<DocumentDelta> deltas;
+        Clock::time_point posted;
+    };
+
+    struct Channel {
+        Channel(std::shared_ptr<IDocumentObserver> observer, BackpressurePolicy policy, int capacity)
+            : observer(std::move(observer)), policy(policy), queue(capacity) {}
+
+        // Как и в DocumentSubject, наблюдатель не продлевается очередью
+        std::weak_ptr<IDocumentObserver> observer;
+        BackpressurePolicy policy;
+        BoundedMpscQueue<Event> queue;
+        std::atomic<bool> scheduled{false};
+        std::atomic<bool> closed{false};
+        // Событие, не поместившееся в очередь; доставляется после нее
+        std::atomic<bool> overflowed{false};
+        std::mutex overflowMutex;
+        Event overflow;
+        std::atomic<quint64> delivered{0};
+        std::atomic<quint64> dropped{0};
+        std::atomic<quint64> coalesced{0};
+        std::atomic<qint64> lastLagUs{0};
+        std::atomic<qint64> maxLagUs{0};
+    };
+
+    void post(const std::shared_ptr<Channel>& channel, Event event);
+    void schedule(const std::shared_ptr<Channel>& channel);
+    void drain(const std::shared_ptr<Channel>& channel);
+    void deliver(Channel& channel, const Event& event);
+    std::shared_ptr<Channel> find(const std::shared_ptr<IDocumentObserver>& observer) const;
+
+    SnapshotSource snapshots;
+    mutable std::mutex channelsMutex;
+    std::vector<std::shared_ptr<Channel>> channels;
+    WorkStealingPool pool;
+};
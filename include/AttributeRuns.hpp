@@ -0,0 +1,87 @@
+#pragma once
+
+#include "RichTextBuilder.hpp"
+#include <QVector>
+#include <functional>
+#include <vector>
+
+// Character formatting of a text buffer as a sequence of style runs.
+//
+// Runs are kept in an implicit treap ordered by buffer offset, each node
+// storing its run length and the total length of its subtree, so finding an
+// offset, splitting a run and joining runs cost O(log n). Applying or
+// querying formatting over a range touches O(log n + k) nodes for the k runs
+// it covers. Adjacent runs with equal styles are always merged.
+class AttributeRuns {
+public:
+    using StyleChange = std::function<void(TextStyle& style)>;
+
+    AttributeRuns();
+    // One run of the default style
+    explicit AttributeRuns(int length);
+    // Runs as produced by HtmlTokenizer::toRichText() and RtfParser::toRichText()
+    AttributeRuns(const QVector<TextFormatRun>& runs, int length);
+
+    int length() const;
+    int runCount() const;
+    // Incremented by every change to the runs or to the length they cover
+    quint64 revision() const { return changes; }
+    void clear();
+
+    // Inserted characters take the style of the character before them (the
+    // first character's style at offset 0), as typed text does
+    void insert(int position, int length);
+    void insert(int position, int length, const TextStyle& style);
+    void remove(int position, int length);
+    // Mirrors QTextDocument::contentsChange; removed is clamped to the buffer
+    void edit(int position, int removed, int added);
+
+    void apply(int start, int length, const StyleChange& change);
+    void setStyle(int start, int length, const TextStyle& style);
+
+    TextStyle styleAt(int position) const;
+    // Runs overlapping the range; the first one starts at start
+    QVector<TextFormatRun> query(int start, int length) const;
+    QVector<TextFormatRun> runs() const { return query(0, length()); }
+    // Bytes held by the node pool
+    qint64 memoryUsage() const;
+
+private:
+    static constexpr int nil = -1;
+
+    struct Node {
+        int left;
+        int right;
+        unsigned priority;
+        int length;
+        int total;
+        TextStyle style;
+    };
+
+    int allocate(int length, const TextStyle& style);
+    void release(int node);
+    void releaseTree(int node);
+    void update(int node);
+    int total(int node) const { return node == nil ? 0 : nodes[node].total; }
+
+    // Splits at a buffer offset, cutting the run that contains it in two
+    void split(int node, int position, int& left, int& right);
+    int merge(int left, int right);
+    // Merges and joins the boundary runs if their styles are equal
+    int join(int left, int right);
+    // Builds a subtree of the given runs in O(k), left to right
+    int build(const std::vector<int>& order);
+    int updateTotals(int node);
+    void collect(int node, std::vector<int>& order) const;
+    void collectRange(int node, int offset, int start, int end, QVector<TextFormatRun>& out) const;
+    void grow(int node, int position, int length);
+    int first(int node) const;
+    int last(int node) const;
+    void growLast(int node, int length);
+
+    std::vector<Node> nodes;
+    std::vector<int> freeNodes;
+    int root;
+    unsigned seed;
+    quint64 changes;
+};
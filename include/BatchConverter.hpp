@@ -0,0 +1,63 @@
+#pragma once
+
+#include "FormatRegistry.hpp"
+#include <QString>
+#include <QStringList>
+#include <condition_variable>
+#include <mutex>
+
+struct BatchOptions {
+    QString inputDirectory;
+    QString outputDirectory;
+    DocumentFormat targetFormat = DocumentFormat::PlainText;
+    int threads = 0;                              // 0 - all hardware threads
+    qint64 maxBytesInFlight = 256 * 1024 * 1024;  // input bytes loaded at once
+};
+
+struct BatchResult {
+    int converted = 0;
+    int failed = 0;
+    qint64 bytes = 0;
+    qint64 elapsedMs = 0;
+    QStringList errors;
+
+    double filesPerSecond() const;
+    double megabytesPerSecond() const;
+};
+
+// Converts every file under the input directory to the target format.
+//
+// Each file is loaded with the adapter of its detected format and saved with
+// the adapter of the target format on a work-stealing pool; the relative
+// path is kept and the extension replaced. Files that would get the same
+// output name keep their source extension (a.html.txt, a.rtf.txt); run()
+// throws std::runtime_error if names still collide. The total size of files
+// being converted at once is limited by maxBytesInFlight, so memory use does
+// not grow with the size of the batch.
+class BatchConverter {
+public:
+    explicit BatchConverter(const BatchOptions& options);
+
+    BatchResult run();
+
+    // Запрет копирования
+    BatchConverter(const BatchConverter&) = delete;
+    BatchConverter& operator=(const BatchConverter&) = delete;
+
+private:
+    struct Job {
+        QString inputPath;
+        QString outputPath;
+        qint64 size;
+    };
+
+    QList<Job> collectJobs() const;
+    void convert(const Job& job, BatchResult& result);
+    void acquire(qint64 bytes);
+    void release(qint64 bytes);
+
+    BatchOptions options;
+    std::mutex mutex;
+    std::condition_variable budgetAvailable;
+    qint64 bytesInFlight;
+};
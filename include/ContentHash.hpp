@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <functional>
+
+// Chunked hash of a text buffer for cheap comparisons with the saved file.
+//
+// The text is cut into content-defined chunks: a rolling gear hash of the
+// last characters decides where a chunk ends, so an edit moves only the
+// boundaries near it and the chunks after it keep their hashes. Each chunk
+// is hashed with XXH64 and the document hash is the XXH64 of the chunk
+// hashes. edit() rehashes the chunks from the one containing the edit until
+// the boundaries line up with the old ones again, reading only that part of
+// the text. The chunks at load or save time are kept as the saved state, so
+// dirty checks and locating changed regions never look at the text itself.
+class ContentHash {
+public:
+    struct Chunk {
+        int start;
+        int length;
+        quint64 hash;
+    };
+
+    struct Region {
+        int start;
+        int length;
+    };
+
+    // Returns length characters of the current text starting at start
+    using TextReader = std::function<QString(int start, int length)>;
+
+    // averageChunk is rounded down to a power of two
+    explicit ContentHash(int minChunk = 2048, int averageChunk = 8192, int maxChunk = 65536);
+
+    void reset(const QString& text);
+    // Mirrors QTextDocument::contentsChange; newLength is the text length
+    // after the edit
+    void edit(int position, int removed, int added, int newLength, const TextReader& read);
+
+    int length() const { return totalLength; }
+    const QVector<Chunk>& chunks() const { return current; }
+    quint64 documentHash() const;
+
+    // The current text is what the file holds
+    void markSaved();
+    quint64 savedHash() const { return savedDocumentHash; }
+    bool isDirty() const { return documentHash() != savedDocumentHash; }
+    // Whether a text, e.g. the file read again, equals the saved text
+    bool matchesSaved(const QString& text) const;
+    // Ranges of the current text that differ from the saved text; a removal
+    // that left no changed chunk is reported as an empty region
+    QVector<Region> changedRegions() const;
+
+    // XXH64 of a byte range
+    static quint64 hashBytes(const void* data, size_t length, quint64 seed = 0);
+
+private:
+    // Length of the chunk starting at data; available characters follow it
+    int cut(const QChar* data, int available) const;
+    void chunkText(const QChar* data, int length, int offset, QVector<Chunk>& out) const;
+    static quint64 combine(const QVector<Chunk>& chunks);
+
+    int minChunk;
+    int maxChunk;
+    quint64 boundaryMask;
+    int totalLength;
+    QVector<Chunk> current;
+    QVector<Chunk> saved;
+    quint64 savedDocumentHash;
+    mutable quint64 cachedHash;
+    mutable bool hashValid;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "TextDecorator.hpp"
+#include <initializer_list>
+#include <utility>
+
+// Formatting policies for Decorated<>; each sets one attribute of a style
+struct Italic {
+    void decorate(TextStyle& style) const { style.italic = true; }
+};
+
+struct Bold {
+    void decorate(TextStyle& style) const { style.bold = true; }
+};
+
+struct Color {
+    QColor color = Qt::blue;
+    void decorate(TextStyle& style) const { style.color = color; }
+};
+
+// Decorator stack fixed at compile time, e.g. Decorated<SimpleTextEdit, Italic, Bold>.
+//
+// Equivalent to wrapping Base in one TextDecorator per policy, without the
+// shared_ptr chain and the virtual call per layer: the class is final, so
+// calls through it bind directly to Base, and all policies are applied to
+// each run in a single pass over the range.
+template <typename Base, typename... Policies>
+class Decorated final : public Base, public Policies... {
+public:
+    template <typename... Args>
+    explicit Decorated(Args&&... args) : Base(std::forward<Args>(args)...) {}
+
+    void setText(const QString& text) override {
+        Base::setText(text);
+        applyTo(0, Base::getAttributes().length());
+    }
+
+    void applyTo(int start, int length) {
+        Base::applyStyle(start, length, [this](TextStyle& style) { decorate(style); });
+    }
+
+    void decorate(TextStyle& style) const {
+        // Порядок применения совпадает с порядком вложенности декораторов
+        (void)std::initializer_list<int>{ (static_cast<const Policies&>(*this).decorate(style), 0)... };
+    }
+};
@@ -1,6 +1,13 @@
 #pragma once
 
+#include "RichTextBuilder.hpp"
 #include <QString>
+#include <QVector>
+
+class QIODevice;
+class QTextDocument;
+class OutputSink;
+class QXmlStreamReader;
 
 // Abstract Document Adapter
 class IDocumentAdapter {
@@ -8,6 +15,17 @@ public:
     virtual ~IDocumentAdapter() = default;
     virtual QString loadDocument(const QString& filePath) = 0;
     virtual void saveDocument(const QString& filePath, const QString& content) = 0;
+
+    // Text with its format runs. The default returns loadDocument() without
+    // runs; rich formats override it to keep bold, italic and color.
+    virtual QString loadFormatted(const QString& filePath, QVector<TextFormatRun>& runs);
+    // Saves text with its format runs. The default saves the text alone;
+    // rich formats override it to write the runs as markup.
+    virtual void saveFormatted(const QString& filePath, const QString& text, const QVector<TextFormatRun>& runs);
+
+    // Fills an empty document that is not attached to an editor yet with
+    // loadFormatted()
+    void loadIntoDocument(const QString& filePath, QTextDocument* document);
 };
 
 // Plain Text Adapter
@@ -22,10 +40,12 @@ class RtfDocumentAdapter : public IDocumentAdapter {
 public:
     QString loadDocument(const QString& filePath) override;
     void saveDocument(const QString& filePath, const QString& content) override;
+    QString loadFormatted(const QString& filePath, QVector<TextFormatRun>& runs) override;
+    void saveFormatted(const QString& filePath, const QString& text, const QVector<TextFormatRun>& runs) override;
 
 private:
     QString stripRtfFormatting(const QString& rtfText);
-    QString addRtfFormatting(const QString& text);
+    void writeRtf(OutputSink& sink, const QString& text, const QVector<TextFormatRun>& runs);
 };
 
 // HTML Adapter
@@ -33,10 +53,15 @@ class HtmlDocumentAdapter : public IDocumentAdapter {
 public:
     QString loadDocument(const QString& filePath) override;
     void saveDocument(const QString& filePath, const QString& content) override;
+    QString loadFormatted(const QString& filePath, QVector<TextFormatRun>& runs) override;
+    void saveFormatted(const QString& filePath, const QString& text, const QVector<TextFormatRun>& runs) override;
+
+    // Documents longer than this (in characters) are converted in parallel
+    static constexpr int parallelThreshold = 16 * 1024 * 1024;
 
 private:
     QString stripHtmlTags(const QString& htmlText);
-    QString addHtmlTags(const QString& text);
+    void writeHtml(OutputSink& sink, const QString& text, const QVector<TextFormatRun>& runs);
 };
 
 // XML Adapter
@@ -45,7 +70,14 @@ public:
     QString loadDocument(const QString& filePath) override;
     void saveDocument(const QString& filePath, const QString& content) override;
 
+    // Appends every non-blank text run followed by a line break; the loaded
+    // document is this output with surrounding whitespace trimmed in place
+    static void appendTextRuns(QXmlStreamReader& reader, QString& out);
+    static void trimInPlace(QString& text);
+
 private:
-    QString parseXmlContent(const QString& xmlText);
-    QString createXmlContent(const QString& text);
+    // Both directions stream through the device without an intermediate
+    // copy of the whole file
+    QString parseXmlContent(QIODevice* device, qint64 sizeHint);
+    bool writeXmlContent(QIODevice* device, const QString& text);
 };
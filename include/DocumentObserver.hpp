@@ -1,34 +1,135 @@
 #pragma once
 
+#include "SubscriberList.hpp"
 #include <QString>
-#include <vector>
+#include <QVector>
+#include <functional>
+#include <mutex>
 #include <memory>
 
+class AsyncDispatcher;
+enum class BackpressurePolicy;
+struct ObserverMetrics;
+
+// One edit of the document: removed characters at position replaced by inserted
+struct DocumentDelta {
+    // removed value of a delta that replaces the whole document, e.g. when
+    // another document becomes current; observers pull a snapshot instead
+    static constexpr int wholeDocument = -1;
+
+    quint64 revision;
+    int position;
+    int removed;
+    QString inserted;
+
+    bool replacesAll() const { return removed == wholeDocument; }
+};
+
+// Document text at one revision
+struct DocumentSnapshot {
+    quint64 revision;
+    QString text;
+};
+
+// Hands out the document text on demand. The text is read once per
+// revision and the same snapshot is shared by every caller; copies of the
+// source stay safe to use after the subject is gone.
+class SnapshotSource {
+public:
+    SnapshotSource();
+
+    std::shared_ptr<const DocumentSnapshot> snapshot() const;
+    quint64 revision() const;
+
+private:
+    friend class DocumentSubject;
+
+    struct State {
+        std::mutex mutex;
+        std::function<QString()> provider;
+        quint64 revision = 0;
+        std::shared_ptr<const DocumentSnapshot> cached;
+    };
+
+    std::shared_ptr<State> state;
+};
+
 // Observer interface
 class IDocumentObserver {
 public:
     virtual ~IDocumentObserver() = default;
     virtual void update(const QString& content) = 0;
+    // Edits made since the previous frame, coalesced, oldest first. The
+    // default pulls the whole text and passes it to update().
+    virtual void changed(const QVector<DocumentDelta>& deltas, const SnapshotSource& snapshots);
 };
 
 // Subject interface
 class IDocumentSubject {
 public:
     virtual ~IDocumentSubject() = default;
-    virtual void attach(std::shared_ptr<IDocumentObserver> observer) = 0;
+    // Observers are held weakly; a destroyed observer is simply skipped
+    virtual Subscription attach(std::shared_ptr<IDocumentObserver> observer) = 0;
     virtual void detach(std::shared_ptr<IDocumentObserver> observer) = 0;
     virtual void notify(const QString& content) = 0;
+
+    // Queues an edit; nothing is delivered until flush()
+    virtual void post(int position, int removed, const QString& inserted) = 0;
+    // Queues a replacement of the whole document
+    virtual void replaceAll() = 0;
+    // Delivers the queued edits, called once per frame
+    virtual void flush() = 0;
+    virtual SnapshotSource snapshots() const = 0;
 };
 
 // Concrete Subject
+//
+// Edits are queued as deltas and delivered to the observers once per frame.
+// Consecutive typing, backspacing and forward deletion merge into one
+// delta, so notification costs O(edit) regardless of the document size;
+// observers that need the whole text pull it from the snapshot source.
+// Observers may attach and detach from any thread, also during delivery.
+//
+// Observers attached with attachAsync() receive the same deltas on worker
+// threads (see AsyncDispatcher). The snapshot provider is then called on
+// those threads too and has to be safe to call from them.
 class DocumentSubject : public IDocumentSubject {
 public:
-    void attach(std::shared_ptr<IDocumentObserver> observer) override;
+    DocumentSubject();
+    ~DocumentSubject() override;
+
+    Subscription attach(std::shared_ptr<IDocumentObserver> observer) override;
     void detach(std::shared_ptr<IDocumentObserver> observer) override;
     void notify(const QString& content) override;
 
+    void post(int position, int removed, const QString& inserted) override;
+    void replaceAll() override;
+    void flush() override;
+    SnapshotSource snapshots() const override;
+
+    // Reads the current document text when a snapshot is requested
+    void setSnapshotProvider(std::function<QString()> provider);
+    bool hasPending() const { return !pending.isEmpty(); }
+
+    // Delivers flushed deltas on a worker thread through a bounded queue of
+    // the given capacity; detach() removes the observer as usual
+    void attachAsync(std::shared_ptr<IDocumentObserver> observer, BackpressurePolicy policy, int capacity = 64);
+    ObserverMetrics asyncMetrics(const std::shared_ptr<IDocumentObserver>& observer) const;
+    // Blocks until the async observers have received everything flushed so far
+    void waitForAsync();
+
+    // Запрет копирования
+    DocumentSubject(const DocumentSubject&) = delete;
+    DocumentSubject& operator=(const DocumentSubject&) = delete;
+
 private:
-    std::vector<std::shared_ptr<IDocumentObserver>> observers;
+    bool coalesce(int position, int removed, const QString& inserted);
+    quint64 nextRevision();
+
+    SubscriberList<IDocumentObserver> observers;
+    QVector<DocumentDelta> pending;
+    SnapshotSource source;
+    std::unique_ptr<AsyncDispatcher> dispatcher;
 };
 
 // Concrete Observer
@@ -36,8 +137,15 @@ class TextEditObserver : public IDocumentObserver {
 public:
     TextEditObserver();
     void update(const QString& content) override;
+    // Keeps only the revision; the text is pulled in getLastUpdate()
+    void changed(const QVector<DocumentDelta>& deltas, const SnapshotSource& snapshots) override;
     QString getLastUpdate() const;
+    quint64 lastRevision() const;
 
 private:
-    QString lastUpdate;
-};
\ No newline at end of file
+    // Text passed to update(); released once deltas arrive, so a stale
+    // version of the document is never kept alive
+    std::shared_ptr<const DocumentSnapshot> pushed;
+    quint64 revision;
+    SnapshotSource snapshots;
+};
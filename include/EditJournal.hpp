@@ -0,0 +1,87 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QFile>
+#include <QByteArray>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Write-ahead journal of edits made to one document.
+//
+// Edits are queued by the caller and written by a single background writer
+// shared by all journals; everything queued while the previous batch was on
+// disk is committed with one write and one flush. A checkpoint rewrites the
+// journal as a full snapshot, so recovery replays at most one checkpoint
+// interval of edits.
+class EditJournal : public std::enable_shared_from_this<EditJournal> {
+public:
+    struct Recovery {
+        QString documentPath;
+        QString text;
+        int replayedEdits = 0;
+    };
+    using Loader = std::function<QString(const QString& documentPath)>;
+
+    // The document on disk at documentPath (or an empty text for a new
+    // document) is the base the first edits are applied to
+    static std::shared_ptr<EditJournal> create(const QString& documentPath,
+                                               int checkpointInterval = 500);
+    ~EditJournal();
+
+    static QString journalDirectory();
+    static QStringList pendingJournals();
+
+    // Returns false if the journal holds no unsaved work; throws
+    // std::runtime_error if it cannot be read or its base file has changed
+    static bool recover(const QString& journalPath, const Loader& loader, Recovery& result);
+
+    QString path() const;
+
+    void append(int position, int removed, const QString& inserted);
+    void checkpoint(const QString& text, bool clean = false);
+    // The document matches the file at documentPath again, e.g. after a
+    // save: the file becomes the base of later edits, so the text is not
+    // copied into the journal and there is nothing left to recover
+    void rebase(const QString& documentPath);
+    bool needsCheckpoint() const;
+    void flush();
+    void discard();
+
+    // Запрет копирования
+    EditJournal(const EditJournal&) = delete;
+    EditJournal& operator=(const EditJournal&) = delete;
+
+private:
+    friend class JournalWriter;
+
+    enum class OpKind { Delta, Checkpoint, Rebase, Discard };
+    struct Op {
+        OpKind kind;
+        qint32 position;
+        qint32 removed;
+        QString text;
+        QString documentPath;
+        bool clean;
+        qint64 fileSize = -1;
+        qint64 fileModified = 0;
+    };
+
+    EditJournal(const QString& journalPath, const QString& documentPath, int checkpointInterval);
+    void enqueue(Op op);
+    void writeBatch(const std::vector<Op>& ops);    // writer thread only
+    QByteArray baseRecord() const;
+
+    QString journalPath;
+    QString documentPath;
+    int checkpointInterval;
+    int editsSinceCheckpoint;
+
+    // Состояние, принадлежащее потоку записи
+    QString basePath;
+    qint64 baseFileSize;
+    qint64 baseFileModified;
+    QFile file;
+    bool discarded;
+};
@@ -1,11 +1,13 @@
 #pragma once
 
+#include "SubscriberList.hpp"
 #include <QString>
 #include <QDateTime>
+#include <functional>
 #include <memory>
-#include <vector>
 
 class EditorContext;
+class EditJournal;
 
 // Abstract State
 class IEditorState {
@@ -13,6 +15,7 @@ public:
     virtual ~IEditorState() = default;
     virtual void handleEdit(EditorContext* context, const QString& text) = 0;
     virtual void handleSave(EditorContext* context) = 0;
+    virtual void handleTick(EditorContext* context) {}
     virtual QString getStateName() const = 0;
     
 protected:
@@ -27,6 +30,10 @@ public:
 };
 
 // Context
+//
+// Every content change gets a new revision; saving remembers the revision
+// that was written, so "has unsaved changes" is one comparison. Observers
+// hear about state transitions and status changes, not about every edit.
 class EditorContext {
 public:
     EditorContext();
@@ -34,29 +41,62 @@ public:
     void setState(std::shared_ptr<IEditorState> state);
     void requestEdit(const QString& text);
     void requestSave();
+    void requestTick();
     QString getStatus() const;
+
+    // Reads the current document text when a state needs it; the context
+    // keeps no copy of the text
+    void setTextProvider(std::function<QString()> provider);
+    QString currentText() const;
     QDateTime getLastModified() const;
-    
-    void addStateObserver(std::shared_ptr<IStateObserver> observer);
+
+    // Records a change of the document content without keeping the text
+    void recordEdit();
+    // The content is the saved one, e.g. after a save or after undoing
+    // back to the saved point
+    void markSaved();
+    quint64 getRevision() const { return revision; }
+    quint64 getSavedRevision() const { return savedRevision; }
+    bool isDirty() const { return revision != savedRevision; }
+
+    // Observers are held weakly and may be added from any thread
+    Subscription addStateObserver(std::shared_ptr<IStateObserver> observer);
     void notifyStateChanged();
 
+    void setJournal(std::shared_ptr<EditJournal> journal);
+    std::shared_ptr<EditJournal> getJournal() const;
+
     friend class SavedState;
     friend class ModifiedState;
     friend class AutoSavingState;
     friend class ErrorState;
 
 private:
+    // Switches between Saved and Modified to match the revisions
+    void syncDirtyState();
+    // Runs a state handler and notifies once if the state or status changed
+    void transition(const std::function<void()>& handler);
+
     std::shared_ptr<IEditorState> state;
     std::shared_ptr<IEditorState> previousState;
     QString status;
-    QString content;
+    std::function<QString()> textProvider;
     QDateTime lastModified;
-    std::vector<std::shared_ptr<IStateObserver>> observers;
+    QDateTime lastAutoSave;
+    quint64 revision;
+    quint64 savedRevision;
+    bool deferNotify;
+    std::shared_ptr<EditJournal> journal;
+    SubscriberList<IStateObserver> observers;
 };
 
 // Concrete States
+//
+// States other than ErrorState keep no data of their own, so one shared
+// instance of each serves every context.
 class SavedState : public IEditorState {
 public:
+    static const std::shared_ptr<IEditorState>& getInstance();
     void handleEdit(EditorContext* context, const QString& text) override;
     void handleSave(EditorContext* context) override;
     QString getStateName() const override;
@@ -64,21 +104,26 @@ public:
 
 class ModifiedState : public IEditorState {
 public:
+    static const std::shared_ptr<IEditorState>& getInstance();
     void handleEdit(EditorContext* context, const QString& text) override;
     void handleSave(EditorContext* context) override;
     QString getStateName() const override;
 };
 
+// Unsaved document with a recovery journal; ticks write journal checkpoints
+// so that recovery replays a bounded number of edits
 class AutoSavingState : public IEditorState {
 public:
+    static const std::shared_ptr<IEditorState>& getInstance();
     void handleEdit(EditorContext* context, const QString& text) override;
     void handleSave(EditorContext* context) override;
+    void handleTick(EditorContext* context) override;
     QString getStateName() const override;
 
 private:
-    bool shouldAutoSave() const;
-    QDateTime lastAutoSave;
-    const int autoSaveInterval = 300; // 5 minutes in seconds
+    bool shouldAutoSave(const EditorContext* context) const;
+    void checkpoint(EditorContext* context, const QString& text);
+    static const int autoSaveInterval = 300; // 5 minutes in seconds
 };
 
 class ErrorState : public IEditorState {
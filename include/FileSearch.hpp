@@ -0,0 +1,135 @@
+#pragma once
+
+#include "RetiringThreads.hpp"
+#include "TextSearch.hpp"
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+struct FileSearchOptions {
+    QStringList directories;
+    QStringList nameFilters;   // wildcards such as "*.cpp"; empty - every file
+    int threads = 0;           // 0 - all hardware threads
+    int maxMatches = 100000;   // the search stops after this many matches
+};
+
+// Text of an open tab, searched instead of its file on disk
+struct OpenBuffer {
+    QString path;  // file path, or the tab title of an unsaved document
+    QString text;
+};
+
+struct FileMatch {
+    QString path;
+    int buffer;       // index in the searched open buffers, -1 for a file on disk
+    qint64 line;      // 1-based
+    int column;       // UTF-16 offset in the line
+    int length;
+    QString preview;  // the line around the match, at most previewLength characters
+};
+
+struct FileSearchSummary {
+    int files = 0;
+    int binaryFiles = 0;
+    int unreadableFiles = 0;
+    qint64 bytes = 0;        // read from disk
+    int matches = 0;
+    bool truncated = false;  // stopped at maxMatches
+    qint64 elapsedMs = 0;
+};
+
+// Searches open buffers and the files under directories on a work-stealing pool.
+//
+// A coordinator thread queues the open buffers, then walks the directories
+// and queues every file as soon as it is found, so the pool starts searching
+// before the walk ends. Hidden directories and symbolic links are not
+// followed, and files of open buffers are not read from disk. Files are
+// mapped in windows of windowSize bytes cut at line breaks; a file with a
+// zero byte among its first binaryProbeLength bytes is skipped as binary.
+// Case-sensitive literal patterns are searched in the UTF-8 bytes directly,
+// other patterns decode each window.
+//
+// Matches of a file are delivered in batches on the pool threads, several
+// at once, as soon as the file is done. Starting a new search cancels the
+// running one without waiting for it, as in BackgroundSearch; results of a
+// cancelled search are dropped and its finished handler is not called.
+class FileSearch {
+public:
+    using ResultHandler = std::function<void(quint64 generation, const QVector<FileMatch>& batch)>;
+    using FinishedHandler = std::function<void(quint64 generation, const FileSearchSummary& summary)>;
+
+    static constexpr qint64 windowSize = 16 * 1024 * 1024;
+    static constexpr int binaryProbeLength = 8000;
+    static constexpr int previewLength = 200;
+    // Matches of a large file are delivered at least this often
+    static constexpr int batchSize = 4096;
+
+    FileSearch(ResultHandler resultHandler, FinishedHandler finishedHandler);
+    ~FileSearch();
+
+    // Returns the generation of the new search
+    quint64 start(const QVector<OpenBuffer>& buffers, const FileSearchOptions& options, const TextSearch& search);
+    void cancel();
+    // Blocks until the running search has finished
+    void wait();
+
+    // True if the first bytes of a file contain a zero byte
+    static bool isBinary(const char* data, qint64 length);
+
+    // Запрет копирования
+    FileSearch(const FileSearch&) = delete;
+    FileSearch& operator=(const FileSearch&) = delete;
+
+private:
+    // Состояние одного поиска, общее для координатора и задач пула
+    struct Run {
+        Run(quint64 generation, const QVector<OpenBuffer>& buffers, const FileSearchOptions& options,
+            const TextSearch& search);
+
+        const quint64 generation;
+        const QVector<OpenBuffer> buffers;
+        const FileSearchOptions options;
+        const TextSearch matcher;
+        // Образец в UTF-8 для поиска по байтам; пуст, если текст нужно декодировать
+        QByteArray bytePattern;
+        std::atomic<int> files;
+        std::atomic<int> binaryFiles;
+        std::atomic<int> unreadableFiles;
+        std::atomic<qint64> bytes;
+        std::atomic<int> matches;
+        std::atomic<bool> truncated;
+    };
+
+    void run(std::shared_ptr<Run> state);
+    void searchBuffer(Run& state, int index);
+    void searchFile(Run& state, const QString& path);
+    // Line and column where a window starts: a line longer than a window
+    // continues into the next one
+    struct Position {
+        qint64 line;
+        int column;
+    };
+
+    // Search a window of a file or a whole buffer, appending to found, and
+    // move position to its end; the text after the last match is only
+    // counted when countLines is true
+    void searchBytes(Run& state, const char* data, qint64 length, Position& position, const QString& path,
+                     bool countLines, QVector<FileMatch>& found);
+    void searchChars(Run& state, const QString& text, Position& position, const QString& path, int buffer,
+                     bool countLines, QVector<FileMatch>& found);
+    // Counts a match against maxMatches; false once the limit is reached
+    bool accept(Run& state);
+    void deliver(const Run& state, QVector<FileMatch>& found);
+    bool stopped(const Run& state) const;
+
+    ResultHandler resultHandler;
+    FinishedHandler finishedHandler;
+    std::mutex mutex;
+    RetiringThreads threads;
+    std::atomic<quint64> generation;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "FileSearch.hpp"
+#include <QCheckBox>
+#include <QHash>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QWidget>
+
+// "Find in files" panel shown in a dock.
+//
+// Collects the pattern, directories and name filters and lists the matches
+// grouped by file as they arrive; MainWindow runs the search and opens the
+// activated match.
+class FileSearchPanel : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit FileSearchPanel(QWidget* parent = nullptr);
+
+    QString pattern() const;
+    SearchOptions options() const;
+    // Directories and name filters are separated by ';'
+    FileSearchOptions fileOptions() const;
+    bool searchOpenTabs() const;
+
+    // Focuses the pattern field; a one-line text becomes the pattern
+    void activate(const QString& text = QString());
+    void setDirectory(const QString& directory);
+
+    void clearResults();
+    void addResults(const QVector<FileMatch>& batch);
+    void setSearching(bool searching);
+    void setSummary(const FileSearchSummary& summary);
+    void setError(const QString& message);
+
+signals:
+    void searchRequested();
+    void cancelRequested();
+    void matchActivated(const FileMatch& match);
+
+private:
+    void chooseDirectory();
+
+    QLineEdit* patternEdit;
+    QLineEdit* directoryEdit;
+    QLineEdit* filterEdit;
+    QCheckBox* caseBox;
+    QCheckBox* regexBox;
+    QCheckBox* openTabsBox;
+    QPushButton* searchButton;
+    QTreeWidget* results;
+    QLabel* statusLabel;
+    bool searching;
+
+    // Найденные совпадения; элемент дерева хранит индекс в этом списке
+    QVector<FileMatch> matches;
+    QHash<QString, QTreeWidgetItem*> fileItems;
+};
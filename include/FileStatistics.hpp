@@ -0,0 +1,16 @@
+#pragma once
+
+#include <QString>
+
+struct FileStatistics {
+    qint64 bytes = 0;
+    qint64 chars = 0;
+    qint64 words = 0;
+    qint64 lines = 0;
+};
+
+// Counts a UTF-8 file with TextCounter without loading it whole: the file is
+// mapped one window of chunkSize bytes at a time and each window is decoded
+// into a reused buffer. Sequences split between windows are carried over by
+// the decoder. Throws std::runtime_error if the file cannot be read.
+FileStatistics countFileStatistics(const QString& filePath, int chunkSize = 1 << 20);
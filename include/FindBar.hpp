@@ -0,0 +1,52 @@
+#pragma once
+
+#include "TextSearch.hpp"
+#include <QCheckBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QWidget>
+
+// Find and replace bar shown under the editor tabs.
+//
+// The bar only collects input and shows the match count; MainWindow runs the
+// search and moves the selection.
+class FindBar : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit FindBar(QWidget* parent = nullptr);
+
+    QString pattern() const;
+    QString replacement() const;
+    SearchOptions options() const;
+
+    // Shows the bar with the replace row hidden or shown; text is put into the find field
+    void showFind(const QString& text = QString());
+    void showReplace(const QString& text = QString());
+
+    // total counts the matches found so far while searching is true
+    void setMatchCount(int current, int total, bool searching);
+    void setError(const QString& message);
+
+signals:
+    void searchChanged();
+    void findNext();
+    void findPrevious();
+    void replaceOne();
+    void replaceAll();
+    void closed();
+
+protected:
+    void keyPressEvent(QKeyEvent* event) override;
+
+private:
+    void open(bool withReplace, const QString& text);
+
+    QLineEdit* findEdit;
+    QLineEdit* replaceEdit;
+    QCheckBox* caseBox;
+    QCheckBox* regexBox;
+    QLabel* countLabel;
+    QWidget* replaceRow;
+};
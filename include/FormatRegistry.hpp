@@ -0,0 +1,55 @@
+#pragma once
+
+#include "DocumentAdapter.hpp"
+#include <QString>
+#include <memory>
+#include <vector>
+
+enum class DocumentFormat {
+    PlainText,
+    Html,
+    Xml,
+    Rtf
+};
+
+// Description of a supported format and its shared adapter
+struct FormatInfo {
+    enum Capability {
+        RichText = 0x1       // carries formatting worth showing in a rich editor
+    };
+
+    DocumentFormat format;
+    QString extension;
+    int capabilities;
+    // Адаптеры не хранят состояния, поэтому один экземпляр на формат
+    std::shared_ptr<IDocumentAdapter> adapter;
+
+    bool has(Capability capability) const { return (capabilities & capability) != 0; }
+};
+
+// Registry of document formats.
+//
+// The format of an existing file is detected from a short prefix of its
+// content (byte order mark, <?xml, <!DOCTYPE html / <html, {\rtf), read
+// through a memory mapping without copying; the extension is only used when
+// the content has no recognizable signature or the file does not exist yet.
+class FormatRegistry {
+public:
+    static FormatRegistry& getInstance();
+
+    const FormatInfo& detect(const QString& filePath) const;
+    const FormatInfo& forExtension(const QString& filePath) const;
+    const FormatInfo& info(DocumentFormat format) const;
+
+    // Returns nullptr if the prefix has no known signature
+    const FormatInfo* sniff(const uchar* data, qint64 size) const;
+
+    static constexpr int sniffLength = 512;
+
+private:
+    FormatRegistry();
+    FormatRegistry(const FormatRegistry&) = delete;
+    FormatRegistry& operator=(const FormatRegistry&) = delete;
+
+    std::vector<FormatInfo> formats;
+};
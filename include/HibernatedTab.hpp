@@ -0,0 +1,39 @@
+#pragma once
+
+#include "RichTextBuilder.hpp"
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+// Content of a tab whose document has been released.
+//
+// A clean tab backed by a file keeps only the path and is read again on
+// wake-up; any other tab keeps its text as zlib-compressed UTF-8 together
+// with its format runs.
+class HibernatedTab {
+public:
+    HibernatedTab();
+
+    static HibernatedTab fromFile(const QString& filePath);
+    static HibernatedTab fromText(const QString& text, const QVector<TextFormatRun>& runs = QVector<TextFormatRun>());
+
+    bool hasText() const { return keepsText; }
+    // Decompresses the text; empty for a tab kept as a path
+    QString text() const;
+    const QVector<TextFormatRun>& runs() const { return formatRuns; }
+    QString filePath() const { return path; }
+    int textLength() const { return length; }
+
+    // Bytes held while hibernated
+    qint64 memoryUsage() const;
+
+    int cursorPosition;
+    int scrollPosition;
+
+private:
+    bool keepsText;
+    QString path;
+    QByteArray compressed;
+    QVector<TextFormatRun> formatRuns;
+    int length;
+};
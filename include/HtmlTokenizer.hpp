@@ -0,0 +1,43 @@
+#pragma once
+
+#include "RichTextBuilder.hpp"
+#include <QString>
+#include <QVector>
+
+// Single-pass HTML to plain text converter.
+//
+// Reads the input once with a small state machine: comments, DOCTYPE and
+// processing instructions are skipped, <script>/<style> content is skipped
+// as raw text, block-level elements become line breaks, whitespace runs
+// collapse to one space and named/numeric character references are decoded.
+// The output is written into a single buffer sized to the input, which is
+// an upper bound for the converted text.
+class HtmlTokenizer {
+public:
+    // Converts a whole document; leading and trailing line breaks are dropped
+    static QString toPlainText(const QString& html);
+    // Same text as toPlainText() with the bold, italic and color runs of
+    // b/strong, i/em, font color= and style= on inline elements
+    static QString toRichText(const QString& html, QVector<TextFormatRun>& runs);
+
+    // Appends the text of an HTML fragment to out without trimming
+    static void appendPlainText(const QChar* data, int length, QString& out);
+    // Drops leading and trailing line breaks in place, as toPlainText() does;
+    // returns the number of leading characters removed
+    static int trimLineBreaks(QString& text);
+
+    // Positions of block-level tags roughly chunkSize apart, found by a scan
+    // that only follows markup. Converting the pieces between them separately
+    // and joining the results with joinChunk() gives the same text as
+    // converting the whole document.
+    static QVector<int> findSplitPoints(const QChar* data, int length, int chunkSize);
+    // Appends the converted text of the next piece
+    static void joinChunk(QString& out, const QString& chunk);
+
+    // Lower-case ASCII element name
+    static bool isBlockElement(const char* name);
+
+    // Decodes the body of a character reference ("amp", "#233", "#x1F600");
+    // returns 0 if it is not a known reference
+    static uint decodeEntity(const QChar* name, int length);
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <vector>
+
+// Read-only UTF-8 text addressed by line number.
+//
+// A file is memory-mapped whole and scanned once with memchr. Only every
+// checkpointInterval-th line start is indexed, so the index takes 8 bytes per
+// 64 lines and a line is reached by at most 63 memchr calls from the nearest
+// checkpoint. Lines are decoded only when they are asked for.
+class LineBuffer {
+public:
+    static constexpr int checkpointInterval = 64;
+    // Lines are cut to this many characters when decoded
+    static constexpr int maxLineLength = 1 << 16;
+
+    // Throws std::runtime_error if the file cannot be opened or mapped
+    explicit LineBuffer(const QString& filePath);
+    // Keeps a copy of the UTF-8 data in memory
+    explicit LineBuffer(const QByteArray& utf8);
+    ~LineBuffer();
+
+    // False for UTF-16 files, whose lines cannot be found by scanning bytes
+    static bool canRead(const QString& filePath);
+
+    QString filePath() const { return path; }
+    qint64 size() const { return length; }
+    // Number of line breaks plus one, as QTextDocument::blockCount() counts
+    qint64 lineCount() const { return lines; }
+
+    // Line without its line break (\n or \r\n)
+    QString line(qint64 index) const;
+    // Byte offset of the line start
+    qint64 lineStart(qint64 index) const;
+
+    // Whole text; throws std::runtime_error if it does not fit in a QString
+    QString text() const;
+
+    // Bytes held on the heap: the index and in-memory text, not mapped pages
+    qint64 memoryUsage() const;
+
+    // Запрет копирования
+    LineBuffer(const LineBuffer&) = delete;
+    LineBuffer& operator=(const LineBuffer&) = delete;
+
+private:
+    void buildIndex();
+    qint64 lineEnd(qint64 start) const;
+
+    QString path;
+    QFile file;
+    QByteArray owned;
+    const char* data;
+    qint64 length;
+    qint64 lines;
+    std::vector<qint64> checkpoints;
+};
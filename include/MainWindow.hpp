@@ -8,14 +8,29 @@
 #include <QColorDialog>
 #include <QStatusBar>
 #include <QLabel>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QLockFile>
+#include <QDockWidget>
+#include <QPointer>
 #include <memory>
 #include <mutex>
 #include "TextDecorator.hpp"
-#include "Command.hpp"
 #include "DocumentObserver.hpp"
 #include "TextIterator.hpp"
 #include "EditorState.hpp"
 #include "DocumentAdapter.hpp"
+#include "FormatRegistry.hpp"
+#include "SessionStore.hpp"
+#include "EditJournal.hpp"
+#include "ContentHash.hpp"
+#include "HibernatedTab.hpp"
+#include "VirtualTextView.hpp"
+#include "FindBar.hpp"
+#include "TextSearch.hpp"
+#include "FileSearch.hpp"
+#include "FileSearchPanel.hpp"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -28,6 +43,9 @@ public:
     MainWindow(const MainWindow&) = delete;
     MainWindow& operator=(const MainWindow&) = delete;
 
+    // Inactive tabs idle for this long release their documents; 0 disables
+    void setHibernationDelay(int seconds);
+
 private:
     static MainWindow* instance;
     static std::mutex mutex;
@@ -39,19 +57,61 @@ private:
     void setupToolBar();
     void setupStatusBar();
     void createFileMenu();
+    void createEditMenu();
     void initializeComponents();
     void updateWindowTitle();
     void updateTextStatistics();
     void updateDocumentState();
+    EditorContext* currentContext() const;
     std::shared_ptr<TextComponent> createTextComponent(QTextEdit* textEdit);
+    // Lines are not wrapped in plain-text views of documents above largeFileThreshold
+    QWidget* createEditorWidget(bool plainTextMode = false, qint64 size = 0);
+    int addEditorTab(QWidget* editorWidget, const QString& filePath, const QString& title);
+    void connectDocument(QWidget* editorWidget);
+    void loadIntoEditor(QWidget* editorWidget, const QString& filePath, const FormatInfo& format);
+    void installDocument(QTextEdit* textEdit, std::unique_ptr<QTextDocument> document);
+    static bool usePlainTextMode(const FormatInfo& format, qint64 size);
+    static bool useVirtualView(const QString& filePath, const FormatInfo& format, qint64 size);
+    QString loadDocumentContent(const QString& filePath);
     void openFileAtPath(const QString& filePath);
+    void openVirtualTab(const QString& filePath);
     void saveFileToPath(const QString& path);
     bool hasUnsavedChanges(int index);
+    void markOnDisk(int index, const QString& text);
+    void checkDiskChanges(int index);
     bool confirmClose();
     void removeTab(int index);
     void cleanup();
+    void restoreSession();
+    // Called on close; unmaps the session that unloaded tabs were restored from
+    void writeSession();
+    void hydrateTab(QWidget* widget);
+    void hibernateTab(int index);
+    void wakeTab(QWidget* widget);
+    void hibernateIdleTabs();
+    QString hibernatedText(QWidget* widget);
+    qint64 tabMemoryUsage(int index);
+    void updateTabMemory(int index);
+    void recoverJournals();
+    void startSearch();
+    void onSearchResults(quint64 generation, const QVector<SearchMatch>& batch, bool finished);
+    void selectMatch(int index);
+    void highlightVisibleMatches();
+    void updateMatchCount();
+    void onFileSearchResults(quint64 generation, const QVector<FileMatch>& batch);
+    void onFileSearchFinished(quint64 generation, const FileSearchSummary& summary);
     void applyTextFormat(const std::function<void(QTextEdit*)>& formatter);
     QTextEdit* getCurrentEditor() const;
+    QTextDocument* getCurrentDocument() const;
+
+    // Выше этого размера документ открывается в облегченном режиме без форматирования
+    static const qint64 largeFileThreshold = 2 * 1024 * 1024;
+    // Выше этого размера простой текст только просматривается, без загрузки в документ
+    static const qint64 virtualViewThreshold = 256 * 1024 * 1024;
+    // Столько восстановленных вкладок не больше largeFileThreshold загружается
+    // заранее, по одной за prefetchDelay мс; остальные - при первом показе
+    static const int prefetchLimit = 4;
+    static const int prefetchDelay = 300;
 
     QTabWidget* tabs;
     QToolBar* toolBar;
@@ -71,12 +131,58 @@ private:
 
     QVector<std::shared_ptr<TextComponent>> editors;
     QVector<QString> filePaths;
-    QVector<std::shared_ptr<ITextReceiver>> receivers;
-    QVector<std::vector<std::shared_ptr<ICommand>>> commandHistory;
-    QVector<int> commandIndex;
+    // Формат, определенный по содержимому при открытии; с ним же файл и сохраняется
+    QVector<DocumentFormat> fileFormats;
 
     std::shared_ptr<DocumentSubject> subject;
-    std::shared_ptr<EditorContext> editorContext;
+    // Состояние и счетчик правок у каждого документа свои
+    QVector<std::shared_ptr<EditorContext>> contexts;
+    std::shared_ptr<IStateObserver> stateObserver;
+
+    // Хэш текста и отметка файла на момент загрузки или сохранения
+    struct DiskState {
+        std::shared_ptr<ContentHash> hash;
+        qint64 size;
+        qint64 modified;
+    };
+    QVector<DiskState> diskStates;
+
+    // Восстановление сессии: вкладки без содержимого ждут ленивой загрузки
+    std::unique_ptr<SessionStore> restoreStore;
+    QHash<QWidget*, int> pendingRestore;
+
+    // Спящие вкладки: редактор остается пустым, текст сжат или читается из файла
+    QHash<QWidget*, HibernatedTab> hibernated;
+    QVector<qint64> lastUsed;
+    int hibernationDelay;  // секунды
+
+    // Журналы правок для восстановления после сбоя
+    QVector<std::shared_ptr<EditJournal>> journals;
+    std::unique_ptr<QLockFile> journalLock;
+    QSet<QString> recoveredPaths;
+    QTimer* autoSaveTimer;
+    QTimer* frameTimer;
+    bool suppressJournal;
+
+    // Поиск в текущей вкладке: совпадения приходят из фонового потока пачками
+    FindBar* findBar;
+    std::unique_ptr<BackgroundSearch> backgroundSearch;
+    std::unique_ptr<TextSearch> activeSearch;
+    QVector<SearchMatch> matches;
+    quint64 searchGeneration;
+    bool searchRunning;
+    int currentMatch;
+    QWidget* searchedWidget;
+    QTimer* searchTimer;
+    QMetaObject::Connection scrollConnection;
+
+    // Поиск по файлам и открытым вкладкам в пуле потоков
+    QDockWidget* fileSearchDock;
+    FileSearchPanel* fileSearchPanel;
+    std::unique_ptr<FileSearch> fileSearch;
+    quint64 fileSearchGeneration;
+    // Вкладки, текст которых искался, по номерам буферов в результатах
+    QVector<QPointer<QWidget>> fileSearchTabs;
 
 private slots:
     void newFile();
@@ -91,6 +197,19 @@ private slots:
     void chooseColor();
     void updateActions();
     void onTextChanged();
+    void showFind();
+    void showReplace();
+    void findNext();
+    void findPrevious();
+    void replaceOne();
+    void replaceAll();
+    void clearSearch();
+    void showFindInFiles();
+    void startFileSearch();
+    void cancelFileSearch();
+    void openFileMatch(const FileMatch& match);
+    void prefetchNextTab(int remaining);
+    void autoSaveTick();
 
 protected:
     void closeEvent(QCloseEvent* event) override;
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bounded lock-free queue for many producers and one consumer.
+//
+// A ring of cells, each with a sequence number telling whether it is free
+// for the producer at a position or filled for the consumer (the bounded
+// queue by Dmitry Vyukov). Producers claim a position with one CAS; the
+// consumer needs no atomic read-modify-write at all. The capacity is rounded
+// up to a power of two.
+template <typename T>
+class BoundedMpscQueue {
+public:
+    explicit BoundedMpscQueue(int capacity) : enqueuePos(0), dequeuePos(0) {
+        size_t size = 2;
+        while (size < static_cast<size_t>(capacity)) size <<= 1;
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Returns false without touching value if the queue is full
+    bool tryPush(T&& value) {
+        Cell* cell;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (difference == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (difference < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side only
+    bool tryPop(T& value) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell = &cells[pos & mask];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) < 0) {
+            return false;
+        }
+        value = std::move(cell->value);
+        cell->value = T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        dequeuePos.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate while producers are active
+    int size() const {
+        size_t tail = dequeuePos.load(std::memory_order_acquire);
+        size_t head = enqueuePos.load(std::memory_order_acquire);
+        return head > tail ? static_cast<int>(head - tail) : 0;
+    }
+
+    int capacity() const { return static_cast<int>(mask + 1); }
+
+    // Запрет копирования
+    BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+    BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    // Производители и потребитель пишут в разные строки кэша
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) std::atomic<size_t> dequeuePos;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QByteArray>
+#include <QChar>
+#include <QLatin1String>
+
+class QIODevice;
+
+// Buffered UTF-8 writer over a device.
+//
+// Text is encoded straight into a fixed-size byte buffer which is written to
+// the device whenever it fills up, so an emitter never holds more than one
+// buffer of output. A surrogate pair split between two writes is encoded
+// correctly; unpaired surrogates become U+FFFD.
+class OutputSink {
+public:
+    explicit OutputSink(QIODevice* device, int bufferSize = 64 * 1024);
+    ~OutputSink();
+
+    void write(QLatin1String ascii);
+    void write(const QChar* data, int length);
+    void write(QChar character) { write(&character, 1); }
+
+    // Writes buffered bytes to the device; false if any write failed.
+    // A high surrogate still waiting for its pair is written as U+FFFD
+    bool flush();
+    bool hasError() const { return failed; }
+
+    // Запрет копирования
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+private:
+    void reserve(int bytes);
+    void drain();
+    void encode(uint codePoint);
+
+    QIODevice* device;
+    QByteArray buffer;
+    int used;
+    ushort pendingHighSurrogate;
+    bool failed;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "WorkStealingPool.hpp"
+#include <QString>
+#include <QVector>
+
+// Converts one large HTML or XML document to plain text on several threads.
+//
+// A pre-scan that only follows markup finds split points roughly chunkSize
+// characters apart: block-level tags for HTML, starts of the root element's
+// children for XML. The pieces are converted concurrently and joined in
+// order; the result is identical to the sequential converters.
+class ParallelConverter {
+public:
+    explicit ParallelConverter(int threads = 0, int chunkSize = 4 * 1024 * 1024);
+
+    QString htmlToPlainText(const QString& html);
+
+    // Documents with a DTD, several roots or errors are converted
+    // sequentially, so errors are reported exactly as by XmlDocumentAdapter
+    QString xmlToPlainText(const QString& xml);
+
+    int threadCount() const { return pool.threadCount(); }
+
+    // Split points used for an XML document, empty if it has to be converted
+    // sequentially
+    static QVector<int> findXmlSplitPoints(const QString& xml, int chunkSize,
+                                           int& rootStart, int& rootStartEnd, QString& rootName);
+
+private:
+    WorkStealingPool pool;
+    int chunkSize;
+};
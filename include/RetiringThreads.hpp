@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// The thread of the current background job and of the jobs it replaced.
+//
+// A replaced job is not joined at once: it has to notice that it was
+// cancelled first, and the caller must not wait for that. Its thread is
+// retired and joined by a later call once the job has returned, or by the
+// destructor. Calls are not synchronized; the owner serializes them, usually
+// together with the cancellation of the job it retires.
+class RetiringThreads {
+public:
+    RetiringThreads() = default;
+    // Joins every thread, so the jobs must have been told to stop
+    ~RetiringThreads();
+
+    // Retires the current thread and runs job on a new one
+    void start(std::function<void()> job);
+    // Retires the current thread and joins retired ones that have finished
+    void retire();
+    // Blocks until the current job has returned
+    void wait();
+    // Blocks until every job, current or retired, has returned
+    void joinAll();
+
+    // Запрет копирования
+    RetiringThreads(const RetiringThreads&) = delete;
+    RetiringThreads& operator=(const RetiringThreads&) = delete;
+
+private:
+    struct Worker {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+
+    Worker active;
+    std::vector<Worker> retired;
+};
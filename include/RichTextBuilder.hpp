@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QColor>
+#include <QString>
+#include <QVector>
+
+class QTextDocument;
+
+// Character formatting kept when loading rich formats
+struct TextStyle {
+    bool bold = false;
+    bool italic = false;
+    QColor color;   // недействительный цвет - цвет текста по умолчанию
+
+    bool operator==(const TextStyle& other) const {
+        return bold == other.bold && italic == other.italic && color == other.color;
+    }
+    bool operator!=(const TextStyle& other) const { return !(*this == other); }
+};
+
+// Style of the text from start up to the start of the next run
+struct TextFormatRun {
+    int start;
+    TextStyle style;
+};
+
+// Builds a QTextDocument from plain text and format runs.
+//
+// Text is inserted through one QTextCursor edit block, one insertText() per
+// run. The document should not be shown in an editor yet: a document without
+// a layout is laid out only once, when it is set on the editor.
+class RichTextBuilder {
+public:
+    static void build(QTextDocument* document, const QString& text, const QVector<TextFormatRun>& runs);
+
+    // Records a style change at position; a change at the same position
+    // replaces the previous one and a change to the current style is dropped
+    static void addRun(QVector<TextFormatRun>& runs, int position, const TextStyle& style);
+
+    // Moves runs after removedPrefix characters were cut from the start of
+    // the text and it was truncated to length
+    static void trimRuns(QVector<TextFormatRun>& runs, int removedPrefix, int length);
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "RichTextBuilder.hpp"
+#include <QString>
+#include <QVector>
+
+class OutputSink;
+
+// Single-pass RTF to plain text converter.
+//
+// Walks the input once keeping a stack of group states: destinations such as
+// \fonttbl, \colortbl, \info and any group starting with \* are skipped,
+// \'hh bytes are decoded with the document code page (\ansicpgN), \uN
+// characters are decoded and their \ucN fallback characters dropped. Text is
+// appended to a buffer reserved to the input size, which is an upper bound
+// for the converted text.
+class RtfParser {
+public:
+    static QString toPlainText(const QString& rtf);
+    // Same text as toPlainText() with the runs of \b, \i and \cfN
+    // (colors from \colortbl)
+    static QString toRichText(const QString& rtf, QVector<TextFormatRun>& runs);
+
+    // Writes plain text as an RTF body: \ { } are escaped, line breaks
+    // become \par and non-ASCII characters become \uN? with a '?' fallback
+    static void writeEscaped(const QString& text, OutputSink& sink);
+};
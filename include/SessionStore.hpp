@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QFile>
+#include <memory>
+
+// Snapshot of a single editor tab
+struct SessionEntry {
+    QString filePath;
+    QString title;
+    bool hasBuffer = false;          // unsaved content is stored in the session
+    QString buffer;
+    qint32 cursorPosition = 0;
+    qint32 scrollPosition = 0;
+
+    // Cached metadata, valid while the file on disk is unchanged
+    qint64 fileSize = -1;
+    qint64 fileModified = 0;         // msecs since epoch
+    qint32 charCount = 0;
+    qint32 wordCount = 0;
+    QVector<qint32> lineIndex;       // offsets of line starts
+};
+
+// Versioned binary session file.
+//
+// Layout: header (magic, version, current tab, entry count), a table of
+// entry offsets, then the entries. Every entry keeps its buffer as raw
+// UTF-8 at the end of the record, so tab metadata can be read from the
+// memory-mapped file without touching the buffers of other tabs.
+class SessionStore {
+public:
+    static constexpr quint32 magic = 0x54455353; // "TESS"
+    static constexpr quint16 version = 1;
+
+    explicit SessionStore(const QString& sessionPath = defaultPath());
+    ~SessionStore();
+
+    static QString defaultPath();
+    static QVector<qint32> buildLineIndex(const QString& text);
+
+    // Throws std::runtime_error on failure
+    void save(const QVector<SessionEntry>& entries, int currentIndex);
+
+    // Maps the session file; returns false if it is missing or invalid
+    bool open();
+    void close();
+    bool isOpen() const;
+
+    int entryCount() const;
+    int currentIndex() const;
+    SessionEntry entry(int index, bool withBuffer = true) const;
+
+    // Запрет копирования
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+private:
+    QString path;
+    QFile file;
+    const uchar* mapped;
+    qint64 mappedSize;
+    qint32 current;
+    QVector<quint64> offsets;
+};
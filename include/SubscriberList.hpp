@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Handle returned when subscribing; detach() stops delivery in O(1).
+// Dropping the handle does not detach: subscriptions end when detached or
+// when the observer is destroyed.
+class Subscription {
+public:
+    Subscription() = default;
+
+    void detach() {
+        if (token && token->active.exchange(false)) {
+            if (auto list = owner.lock()) list->retire();
+        }
+        token.reset();
+        owner.reset();
+    }
+
+    bool isActive() const { return token && token->active.load(); }
+
+private:
+    template <typename> friend class SubscriberList;
+
+    struct Token {
+        std::atomic<bool> active{true};
+    };
+
+    struct Owner {
+        virtual ~Owner() = default;
+        virtual void retire() = 0;
+    };
+
+    Subscription(std::shared_ptr<Token> token, std::weak_ptr<Owner> owner)
+        : token(std::move(token)), owner(std::move(owner)) {}
+
+    std::shared_ptr<Token> token;
+    std::weak_ptr<Owner> owner;
+};
+
+// Copy-on-write list of weakly held subscribers.
+//
+// Readers take the current immutable array with std::atomic_load and walk it
+// without holding any lock. The load itself is not lock-free: libstdc++
+// guards shared_ptr atomics with a small pool of mutexes, held only while the
+// pointer is copied. Notifying therefore waits at most for another pointer
+// copy, never for a writer building a new array or for other observers being
+// notified. An observer detached meanwhile may still receive a notification
+// that was already under way. Writers copy the array under a mutex and
+// publish the copy. Detaching only clears a flag; inactive slots and slots
+// of destroyed observers are dropped by the next copy, or by a compaction
+// once they make up half of the array, so detach is amortized O(1).
+template <typename Observer>
+class SubscriberList {
+public:
+    SubscriberList() : state(std::make_shared<State>()) {}
+
+    Subscription subscribe(std::shared_ptr<Observer> observer) {
+        if (!observer) return Subscription();
+        auto slot = std::make_shared<Slot>();
+        slot->observer = observer;
+        {
+            std::lock_guard<std::mutex> lock(state->writeMutex);
+            std::shared_ptr<Slots> next = state->live();
+            next->push_back(slot);
+            state->publish(std::move(next));
+        }
+        return Subscription(slot, std::weak_ptr<Subscription::Owner>(state));
+    }
+
+    // Detaches every subscription of the observer; O(n)
+    void unsubscribe(const std::shared_ptr<Observer>& observer) {
+        std::shared_ptr<const Slots> slots = std::atomic_load(&state->slots);
+        for (const auto& slot : *slots) {
+            if (slot->active.load() && slot->observer.lock() == observer) {
+                Subscription(slot, std::weak_ptr<Subscription::Owner>(state)).detach();
+            }
+        }
+    }
+
+    template <typename Visit>
+    void forEach(Visit&& visit) const {
+        std::shared_ptr<const Slots> slots = std::atomic_load(&state->slots);
+        for (const auto& slot : *slots) {
+            if (!slot->active.load()) continue;
+            if (std::shared_ptr<Observer> observer = slot->observer.lock()) {
+                visit(observer);
+            } else if (slot->active.exchange(false)) {
+                // Наблюдатель уничтожен; слот уберет следующая запись
+                state->stale.fetch_add(1);
+            }
+        }
+    }
+
+    // Subscribers that are attached and alive
+    int count() const {
+        int alive = 0;
+        forEach([&alive](const std::shared_ptr<Observer>&) { ++alive; });
+        return alive;
+    }
+
+    // Slots in the current array, including ones waiting to be dropped
+    int capacity() const { return static_cast<int>(std::atomic_load(&state->slots)->size()); }
+
+    // Запрет копирования
+    SubscriberList(const SubscriberList&) = delete;
+    SubscriberList& operator=(const SubscriberList&) = delete;
+
+private:
+    struct Slot : Subscription::Token {
+        std::weak_ptr<Observer> observer;
+    };
+
+    using Slots = std::vector<std::shared_ptr<Slot>>;
+
+    struct State : Subscription::Owner {
+        State() : slots(std::make_shared<const Slots>()) {}
+
+        void retire() override {
+            int retired = stale.fetch_add(1) + 1;
+            if (retired * 2 < static_cast<int>(std::atomic_load(&slots)->size())) return;
+            std::lock_guard<std::mutex> lock(writeMutex);
+            publish(live());
+        }
+
+        // Copy of the array without inactive slots; called under writeMutex
+        std::shared_ptr<Slots> live() {
+            std::shared_ptr<const Slots> current = std::atomic_load(&slots);
+            auto next = std::make_shared<Slots>();
+            next->reserve(current->size() + 1);
+            int dropped = 0;
+            for (const auto& slot : *current) {
+                if (slot->active.load() && !slot->observer.expired()) {
+                    next->push_back(slot);
+                } else if (!slot->active.exchange(false)) {
+                    // Слот уже учтен в stale; слот умершего наблюдателя выключается здесь
+                    ++dropped;
+                }
+            }
+            pendingDrop = dropped;
+            return next;
+        }
+
+        void publish(std::shared_ptr<Slots> next) {
+            std::atomic_store(&slots, std::shared_ptr<const Slots>(std::move(next)));
+            stale.fetch_sub(pendingDrop);
+            pendingDrop = 0;
+        }
+
+        std::mutex writeMutex;
+        std::shared_ptr<const Slots> slots;
+        std::atomic<int> stale{0};
+        int pendingDrop = 0;
+    };
+
+    std::shared_ptr<State> state;
+};
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <QTextEdit>
+#include <QPlainTextEdit>
 #include <QString>
 #include <QColor>
 #include <memory>
+#include "AttributeRuns.hpp"
+
+class VirtualTextView;
 
 // Component interface
 class TextComponent {
@@ -12,29 +16,154 @@ public:
     virtual QString getText() = 0;
     virtual void setText(const QString& text) = 0;
     virtual QString getFormattedText() = 0;  // Новый метод для получения форматированного текста
+    // Formatting runs over getText() offsets, kept in step with edits
+    virtual AttributeRuns& getAttributes() = 0;
+    // Changes the style of a range. Components with a rich document format the
+    // document itself and take the runs back from it, others change the runs
+    virtual void applyStyle(int start, int length, const AttributeRuns::StyleChange& change) = 0;
+    // Changes whenever the text or its formatting changes; decorators report
+    // the revision of the component they wrap
+    virtual quint64 revision() = 0;
+    // Bytes of cached output kept besides the document
+    virtual qint64 cachedBytes() = 0;
+};
+
+// Output of a component computed once per revision. QString is implicitly
+// shared, so a cache hit returns without copying the text. Outputs longer
+// than maxLength are not kept: for them the cache would be a second full
+// copy of the document for as long as the tab is open.
+class RevisionCache {
+public:
+    static constexpr int maxLength = 1 << 18;
+
+    template <typename Compute>
+    QString get(quint64 revision, Compute compute) {
+        if (!valid || cachedRevision != revision) {
+            QString computed = compute();
+            if (computed.size() > maxLength) {
+                release();
+                return computed;
+            }
+            value = computed;
+            cachedRevision = revision;
+            valid = true;
+        }
+        return value;
+    }
+
+    // Drops the kept output, e.g. once the text it was computed from changes
+    void release() {
+        value = QString();
+        valid = false;
+    }
+
+    qint64 memoryUsage() const { return qint64(value.capacity()) * sizeof(QChar); }
+
+private:
+    QString value;
+    quint64 cachedRevision = 0;
+    bool valid = false;
 };
 
 // Concrete Component
 class SimpleTextEdit : public TextComponent {
 public:
     explicit SimpleTextEdit(QTextEdit* editor);
+    ~SimpleTextEdit() override;
     QString getText() override;
     void setText(const QString& text) override;
-    QString getFormattedText() override;
+    QString getFormattedText() override;  // HTML из текста и отрезков форматирования
+    AttributeRuns& getAttributes() override;
+    void applyStyle(int start, int length, const AttributeRuns::StyleChange& change) override;
+    quint64 revision() override;
+    qint64 cachedBytes() override;
+
+    // Запрет копирования
+    SimpleTextEdit(const SimpleTextEdit&) = delete;
+    SimpleTextEdit& operator=(const SimpleTextEdit&) = delete;
 
 private:
     QTextEdit* textEdit;
+    AttributeRuns attributes;
+    QMetaObject::Connection tracking;
+    RevisionCache text;
+    RevisionCache formattedText;
+};
+
+// Concrete Component for large and plain-text documents
+class SimplePlainTextEdit : public TextComponent {
+public:
+    explicit SimplePlainTextEdit(QPlainTextEdit* editor);
+    ~SimplePlainTextEdit() override;
+    QString getText() override;
+    void setText(const QString& text) override;
+    QString getFormattedText() override;  // без форматирования возвращает обычный текст
+    AttributeRuns& getAttributes() override;
+    void applyStyle(int start, int length, const AttributeRuns::StyleChange& change) override;
+    quint64 revision() override;
+    qint64 cachedBytes() override;
+
+    // Запрет копирования
+    SimplePlainTextEdit(const SimplePlainTextEdit&) = delete;
+    SimplePlainTextEdit& operator=(const SimplePlainTextEdit&) = delete;
+
+private:
+    QPlainTextEdit* plainTextEdit;
+    AttributeRuns attributes;
+    QMetaObject::Connection tracking;
+    RevisionCache text;
+};
+
+// Concrete Component for files too large to load, shown by VirtualTextView.
+// The view is read-only; setText() replaces its buffer with the new text.
+class VirtualTextComponent : public TextComponent {
+public:
+    explicit VirtualTextComponent(VirtualTextView* view);
+    // Decodes the whole buffer; throws std::runtime_error if it does not fit in a QString
+    QString getText() override;
+    void setText(const QString& text) override;
+    QString getFormattedText() override;  // без форматирования возвращает обычный текст
+    // One run of the default style, built from getText() on first use
+    AttributeRuns& getAttributes() override;
+    void applyStyle(int start, int length, const AttributeRuns::StyleChange& change) override;
+    quint64 revision() override;
+    qint64 cachedBytes() override;
+
+    // Запрет копирования
+    VirtualTextComponent(const VirtualTextComponent&) = delete;
+    VirtualTextComponent& operator=(const VirtualTextComponent&) = delete;
+
+private:
+    VirtualTextView* view;
+    AttributeRuns attributes;
+    quint64 attributesRevision;
+    RevisionCache text;
 };
 
 // Base Decorator
+//
+// Decorators no longer wrap the text in tags: each one sets its attribute on
+// a range through the wrapped component, which formats its document and keeps
+// the shared run model in step, so reading the text never copies it per layer
+// and markup is produced only when the formatted text is requested.
 class TextDecorator : public TextComponent {
 public:
     explicit TextDecorator(std::shared_ptr<TextComponent> component);
     QString getText() override;
+    // Sets the text and applies the decorator's formatting to all of it
     void setText(const QString& text) override;
     QString getFormattedText() override;
+    AttributeRuns& getAttributes() override;
+    void applyStyle(int start, int length, const AttributeRuns::StyleChange& change) override;
+    quint64 revision() override;
+    qint64 cachedBytes() override;
+
+    // Applies the decorator's formatting to a range of the text
+    void applyTo(int start, int length);
 
 protected:
+    virtual void decorate(TextStyle& style) const;
+
     std::shared_ptr<TextComponent> wrapped;
 };
 
@@ -42,26 +171,20 @@ protected:
 class ItalicDecorator : public TextDecorator {
 public:
     explicit ItalicDecorator(std::shared_ptr<TextComponent> component);
-    QString getText() override;
-    void setText(const QString& text) override;
-    QString getFormattedText() override;
 
-private:
-    QString addItalicTags(const QString& text);
-    QString removeItalicTags(const QString& text);
+protected:
+    void decorate(TextStyle& style) const override;
 };
 
 // Concrete Decorator B - Color
 class ColorDecorator : public TextDecorator {
 public:
     explicit ColorDecorator(std::shared_ptr<TextComponent> component, const QColor& color = Qt::blue);
-    QString getText() override;
-    void setText(const QString& text) override;
-    QString getFormattedText() override;
+
+protected:
+    void decorate(TextStyle& style) const override;
 
 private:
-    QString addColorTags(const QString& text);
-    QString removeColorTags(const QString& text);
     QColor textColor;
 };
 
@@ -69,11 +192,7 @@ private:
 class BoldDecorator : public TextDecorator {
 public:
     explicit BoldDecorator(std::shared_ptr<TextComponent> component);
-    QString getText() override;
-    void setText(const QString& text) override;
-    QString getFormattedText() override;
 
-private:
-    QString addBoldTags(const QString& text);
-    QString removeBoldTags(const QString& text);
-};
\ No newline at end of file
+protected:
+    void decorate(TextStyle& style) const override;
+};
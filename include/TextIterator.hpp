@@ -4,6 +4,28 @@
 #include <QObject>
 #include <memory>
 
+// Character, word and line counter fed with text in chunks.
+//
+// A word is a run of characters that are neither space nor punctuation; the
+// state of a word cut by a chunk boundary carries over to the next chunk.
+// This is the word definition of the editor status bar.
+class TextCounter {
+public:
+    void feed(const QChar* data, int length);
+    // Counts a word still open at the end of the text
+    void finish();
+
+    qint64 charCount() const { return chars; }
+    qint64 wordCount() const { return words; }
+    qint64 lineCount() const { return lines; }
+
+private:
+    qint64 chars = 0;
+    qint64 words = 0;
+    qint64 lines = 0;
+    bool inWord = false;
+};
+
 // Iterator interface
 class TextIterator {
 public:
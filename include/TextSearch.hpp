@@ -0,0 +1,111 @@
+#pragma once
+
+#include "RetiringThreads.hpp"
+#include <QRegularExpression>
+#include <QString>
+#include <QStringMatcher>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+struct SearchOptions {
+    bool caseSensitive = true;
+    bool regularExpression = false;
+};
+
+struct SearchMatch {
+    int start;
+    int length;
+
+    int end() const { return start + length; }
+};
+
+// A replaced range of the new text and the length of the text it replaced
+struct Replacement {
+    int start;
+    int length;
+    int originalLength;
+};
+
+// Literal or regular expression search over a QString.
+//
+// Case-sensitive literal search looks for one byte of the pattern's first
+// UTF-16 code unit with memchr, which the C library vectorizes, and checks
+// each aligned candidate with memcmp. Case-insensitive literal search uses
+// QStringMatcher. Regular expressions use multiline mode, so ^ and $ match
+// at line breaks.
+class TextSearch {
+public:
+    // Throws std::invalid_argument for an empty pattern or an invalid regular expression
+    TextSearch(const QString& pattern, const SearchOptions& options = SearchOptions());
+
+    QString pattern() const { return needle; }
+    SearchOptions options() const { return settings; }
+
+    // First match starting at or after from
+    bool findNext(const QString& text, int from, SearchMatch& match) const;
+    // Visits matches in order until visit returns false
+    void forEachMatch(const QString& text, const std::function<bool(const SearchMatch&)>& visit) const;
+    QVector<SearchMatch> findAll(const QString& text) const;
+
+    // Replacement for one match: in regular expression mode \0-\9 insert captures
+    // and \\ a backslash; literal replacements are inserted as they are
+    QString expand(const QString& text, const SearchMatch& match, const QString& replacement) const;
+
+    // Builds the replaced text in one pass; replaced receives the new ranges
+    QString replaceAll(const QString& text, const QString& replacement,
+                       QVector<Replacement>* replaced = nullptr) const;
+
+private:
+    int findLiteral(const QString& text, int from) const;
+
+    QString needle;
+    SearchOptions settings;
+    QRegularExpression regex;
+    QStringMatcher matcher;
+    // Байт первой кодовой единицы образца, по которому memchr ищет кандидатов
+    int anchorOffset;
+    char anchorByte;
+};
+
+// Runs a TextSearch over a text snapshot on its own thread.
+//
+// QString is implicitly shared, so the snapshot costs nothing until the
+// editor changes the text, and the thread reads it without locks. Matches
+// are handed out in batches as they are found. Starting a new search
+// cancels the running one without waiting for it: it stops at its next
+// match and its thread is joined later, so a regular expression scanning a
+// long text without matches does not block the caller. Every search has a
+// generation number, so batches of a cancelled search can be told apart.
+class BackgroundSearch {
+public:
+    // Called on the search thread; finished is true for the last batch
+    using ResultHandler = std::function<void(quint64 generation, const QVector<SearchMatch>& batch, bool finished)>;
+
+    static constexpr int batchSize = 4096;
+    // A batch is delivered at least this often while matches are found
+    static constexpr int batchIntervalMs = 50;
+
+    explicit BackgroundSearch(ResultHandler handler);
+    ~BackgroundSearch();
+
+    // Returns the generation of the new search
+    quint64 start(const QString& text, const TextSearch& search);
+    void cancel();
+    // Blocks until the running search has finished
+    void wait();
+
+    // Запрет копирования
+    BackgroundSearch(const BackgroundSearch&) = delete;
+    BackgroundSearch& operator=(const BackgroundSearch&) = delete;
+
+private:
+    void run(QString text, TextSearch search, quint64 generation);
+
+    ResultHandler handler;
+    std::mutex mutex;
+    RetiringThreads threads;
+    std::atomic<quint64> generation;
+};
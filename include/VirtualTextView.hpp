@@ -0,0 +1,56 @@
+#pragma once
+
+#include "LineBuffer.hpp"
+#include <QAbstractScrollArea>
+#include <QCache>
+#include <QTextLayout>
+#include <memory>
+
+// Read-only view of a LineBuffer that lays out only the lines on screen.
+//
+// The scroll position is a line number, so nothing is measured ahead of
+// time: a repaint asks the buffer for the visible lines and draws them from
+// a cache of shaped QTextLayouts, one per line. Scrolling or jumping costs
+// the lines that come into view, whatever the size of the file. Lines are
+// not wrapped. Buffers with more lines than a scroll bar can count move
+// several lines per scroll bar step.
+class VirtualTextView : public QAbstractScrollArea {
+    Q_OBJECT
+
+public:
+    // Shaped lines kept between repaints
+    static constexpr int cacheCapacity = 2048;
+
+    explicit VirtualTextView(QWidget* parent = nullptr);
+
+    void setBuffer(std::shared_ptr<const LineBuffer> buffer);
+    std::shared_ptr<const LineBuffer> buffer() const { return lineBuffer; }
+    // Incremented every time the buffer is replaced
+    quint64 revision() const { return changes; }
+
+    qint64 firstVisibleLine() const;
+    int visibleLineCount() const;
+    void scrollToLine(qint64 line);
+
+    int cachedLineCount() const { return layouts.size(); }
+    // Estimated bytes held by the view and its buffer
+    qint64 memoryUsage() const;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void changeEvent(QEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private:
+    QTextLayout* layoutFor(qint64 line);
+    void updateScrollBars();
+    int lineHeight() const;
+
+    std::shared_ptr<const LineBuffer> lineBuffer;
+    QCache<qint64, QTextLayout> layouts;
+    qint64 linesPerStep;
+    int widestLine;
+    quint64 changes;
+};
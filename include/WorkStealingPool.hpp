@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool with one task deque per worker.
+//
+// A worker takes tasks from the back of its own deque and, when it runs
+// dry, steals from the front of the others, so long and short tasks even out
+// across threads without a single shared queue. Tasks submitted from a
+// worker go to that worker's deque; others are spread round-robin.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // threadCount <= 0 uses the number of hardware threads
+    explicit WorkStealingPool(int threadCount = 0);
+    ~WorkStealingPool();
+
+    void submit(Task task);
+    // Blocks until every submitted task has finished
+    void wait();
+    int threadCount() const { return static_cast<int>(threads.size()); }
+
+    // Запрет копирования
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run(int index);
+    bool popLocal(int index, Task& task);
+    bool steal(int index, Task& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex stateMutex;
+    std::condition_variable wakeUp;
+    std::condition_variable idle;
+    std::atomic<int> queued;
+    std::atomic<int> pending;
+    std::atomic<unsigned> nextQueue;
+    bool stopping;
+};
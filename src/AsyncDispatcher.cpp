@@ -0,0 +1,177 @@
+#include "AsyncDispatcher.hpp"
+#include <QDebug>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+AsyncDispatcher::AsyncDispatcher(const SnapshotSource& snapshots, int threadCount)
+    : snapshots(snapshots), pool(threadCount) {}
+
+AsyncDispatcher::~AsyncDispatcher() {
+    // Пул дожидается своих задач до того, как каналы будут освобождены
+    pool.wait();
+}
+
+void AsyncDispatcher::subscribe(std::shared_ptr<IDocumentObserver> observer, BackpressurePolicy policy, int capacity) {
+    if (!observer) return;
+    if (capacity < 1) {
+        throw std::invalid_argument("Async observer queue capacity must be positive");
+    }
+    std::lock_guard<std::mutex> lock(channelsMutex);
+    for (const auto& channel : channels) {
+        if (channel->observer.lock() == observer) return;
+    }
+    channels.push_back(std::make_shared<Channel>(std::move(observer), policy, capacity));
+}
+
+void AsyncDispatcher::unsubscribe(const std::shared_ptr<IDocumentObserver>& observer) {
+    std::lock_guard<std::mutex> lock(channelsMutex);
+    auto it = std::find_if(channels.begin(), channels.end(),
+                           [&](const std::shared_ptr<Channel>& channel) { return channel->observer.lock() == observer; });
+    if (it == channels.end()) return;
+    // Уже поставленные в очередь события больше не доставляются
+    (*it)->closed.store(true);
+    channels.erase(it);
+}
+
+bool AsyncDispatcher::isSubscribed(const std::shared_ptr<IDocumentObserver>& observer) const {
+    return find(observer) != nullptr;
+}
+
+void AsyncDispatcher::dispatch(const QVector<DocumentDelta>& deltas) {
+    if (deltas.isEmpty()) return;
+    std::vector<std::shared_ptr<Channel>> targets;
+    {
+        std::lock_guard<std::mutex> lock(channelsMutex);
+        // Очереди уничтоженных наблюдателей больше не нужны
+        channels.erase(std::remove_if(channels.begin(), channels.end(),
+                                      [](const std::shared_ptr<Channel>& channel) { return channel->observer.expired(); }),
+                       channels.end());
+        targets = channels;
+    }
+    Clock::time_point now = Clock::now();
+    for (const auto& channel : targets) {
+        // QVector разделяет данные между событиями всех наблюдателей
+        post(channel, Event{deltas, now});
+    }
+}
+
+ObserverMetrics AsyncDispatcher::metrics(const std::shared_ptr<IDocumentObserver>& observer) const {
+    ObserverMetrics result;
+    std::shared_ptr<Channel> channel = find(observer);
+    if (!channel) return result;
+    result.queueDepth = channel->queue.size() + (channel->overflowed.load() ? 1 : 0);
+    result.capacity = channel->queue.capacity();
+    result.delivered = channel->delivered.load();
+    result.dropped = channel->dropped.load();
+    result.coalesced = channel->coalesced.load();
+    result.lastLagUs = channel->lastLagUs.load();
+    result.maxLagUs = channel->maxLagUs.load();
+    return result;
+}
+
+void AsyncDispatcher::waitIdle() {
+    pool.wait();
+}
+
+void AsyncDispatcher::post(const std::shared_ptr<Channel>& channel, Event event) {
+    // Пока есть отложенное событие, новые идут за ним, иначе нарушится порядок
+    if (!channel->overflowed.load() && channel->queue.tryPush(std::move(event))) {
+        schedule(channel);
+        return;
+    }
+
+    switch (channel->policy) {
+    case BackpressurePolicy::Block:
+        while (!channel->queue.tryPush(std::move(event))) {
+            schedule(channel);
+            std::this_thread::yield();
+        }
+        break;
+    case BackpressurePolicy::Coalesce: {
+        std::lock_guard<std::mutex> lock(channel->overflowMutex);
+        if (channel->overflow.deltas.isEmpty()) {
+            channel->overflow = std::move(event);
+        } else {
+            channel->overflow.deltas += event.deltas;
+            channel->coalesced.fetch_add(1);
+        }
+        channel->overflowed.store(true);
+        break;
+    }
+    case BackpressurePolicy::DropToLatest: {
+        std::lock_guard<std::mutex> lock(channel->overflowMutex);
+        if (channel->overflow.deltas.isEmpty()) {
+            channel->overflow.posted = event.posted;
+        }
+        // Наблюдатель перечитает снимок вместо пропущенных правок
+        quint64 revision = event.deltas.last().revision;
+        channel->overflow.deltas = {DocumentDelta{revision, 0, DocumentDelta::wholeDocument, QString()}};
+        channel->dropped.fetch_add(1);
+        channel->overflowed.store(true);
+        break;
+    }
+    }
+    schedule(channel);
+}
+
+void AsyncDispatcher::schedule(const std::shared_ptr<Channel>& channel) {
+    // Очередь наблюдателя разбирает не больше одной задачи за раз
+    if (!channel->scheduled.exchange(true)) {
+        pool.submit([this, channel] { drain(channel); });
+    }
+}
+
+void AsyncDispatcher::drain(const std::shared_ptr<Channel>& channel) {
+    Event event;
+    while (true) {
+        while (channel->queue.tryPop(event)) {
+            deliver(*channel, event);
+        }
+        if (channel->overflowed.load()) {
+            Event overflow;
+            {
+                std::lock_guard<std::mutex> lock(channel->overflowMutex);
+                overflow = std::move(channel->overflow);
+                channel->overflow = Event();
+                channel->overflowed.store(false);
+            }
+            if (!overflow.deltas.isEmpty()) {
+                deliver(*channel, overflow);
+            }
+            continue;
+        }
+
+        channel->scheduled.store(false);
+        // Событие могло прийти между последней проверкой и сбросом флага;
+        // тогда его производитель мог не запланировать разбор
+        bool idle = channel->queue.size() == 0 && !channel->overflowed.load();
+        if (idle || channel->scheduled.exchange(true)) return;
+    }
+}
+
+void AsyncDispatcher::deliver(Channel& channel, const Event& event) {
+    std::shared_ptr<IDocumentObserver> observer = channel.observer.lock();
+    if (!observer || channel.closed.load()) return;
+
+    qint64 lag = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - event.posted).count();
+    channel.lastLagUs.store(lag);
+    qint64 maxLag = channel.maxLagUs.load();
+    while (lag > maxLag && !channel.maxLagUs.compare_exchange_weak(maxLag, lag)) {}
+
+    try {
+        observer->changed(event.deltas, snapshots);
+    } catch (const std::exception& e) {
+        // Ошибка одного наблюдателя не должна останавливать разбор его очереди
+        qWarning() << "Async observer failed:" << e.what();
+    }
+    channel.delivered.fetch_add(1);
+}
+
+std::shared_ptr<AsyncDispatcher::Channel> AsyncDispatcher::find(const std::shared_ptr<IDocumentObserver>& observer) const {
+    std::lock_guard<std::mutex> lock(channelsMutex);
+    for (const auto& channel : channels) {
+        if (channel->observer.lock() == observer) return channel;
+    }
+    return nullptr;
+}
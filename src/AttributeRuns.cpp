@@ -0,0 +1,329 @@
+#include "AttributeRuns.hpp"
+#include <QtGlobal>
+
+AttributeRuns::AttributeRuns() : root(nil), seed(0x9E3779B9u), changes(0) {}
+
+AttributeRuns::AttributeRuns(int length) : AttributeRuns() {
+    if (length > 0) {
+        root = allocate(length, TextStyle());
+    }
+}
+
+AttributeRuns::AttributeRuns(const QVector<TextFormatRun>& runs, int length) : AttributeRuns() {
+    std::vector<int> order;
+    int position = 0;
+    TextStyle style;
+    for (int i = 0; i <= runs.size(); ++i) {
+        int end = i < runs.size() ? qBound(position, runs[i].start, length) : length;
+        if (end > position) {
+            if (!order.empty() && nodes[order.back()].style == style) {
+                nodes[order.back()].length += end - position;
+            } else {
+                order.push_back(allocate(end - position, style));
+            }
+            position = end;
+        }
+        if (i < runs.size()) {
+            style = runs[i].style;
+        }
+    }
+    root = build(order);
+}
+
+int AttributeRuns::length() const {
+    return total(root);
+}
+
+int AttributeRuns::runCount() const {
+    return static_cast<int>(nodes.size() - freeNodes.size());
+}
+
+qint64 AttributeRuns::memoryUsage() const {
+    return qint64(nodes.capacity() * sizeof(Node) + freeNodes.capacity() * sizeof(int));
+}
+
+void AttributeRuns::clear() {
+    nodes.clear();
+    freeNodes.clear();
+    root = nil;
+    ++changes;
+}
+
+void AttributeRuns::insert(int position, int length) {
+    if (length <= 0) return;
+    ++changes;
+    if (root == nil) {
+        root = allocate(length, TextStyle());
+        return;
+    }
+    position = qBound(0, position, total(root));
+    // Новые символы продолжают отрезок символа перед ними
+    grow(root, position > 0 ? position - 1 : 0, length);
+}
+
+void AttributeRuns::insert(int position, int length, const TextStyle& style) {
+    if (length <= 0) return;
+    ++changes;
+    int left, right;
+    split(root, qBound(0, position, total(root)), left, right);
+    root = join(join(left, allocate(length, style)), right);
+}
+
+void AttributeRuns::remove(int position, int length) {
+    position = qBound(0, position, total(root));
+    length = qMin(length, total(root) - position);
+    if (length <= 0) return;
+    ++changes;
+
+    int left, rest, middle, right;
+    split(root, position, left, rest);
+    split(rest, length, middle, right);
+    releaseTree(middle);
+    root = join(left, right);
+}
+
+void AttributeRuns::edit(int position, int removed, int added) {
+    position = qBound(0, position, total(root));
+    remove(position, removed);
+    insert(position, added);
+}
+
+void AttributeRuns::apply(int start, int length, const StyleChange& change) {
+    start = qBound(0, start, total(root));
+    length = qMin(length, total(root) - start);
+    if (length <= 0) return;
+    ++changes;
+
+    int left, rest, middle, right;
+    split(root, start, left, rest);
+    split(rest, length, middle, right);
+
+    std::vector<int> order;
+    collect(middle, order);
+    std::vector<int> merged;
+    merged.reserve(order.size());
+    for (int node : order) {
+        change(nodes[node].style);
+        // Соседние отрезки, ставшие одинаковыми, сливаются
+        if (!merged.empty() && nodes[merged.back()].style == nodes[node].style) {
+            nodes[merged.back()].length += nodes[node].length;
+            release(node);
+        } else {
+            merged.push_back(node);
+        }
+    }
+    root = join(join(left, build(merged)), right);
+}
+
+void AttributeRuns::setStyle(int start, int length, const TextStyle& style) {
+    apply(start, length, [&style](TextStyle& current) { current = style; });
+}
+
+TextStyle AttributeRuns::styleAt(int position) const {
+    int node = root;
+    while (node != nil) {
+        int leftTotal = total(nodes[node].left);
+        if (position < leftTotal) {
+            node = nodes[node].left;
+        } else if (position < leftTotal + nodes[node].length || nodes[node].right == nil) {
+            return nodes[node].style;
+        } else {
+            position -= leftTotal + nodes[node].length;
+            node = nodes[node].right;
+        }
+    }
+    return TextStyle();
+}
+
+QVector<TextFormatRun> AttributeRuns::query(int start, int length) const {
+    QVector<TextFormatRun> out;
+    start = qBound(0, start, total(root));
+    int end = start + qMin(length, total(root) - start);
+    if (end > start) {
+        collectRange(root, 0, start, end, out);
+    }
+    return out;
+}
+
+int AttributeRuns::allocate(int length, const TextStyle& style) {
+    // xorshift: приоритеты должны быть случайными, но воспроизводимыми
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    Node node{nil, nil, seed, length, length, style};
+    if (!freeNodes.empty()) {
+        int index = freeNodes.back();
+        freeNodes.pop_back();
+        nodes[index] = node;
+        return index;
+    }
+    nodes.push_back(node);
+    return static_cast<int>(nodes.size()) - 1;
+}
+
+void AttributeRuns::release(int node) {
+    freeNodes.push_back(node);
+}
+
+void AttributeRuns::releaseTree(int node) {
+    std::vector<int> order;
+    collect(node, order);
+    freeNodes.insert(freeNodes.end(), order.begin(), order.end());
+}
+
+void AttributeRuns::update(int node) {
+    nodes[node].total = total(nodes[node].left) + nodes[node].length + total(nodes[node].right);
+}
+
+void AttributeRuns::split(int node, int position, int& left, int& right) {
+    if (node == nil) {
+        left = right = nil;
+        return;
+    }
+    int leftTotal = total(nodes[node].left);
+    int nodeLength = nodes[node].length;
+    if (position <= leftTotal) {
+        int lower, upper;
+        split(nodes[node].left, position, lower, upper);
+        nodes[node].left = upper;
+        update(node);
+        left = lower;
+        right = node;
+    } else if (position >= leftTotal + nodeLength) {
+        int lower, upper;
+        split(nodes[node].right, position - leftTotal - nodeLength, lower, upper);
+        nodes[node].right = lower;
+        update(node);
+        left = node;
+        right = upper;
+    } else {
+        // Позиция внутри отрезка: он делится на два с тем же стилем
+        int offset = position - leftTotal;
+        TextStyle style = nodes[node].style;
+        int tail = allocate(nodeLength - offset, style);
+        int oldRight = nodes[node].right;
+        nodes[node].length = offset;
+        nodes[node].right = nil;
+        update(node);
+        left = node;
+        right = merge(tail, oldRight);
+    }
+}
+
+int AttributeRuns::merge(int left, int right) {
+    if (left == nil) return right;
+    if (right == nil) return left;
+    if (nodes[left].priority > nodes[right].priority) {
+        int merged = merge(nodes[left].right, right);
+        nodes[left].right = merged;
+        update(left);
+        return left;
+    }
+    int merged = merge(left, nodes[right].left);
+    nodes[right].left = merged;
+    update(right);
+    return right;
+}
+
+int AttributeRuns::join(int left, int right) {
+    if (left == nil) return right;
+    if (right == nil) return left;
+    int head = first(right);
+    if (nodes[last(left)].style == nodes[head].style) {
+        int headLength = nodes[head].length;
+        int single, rest;
+        split(right, headLength, single, rest);
+        release(single);
+        growLast(left, headLength);
+        right = rest;
+    }
+    return merge(left, right);
+}
+
+int AttributeRuns::build(const std::vector<int>& order) {
+    // Декартово дерево по готовой последовательности строится стеком правой ветви
+    std::vector<int> stack;
+    for (int node : order) {
+        int lastPopped = nil;
+        while (!stack.empty() && nodes[stack.back()].priority < nodes[node].priority) {
+            lastPopped = stack.back();
+            stack.pop_back();
+        }
+        nodes[node].left = lastPopped;
+        nodes[node].right = nil;
+        if (!stack.empty()) {
+            nodes[stack.back()].right = node;
+        }
+        stack.push_back(node);
+    }
+    if (stack.empty()) {
+        return nil;
+    }
+    updateTotals(stack.front());
+    return stack.front();
+}
+
+int AttributeRuns::updateTotals(int node) {
+    if (node == nil) return 0;
+    nodes[node].total = updateTotals(nodes[node].left) + nodes[node].length + updateTotals(nodes[node].right);
+    return nodes[node].total;
+}
+
+void AttributeRuns::collect(int node, std::vector<int>& order) const {
+    if (node == nil) return;
+    collect(nodes[node].left, order);
+    order.push_back(node);
+    collect(nodes[node].right, order);
+}
+
+void AttributeRuns::collectRange(int node, int offset, int start, int end, QVector<TextFormatRun>& out) const {
+    if (node == nil) return;
+    int nodeStart = offset + total(nodes[node].left);
+    int nodeEnd = nodeStart + nodes[node].length;
+    if (start < nodeStart) {
+        collectRange(nodes[node].left, offset, start, end, out);
+    }
+    if (start < nodeEnd && nodeStart < end) {
+        out.append({qMax(nodeStart, start), nodes[node].style});
+    }
+    if (end > nodeEnd) {
+        collectRange(nodes[node].right, nodeEnd, start, end, out);
+    }
+}
+
+void AttributeRuns::grow(int node, int position, int length) {
+    while (node != nil) {
+        nodes[node].total += length;
+        int leftTotal = total(nodes[node].left);
+        if (position < leftTotal) {
+            node = nodes[node].left;
+        } else if (position < leftTotal + nodes[node].length || nodes[node].right == nil) {
+            nodes[node].length += length;
+            return;
+        } else {
+            position -= leftTotal + nodes[node].length;
+            node = nodes[node].right;
+        }
+    }
+}
+
+int AttributeRuns::first(int node) const {
+    while (nodes[node].left != nil) node = nodes[node].left;
+    return node;
+}
+
+int AttributeRuns::last(int node) const {
+    while (nodes[node].right != nil) node = nodes[node].right;
+    return node;
+}
+
+void AttributeRuns::growLast(int node, int length) {
+    while (node != nil) {
+        nodes[node].total += length;
+        if (nodes[node].right == nil) {
+            nodes[node].length += length;
+            return;
+        }
+        node = nodes[node].right;
+    }
+}
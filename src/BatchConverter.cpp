@@ -0,0 +1,140 @@
+#include "BatchConverter.hpp"
+#include "WorkStealingPool.hpp"
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QSet>
+#include <stdexcept>
+
+double BatchResult::filesPerSecond() const {
+    return elapsedMs > 0 ? converted * 1000.0 / elapsedMs : 0.0;
+}
+
+double BatchResult::megabytesPerSecond() const {
+    return elapsedMs > 0 ? bytes / (1024.0 * 1024.0) * 1000.0 / elapsedMs : 0.0;
+}
+
+BatchConverter::BatchConverter(const BatchOptions& options)
+    : options(options), bytesInFlight(0) {
+    if (this->options.maxBytesInFlight <= 0) {
+        throw std::invalid_argument("Memory budget must be positive");
+    }
+}
+
+BatchResult BatchConverter::run() {
+    if (!QFileInfo(options.inputDirectory).isDir()) {
+        throw std::runtime_error(QString("Input directory does not exist: %1")
+                                     .arg(options.inputDirectory).toStdString());
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QList<Job> jobs = collectJobs();
+
+    // Каталоги создаются заранее, чтобы потоки не создавали их одновременно
+    QSet<QString> directories;
+    for (const Job& job : jobs) {
+        directories.insert(QFileInfo(job.outputPath).absolutePath());
+    }
+    for (const QString& directory : directories) {
+        if (!QDir().mkpath(directory)) {
+            throw std::runtime_error(QString("Cannot create output directory: %1")
+                                         .arg(directory).toStdString());
+        }
+    }
+
+    BatchResult result;
+    {
+        WorkStealingPool pool(options.threads);
+        for (const Job& job : jobs) {
+            pool.submit([this, job, &result]() { convert(job, result); });
+        }
+        pool.wait();
+    }
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
+
+QList<BatchConverter::Job> BatchConverter::collectJobs() const {
+    QDir input(options.inputDirectory);
+    QDir output(options.outputDirectory);
+    const QString extension = FormatRegistry::getInstance().info(options.targetFormat).extension;
+
+    QList<Job> jobs;
+    QDirIterator it(options.inputDirectory, QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QString path = it.next();
+        QFileInfo info = it.fileInfo();
+        QString relative = input.relativeFilePath(info.absolutePath());
+        QString name = info.completeBaseName().isEmpty() ? info.fileName() : info.completeBaseName();
+        jobs.append({path, QDir::cleanPath(output.filePath(relative + "/" + name + "." + extension)),
+                     info.size()});
+    }
+
+    // Файлы с одним именем и разными расширениями (a.html, a.rtf) сохраняют
+    // исходное расширение в имени результата: a.html.txt, a.rtf.txt.
+    // Имена сравниваются без учета регистра, как в файловых системах Windows и macOS
+    QHash<QString, int> counts;
+    for (const Job& job : jobs) {
+        ++counts[job.outputPath.toCaseFolded()];
+    }
+    for (Job& job : jobs) {
+        if (counts.value(job.outputPath.toCaseFolded()) > 1) {
+            QFileInfo info(job.inputPath);
+            QString relative = input.relativeFilePath(info.absolutePath());
+            job.outputPath = QDir::cleanPath(output.filePath(relative + "/" + info.fileName() + "." + extension));
+        }
+    }
+    QSet<QString> outputs;
+    for (const Job& job : jobs) {
+        if (outputs.contains(job.outputPath.toCaseFolded())) {
+            throw std::runtime_error(QString("Several input files convert to %1")
+                                         .arg(job.outputPath).toStdString());
+        }
+        outputs.insert(job.outputPath.toCaseFolded());
+    }
+    return jobs;
+}
+
+void BatchConverter::convert(const Job& job, BatchResult& result) {
+    // Крупный файл занимает весь бюджет, но не больше, иначе он не начнется никогда
+    qint64 cost = qMin(job.size, options.maxBytesInFlight);
+    acquire(cost);
+    QString error;
+    try {
+        FormatRegistry& registry = FormatRegistry::getInstance();
+        QString content = registry.detect(job.inputPath).adapter->loadDocument(job.inputPath);
+        registry.info(options.targetFormat).adapter->saveDocument(job.outputPath, content);
+    } catch (const std::exception& e) {
+        error = QString("%1: %2").arg(job.inputPath, e.what());
+    }
+    release(cost);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (error.isEmpty()) {
+        ++result.converted;
+        result.bytes += job.size;
+    } else {
+        ++result.failed;
+        result.errors.append(error);
+    }
+}
+
+void BatchConverter::acquire(qint64 bytes) {
+    std::unique_lock<std::mutex> lock(mutex);
+    budgetAvailable.wait(lock, [this, bytes]() {
+        return bytesInFlight + bytes <= options.maxBytesInFlight;
+    });
+    bytesInFlight += bytes;
+}
+
+void BatchConverter::release(qint64 bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bytesInFlight -= bytes;
+    }
+    budgetAvailable.notify_all();
+}
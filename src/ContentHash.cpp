@@ -0,0 +1,277 @@
+#include "ContentHash.hpp"
+#include <QSet>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const quint64 prime1 = 0x9E3779B185EBCA87ULL;
+const quint64 prime2 = 0xC2B2AE3D27D4EB4FULL;
+const quint64 prime3 = 0x165667B19E3779F9ULL;
+const quint64 prime4 = 0x85EBCA77C2B2AE63ULL;
+const quint64 prime5 = 0x27D4EB2F165667C5ULL;
+
+inline quint64 rotateLeft(quint64 value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline quint64 read64(const unsigned char* data) {
+    quint64 value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline quint32 read32(const unsigned char* data) {
+    quint32 value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline quint64 round(quint64 accumulator, quint64 input) {
+    accumulator += input * prime2;
+    return rotateLeft(accumulator, 31) * prime1;
+}
+
+inline quint64 mergeRound(quint64 accumulator, quint64 value) {
+    accumulator ^= round(0, value);
+    return accumulator * prime1 + prime4;
+}
+
+// Случайные значения для скользящего хэша, по одному на байт символа
+std::array<quint64, 256> makeGearTable() {
+    std::array<quint64, 256> table;
+    quint64 state = 0x5851F42D4C957F2DULL;
+    for (quint64& value : table) {
+        // splitmix64
+        state += 0x9E3779B97F4A7C15ULL;
+        quint64 z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        value = z ^ (z >> 31);
+    }
+    return table;
+}
+
+const std::array<quint64, 256> gear = makeGearTable();
+
+} // namespace
+
+ContentHash::ContentHash(int minChunk, int averageChunk, int maxChunk)
+    : minChunk(minChunk), maxChunk(maxChunk), boundaryMask(0), totalLength(0),
+      savedDocumentHash(0), cachedHash(0), hashValid(false) {
+    if (minChunk < 1 || averageChunk < 2 || maxChunk < minChunk) {
+        throw std::invalid_argument("Invalid chunk sizes");
+    }
+    int bits = 0;
+    while ((2 << bits) <= averageChunk) ++bits;
+    // Решение о границе принимается по старшим битам: они зависят от последних
+    // 64 символов, а младшие - только от нескольких
+    boundaryMask = ((quint64(1) << bits) - 1) << (64 - bits);
+    savedDocumentHash = documentHash();
+}
+
+void ContentHash::reset(const QString& text) {
+    current.clear();
+    chunkText(text.constData(), text.size(), 0, current);
+    totalLength = text.size();
+    hashValid = false;
+}
+
+void ContentHash::edit(int position, int removed, int added, int newLength, const TextReader& read) {
+    if (current.isEmpty() || position < 0 || position > totalLength) {
+        reset(read(0, newLength));
+        return;
+    }
+
+    // Фрагменты до того, в котором началась правка, не меняются: их границы
+    // зависят только от их собственного текста
+    auto it = std::upper_bound(current.constBegin(), current.constEnd(), position,
+                               [](int offset, const Chunk& chunk) { return offset < chunk.start; });
+    int first = qMax(0, static_cast<int>(it - current.constBegin()) - 1);
+    int delta = added - removed;
+    int editEnd = position + removed;
+
+    QVector<Chunk> fresh;
+    int tail = current.size();
+    int old = first;
+    int scan = current[first].start;
+    QString window;
+    int windowStart = scan;
+    while (scan < newLength) {
+        int available = qMin(maxChunk, newLength - scan);
+        if (scan + available > windowStart + window.size()) {
+            // Текст читается блоками на несколько фрагментов вперед
+            window = read(scan, qMin(newLength - scan, 4 * maxChunk));
+            windowStart = scan;
+            available = qMin(available, window.size());
+            if (available == 0) break;
+        }
+        const QChar* data = window.constData() + (scan - windowStart);
+        int length = cut(data, available);
+        fresh.append({scan, length, hashBytes(data, length * sizeof(QChar))});
+        scan += length;
+
+        // Граница совпала с прежней за правкой: дальше все фрагменты те же
+        int oldEnd = scan - delta;
+        if (oldEnd < editEnd) continue;
+        while (old < current.size() && current[old].start + current[old].length < oldEnd) ++old;
+        if (old < current.size() && current[old].start + current[old].length == oldEnd) {
+            tail = old + 1;
+            break;
+        }
+    }
+
+    QVector<Chunk> chunks;
+    chunks.reserve(first + fresh.size() + current.size() - tail);
+    for (int i = 0; i < first; ++i) chunks.append(current[i]);
+    chunks += fresh;
+    for (int i = tail; i < current.size(); ++i) {
+        Chunk chunk = current[i];
+        chunk.start += delta;
+        chunks.append(chunk);
+    }
+    current.swap(chunks);
+    totalLength = newLength;
+    hashValid = false;
+}
+
+quint64 ContentHash::documentHash() const {
+    if (!hashValid) {
+        cachedHash = combine(current);
+        hashValid = true;
+    }
+    return cachedHash;
+}
+
+void ContentHash::markSaved() {
+    // QVector разделяет данные, пока следующая правка их не изменит
+    saved = current;
+    savedDocumentHash = documentHash();
+}
+
+bool ContentHash::matchesSaved(const QString& text) const {
+    QVector<Chunk> chunks;
+    chunkText(text.constData(), text.size(), 0, chunks);
+    return combine(chunks) == savedDocumentHash;
+}
+
+QVector<ContentHash::Region> ContentHash::changedRegions() const {
+    QVector<Region> regions;
+    if (!isDirty()) return regions;
+
+    // Общие начало и конец совпадают по порядку, середина - по множеству хэшей
+    int prefix = 0;
+    while (prefix < current.size() && prefix < saved.size() && current[prefix].hash == saved[prefix].hash) {
+        ++prefix;
+    }
+    int suffix = 0;
+    while (suffix < current.size() - prefix && suffix < saved.size() - prefix &&
+           current[current.size() - 1 - suffix].hash == saved[saved.size() - 1 - suffix].hash) {
+        ++suffix;
+    }
+
+    QSet<quint64> known;
+    for (int i = prefix; i < saved.size() - suffix; ++i) {
+        known.insert(saved[i].hash);
+    }
+    for (int i = prefix; i < current.size() - suffix; ++i) {
+        const Chunk& chunk = current[i];
+        if (known.contains(chunk.hash)) continue;
+        if (!regions.isEmpty() && regions.last().start + regions.last().length == chunk.start) {
+            regions.last().length += chunk.length;
+        } else {
+            regions.append({chunk.start, chunk.length});
+        }
+    }
+    if (regions.isEmpty()) {
+        regions.append({prefix < current.size() ? current[prefix].start : totalLength, 0});
+    }
+    return regions;
+}
+
+quint64 ContentHash::hashBytes(const void* data, size_t length, quint64 seed) {
+    const unsigned char* input = static_cast<const unsigned char*>(data);
+    const unsigned char* end = input + length;
+    quint64 hash;
+
+    if (length >= 32) {
+        // Четыре независимых накопителя процессор считает параллельно
+        quint64 v1 = seed + prime1 + prime2;
+        quint64 v2 = seed + prime2;
+        quint64 v3 = seed;
+        quint64 v4 = seed - prime1;
+        const unsigned char* limit = end - 32;
+        do {
+            v1 = round(v1, read64(input));
+            v2 = round(v2, read64(input + 8));
+            v3 = round(v3, read64(input + 16));
+            v4 = round(v4, read64(input + 24));
+            input += 32;
+        } while (input <= limit);
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    } else {
+        hash = seed + prime5;
+    }
+    hash += static_cast<quint64>(length);
+
+    for (; input + 8 <= end; input += 8) {
+        hash ^= round(0, read64(input));
+        hash = rotateLeft(hash, 27) * prime1 + prime4;
+    }
+    if (input + 4 <= end) {
+        hash ^= static_cast<quint64>(read32(input)) * prime1;
+        hash = rotateLeft(hash, 23) * prime2 + prime3;
+        input += 4;
+    }
+    for (; input < end; ++input) {
+        hash ^= (*input) * prime5;
+        hash = rotateLeft(hash, 11) * prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+int ContentHash::cut(const QChar* data, int available) const {
+    if (available <= minChunk) return available;
+    int limit = qMin(available, maxChunk);
+    // Отпечаток зависит только от последних 64 символов, поэтому начало
+    // фрагмента короче минимума можно не просматривать
+    quint64 fingerprint = 0;
+    for (int i = qMax(0, minChunk - 64); i < limit; ++i) {
+        ushort code = data[i].unicode();
+        fingerprint = (fingerprint << 1) + gear[(code ^ (code >> 8)) & 0xff];
+        if (i + 1 >= minChunk && (fingerprint & boundaryMask) == 0) {
+            return i + 1;
+        }
+    }
+    return limit;
+}
+
+void ContentHash::chunkText(const QChar* data, int length, int offset, QVector<Chunk>& out) const {
+    for (int position = 0; position < length;) {
+        int chunkLength = cut(data + position, length - position);
+        out.append({offset + position, chunkLength, hashBytes(data + position, chunkLength * sizeof(QChar))});
+        position += chunkLength;
+    }
+}
+
+quint64 ContentHash::combine(const QVector<Chunk>& chunks) {
+    std::vector<quint64> hashes;
+    hashes.reserve(chunks.size());
+    for (const Chunk& chunk : chunks) {
+        hashes.push_back(chunk.hash);
+    }
+    return hashBytes(hashes.data(), hashes.size() * sizeof(quint64));
+}
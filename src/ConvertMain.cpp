@@ -0,0 +1,56 @@
+#include "BatchConverter.hpp"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <cstdio>
+
+// Пакетное преобразование документов без графического интерфейса:
+// editor-convert [--threads N] [--max-memory МБ] <входной каталог> <выходной каталог> <txt|html|xml|rtf>
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("editor-convert");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Converts every document in a directory to another format.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("input", "Directory with source documents.");
+    parser.addPositionalArgument("output", "Directory for converted documents.");
+    parser.addPositionalArgument("format", "Target format: txt, html, xml or rtf.");
+    QCommandLineOption threadsOption("threads", "Worker threads (default: all cores).", "count", "0");
+    QCommandLineOption memoryOption("max-memory", "Megabytes of input converted at once.", "MB", "256");
+    parser.addOption(threadsOption);
+    parser.addOption(memoryOption);
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.size() != 3) {
+        parser.showHelp(1);
+    }
+
+    const FormatInfo& target = FormatRegistry::getInstance().forExtension("." + arguments[2]);
+    if (target.extension != arguments[2].toLower()) {
+        std::fprintf(stderr, "Unknown format: %s\n", qPrintable(arguments[2]));
+        return 1;
+    }
+
+    BatchOptions options;
+    options.inputDirectory = arguments[0];
+    options.outputDirectory = arguments[1];
+    options.targetFormat = target.format;
+    options.threads = parser.value(threadsOption).toInt();
+    options.maxBytesInFlight = parser.value(memoryOption).toLongLong() * 1024 * 1024;
+
+    try {
+        BatchResult result = BatchConverter(options).run();
+        for (const QString& error : result.errors) {
+            std::fprintf(stderr, "%s\n", qPrintable(error));
+        }
+        std::printf("%d converted, %d failed in %lld ms: %.1f files/s, %.1f MB/s\n",
+                    result.converted, result.failed, static_cast<long long>(result.elapsedMs),
+                    result.filesPerSecond(), result.megabytesPerSecond());
+        return result.failed == 0 ? 0 : 2;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+}
@@ -1,12 +1,80 @@
 #include "DocumentAdapter.hpp"
 #include "FileHandler.hpp"
+#include "HtmlTokenizer.hpp"
+#include "RtfParser.hpp"
+#include "OutputSink.hpp"
+#include "ParallelConverter.hpp"
+#include "RichTextBuilder.hpp"
 #include <QFile>
 #include <QTextStream>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
-#include <QRegularExpression>
+#include <climits>
 #include <stdexcept>
 
+namespace {
+
+// Открывает файл и передает эмиттеру буферизованный поток UTF-8
+template <typename Emitter>
+bool writeThroughSink(const QString& filePath, Emitter emitter) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+    OutputSink sink(&file);
+    emitter(sink);
+    return sink.flush();
+}
+
+// Escapes the same characters as QString::toHtmlEscaped
+void writeHtmlEscaped(OutputSink& sink, const QChar* data, int length) {
+    int runStart = 0;
+    for (int i = 0; i < length; ++i) {
+        QLatin1String entity;
+        switch (data[i].unicode()) {
+        case '&': entity = QLatin1String("&amp;"); break;
+        case '<': entity = QLatin1String("&lt;"); break;
+        case '>': entity = QLatin1String("&gt;"); break;
+        case '"': entity = QLatin1String("&quot;"); break;
+        default: continue;
+        }
+        sink.write(data + runStart, i - runStart);
+        sink.write(entity);
+        runStart = i + 1;
+    }
+    sink.write(data + runStart, length - runStart);
+}
+
+// Стиль текста с позиции position; run - индекс первого отрезка после нее.
+// Индекс только растет, поэтому позиции передаются по возрастанию
+TextStyle styleFrom(const QVector<TextFormatRun>& runs, int position, int& run) {
+    while (run < runs.size() && runs[run].start <= position) {
+        ++run;
+    }
+    return run > 0 ? runs[run - 1].style : TextStyle();
+}
+
+int nextRunStart(const QVector<TextFormatRun>& runs, int run, int end) {
+    return run < runs.size() ? qMin(runs[run].start, end) : end;
+}
+
+} // namespace
+
+QString IDocumentAdapter::loadFormatted(const QString& filePath, QVector<TextFormatRun>& runs) {
+    runs.clear();
+    return loadDocument(filePath);
+}
+
+void IDocumentAdapter::saveFormatted(const QString& filePath, const QString& text, const QVector<TextFormatRun>&) {
+    saveDocument(filePath, text);
+}
+
+void IDocumentAdapter::loadIntoDocument(const QString& filePath, QTextDocument* document) {
+    QVector<TextFormatRun> runs;
+    QString text = loadFormatted(filePath, runs);
+    RichTextBuilder::build(document, text, runs);
+}
+
 QString TextDocumentAdapter::loadDocument(const QString& filePath) {
     try {
         return FileHandler::getInstance().readFile(filePath);
@@ -31,160 +99,256 @@ QString RtfDocumentAdapter::loadDocument(const QString& filePath) {
     }
 }
 
+QString RtfDocumentAdapter::loadFormatted(const QString& filePath, QVector<TextFormatRun>& runs) {
+    runs.clear();
+    try {
+        return RtfParser::toRichText(FileHandler::getInstance().readFile(filePath), runs);
+    } catch (const std::exception& e) {
+        throw std::runtime_error(QString("RTF document load error: %1").arg(e.what()).toStdString());
+    }
+}
+
 void RtfDocumentAdapter::saveDocument(const QString& filePath, const QString& content) {
-    QString rtfContent = addRtfFormatting(content);
-    if (!FileHandler::getInstance().writeFile(filePath, rtfContent)) {
+    saveFormatted(filePath, content, QVector<TextFormatRun>());
+}
+
+void RtfDocumentAdapter::saveFormatted(const QString& filePath, const QString& text,
+                                       const QVector<TextFormatRun>& runs) {
+    if (!writeThroughSink(filePath, [&](OutputSink& sink) { writeRtf(sink, text, runs); })) {
         throw std::runtime_error("Failed to save RTF document");
     }
 }
 
 QString RtfDocumentAdapter::stripRtfFormatting(const QString& rtfText) {
-    QString text = rtfText;
-    
-    // Remove RTF header
-    static QRegularExpression rtfHeader(R"(\{\\rtf1.*?\})");
-    text.remove(rtfHeader);
-    
-    // Remove common RTF commands
-    static QRegularExpression rtfCommands(R"(\\[a-zA-Z]+[-]?[0-9]*)");
-    text.remove(rtfCommands);
-    
-    // Remove curly braces
-    text.remove(QRegularExpression(R"(\{|\})"));
-    
-    // Remove special characters
-    text.remove(QRegularExpression(R"(\\[\''][0-9a-fA-F]{2})"));
-    
-    return text.simplified();
+    // Один проход с учетом групп, кодовой страницы и \uN
+    return RtfParser::toPlainText(rtfText);
 }
 
-QString RtfDocumentAdapter::addRtfFormatting(const QString& text) {
-    QString rtfContent = "{\\rtf1\\ansi\\deff0{\\fonttbl{\\f0\\fnil\\fcharset0 Arial;}}\n";
-    rtfContent += "\\viewkind4\\uc1\\pard\\lang1033\\f0\\fs24 ";
+void RtfDocumentAdapter::writeRtf(OutputSink& sink, const QString& text, const QVector<TextFormatRun>& runs) {
+    sink.write(QLatin1String("{\\rtf1\\ansi\\deff0{\\fonttbl{\\f0\\fnil\\fcharset0 Arial;}}\n"));
+
+    // Цвет с индексом N в таблице записывается как \cfN; \cf0 - цвет по умолчанию
+    QVector<QColor> colors;
+    for (const TextFormatRun& run : runs) {
+        if (run.style.color.isValid() && !colors.contains(run.style.color)) {
+            colors.append(run.style.color);
+        }
+    }
+    if (!colors.isEmpty()) {
+        sink.write(QLatin1String("{\\colortbl;"));
+        for (const QColor& color : colors) {
+            QByteArray entry = QString("\\red%1\\green%2\\blue%3;")
+                                   .arg(color.red()).arg(color.green()).arg(color.blue()).toLatin1();
+            sink.write(QLatin1String(entry));
+        }
+        sink.write(QLatin1String("}\n"));
+    }
+    sink.write(QLatin1String("\\viewkind4\\uc1\\pard\\lang1033\\f0\\fs24 "));
     
-    // Escape special characters
-    QString escaped = text;
-    escaped.replace("\\", "\\\\");
-    escaped.replace("{", "\\{");
-    escaped.replace("}", "\\}");
+    // Escape special characters, line breaks and non-ASCII text; each change
+    // of style is written as the control words that differ from the last one
+    TextStyle written;
+    int run = 0;
+    for (int position = 0; position < text.size();) {
+        TextStyle style = styleFrom(runs, position, run);
+        int end = nextRunStart(runs, run, text.size());
+        if (style != written) {
+            QByteArray words;
+            if (style.bold != written.bold) words += style.bold ? "\\b" : "\\b0";
+            if (style.italic != written.italic) words += style.italic ? "\\i" : "\\i0";
+            if (style.color != written.color) {
+                words += "\\cf" + QByteArray::number(style.color.isValid() ? colors.indexOf(style.color) + 1 : 0);
+            }
+            sink.write(QLatin1String(words + ' '));
+            written = style;
+        }
+        RtfParser::writeEscaped(QString::fromRawData(text.constData() + position, end - position), sink);
+        position = end;
+    }
     
-    rtfContent += escaped;
-    rtfContent += "}";
-    return rtfContent;
+    sink.write(QLatin1String("}"));
 }
 
 // HTML Adapter
 QString HtmlDocumentAdapter::loadDocument(const QString& filePath) {
     try {
         QString content = FileHandler::getInstance().readFile(filePath);
+        if (content.size() > parallelThreshold) {
+            // Большой документ разбирается по частям на всех ядрах
+            return ParallelConverter().htmlToPlainText(content);
+        }
         return stripHtmlTags(content);
     } catch (const std::exception& e) {
         throw std::runtime_error(QString("HTML document load error: %1").arg(e.what()).toStdString());
     }
 }
 
+QString HtmlDocumentAdapter::loadFormatted(const QString& filePath, QVector<TextFormatRun>& runs) {
+    runs.clear();
+    try {
+        QString content = FileHandler::getInstance().readFile(filePath);
+        // Для очень больших документов форматирование не сохраняется:
+        // параллельный разбор быстрее, а в таком объеме оно редко нужно
+        return content.size() > parallelThreshold ? ParallelConverter().htmlToPlainText(content)
+                                                  : HtmlTokenizer::toRichText(content, runs);
+    } catch (const std::exception& e) {
+        throw std::runtime_error(QString("HTML document load error: %1").arg(e.what()).toStdString());
+    }
+}
+
 void HtmlDocumentAdapter::saveDocument(const QString& filePath, const QString& content) {
-    QString htmlContent = addHtmlTags(content);
-    if (!FileHandler::getInstance().writeFile(filePath, htmlContent)) {
+    saveFormatted(filePath, content, QVector<TextFormatRun>());
+}
+
+void HtmlDocumentAdapter::saveFormatted(const QString& filePath, const QString& text,
+                                        const QVector<TextFormatRun>& runs) {
+    if (!writeThroughSink(filePath, [&](OutputSink& sink) { writeHtml(sink, text, runs); })) {
         throw std::runtime_error("Failed to save HTML document");
     }
 }
 
 QString HtmlDocumentAdapter::stripHtmlTags(const QString& htmlText) {
-    QString text = htmlText;
-    
-    // Remove DOCTYPE and HTML comments
-    text.remove(QRegularExpression(R"(<!DOCTYPE[^>]*>|<!--[\s\S]*?-->)"));
-    
-    // Remove style tags and their content
-    text.remove(QRegularExpression(R"(<style[^>]*>.*?</style>)", QRegularExpression::DotMatchesEverythingOption));
-    
-    // Remove HTML tags
-    text.remove(QRegularExpression(R"(<[^>]*>)"));
-    
-    // Decode HTML entities
-    text.replace("&amp;", "&");
-    text.replace("&lt;", "<");
-    text.replace("&gt;", ">");
-    text.replace("&quot;", "\"");
-    text.replace("&nbsp;", " ");
-    
-    return text.simplified();
+    // Один проход конечного автомата вместо цепочки регулярных выражений
+    return HtmlTokenizer::toPlainText(htmlText);
 }
 
-QString HtmlDocumentAdapter::addHtmlTags(const QString& text) {
-    QString htmlContent = "<!DOCTYPE html>\n<html>\n<head>\n";
-    htmlContent += "<meta charset=\"UTF-8\">\n";
-    htmlContent += "</head>\n<body>\n";
+void HtmlDocumentAdapter::writeHtml(OutputSink& sink, const QString& text, const QVector<TextFormatRun>& runs) {
+    sink.write(QLatin1String("<!DOCTYPE html>\n<html>\n<head>\n"));
+    sink.write(QLatin1String("<meta charset=\"UTF-8\">\n"));
+    sink.write(QLatin1String("</head>\n<body>\n"));
     
-    // Convert newlines to paragraphs and preserve formatting
-    QString content = text;
-    QStringList paragraphs = content.split("\n");
-    for (const QString& paragraph : paragraphs) {
-        if (!paragraph.trimmed().isEmpty()) {
-            htmlContent += "<p>" + paragraph.toHtmlEscaped() + "</p>\n";
+    // Each non-blank line becomes a paragraph, escaped as it is written
+    const QChar* data = text.constData();
+    const int length = text.size();
+    int start = 0;
+    int run = 0;
+    while (start <= length) {
+        int end = start;
+        bool blank = true;
+        for (; end < length && data[end] != QLatin1Char('\n'); ++end) {
+            blank = blank && data[end].isSpace();
+        }
+        if (!blank) {
+            sink.write(QLatin1String("<p>"));
+            // Отрезки форматирования внутри абзаца становятся строчными тегами
+            for (int position = start; position < end;) {
+                TextStyle style = styleFrom(runs, position, run);
+                int stop = nextRunStart(runs, run, end);
+                QString color = style.color.isValid() ? QString("<font color=\"%1\">").arg(style.color.name())
+                                                      : QString();
+                sink.write(color.constData(), color.size());
+                if (style.bold) sink.write(QLatin1String("<b>"));
+                if (style.italic) sink.write(QLatin1String("<i>"));
+                writeHtmlEscaped(sink, data + position, stop - position);
+                if (style.italic) sink.write(QLatin1String("</i>"));
+                if (style.bold) sink.write(QLatin1String("</b>"));
+                if (style.color.isValid()) sink.write(QLatin1String("</font>"));
+                position = stop;
+            }
+            sink.write(QLatin1String("</p>\n"));
         }
+        start = end + 1;
     }
     
-    htmlContent += "</body>\n</html>";
-    return htmlContent;
+    sink.write(QLatin1String("</body>\n</html>"));
 }
 
 // XML Adapter
 QString XmlDocumentAdapter::loadDocument(const QString& filePath) {
     try {
-        QString content = FileHandler::getInstance().readFile(filePath);
-        return parseXmlContent(content);
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            throw std::runtime_error("Cannot open file for reading");
+        }
+        return parseXmlContent(&file, file.size());
     } catch (const std::exception& e) {
         throw std::runtime_error(QString("XML document load error: %1").arg(e.what()).toStdString());
     }
 }
 
 void XmlDocumentAdapter::saveDocument(const QString& filePath, const QString& content) {
-    QString xmlContent = createXmlContent(content);
-    if (!FileHandler::getInstance().writeFile(filePath, xmlContent)) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text) || !writeXmlContent(&file, content)) {
         throw std::runtime_error("Failed to save XML document");
     }
 }
 
-QString XmlDocumentAdapter::parseXmlContent(const QString& xmlText) {
-    QXmlStreamReader reader(xmlText);
+QString XmlDocumentAdapter::parseXmlContent(QIODevice* device, qint64 sizeHint) {
+    QXmlStreamReader reader(device);
     QString content;
-    
-    while (!reader.atEnd() && !reader.hasError()) {
-        if (reader.isCharacters() && !reader.isWhitespace()) {
-            content += reader.text().toString() + "\n";
-        }
+    // Текст не длиннее файла; незатронутая часть резерва не занимает физическую память
+    content.reserve(static_cast<int>(qMin<qint64>(sizeHint, INT_MAX / 2)));
+    appendTextRuns(reader, content);
+    trimInPlace(content);
+    return content;
+}
+
+void XmlDocumentAdapter::appendTextRuns(QXmlStreamReader& reader, QString& content) {
+    // Читатель может разбить один текстовый узел на части (например, на
+    // ссылках на сущности), поэтому части собираются в один абзац
+    int runStart = content.size();
+    bool runHasText = false;
+    while (!reader.atEnd()) {
         reader.readNext();
+        if (reader.isCharacters()) {
+            content.append(reader.text());
+            runHasText = runHasText || !reader.isWhitespace();
+            continue;
+        }
+        if (runHasText) {
+            content.append(QLatin1Char('\n'));
+        } else {
+            content.truncate(runStart);
+        }
+        runStart = content.size();
+        runHasText = false;
     }
     
     if (reader.hasError()) {
         throw std::runtime_error(QString("XML parsing error: %1").arg(reader.errorString()).toStdString());
     }
-    
-    return content.trimmed();
 }
 
-QString XmlDocumentAdapter::createXmlContent(const QString& text) {
-    QString xmlContent;
-    QXmlStreamWriter writer(&xmlContent);
+void XmlDocumentAdapter::trimInPlace(QString& content) {
+    // trimmed() на месте, без второй копии текста
+    int end = content.size();
+    while (end > 0 && content.at(end - 1).isSpace()) {
+        --end;
+    }
+    content.truncate(end);
+    int begin = 0;
+    while (begin < content.size() && content.at(begin).isSpace()) {
+        ++begin;
+    }
+    content.remove(0, begin);
+}
+
+bool XmlDocumentAdapter::writeXmlContent(QIODevice* device, const QString& text) {
+    QXmlStreamWriter writer(device);
     
     writer.setAutoFormatting(true);
     writer.writeStartDocument();
     writer.writeStartElement("document");
     writer.writeStartElement("content");
     
-    // Split text into paragraphs
-    QStringList paragraphs = text.split("\n");
-    for (const QString& paragraph : paragraphs) {
+    // Paragraphs are written as views into text, without splitting it
+    const QChar* data = text.constData();
+    int start = 0;
+    while (true) {
+        int end = text.indexOf(QLatin1Char('\n'), start);
+        int length = (end < 0 ? text.size() : end) - start;
         writer.writeStartElement("paragraph");
-        writer.writeCharacters(paragraph);
+        writer.writeCharacters(QString::fromRawData(data + start, length));
         writer.writeEndElement(); // paragraph
+        if (end < 0) {
+            break;
+        }
+        start = end + 1;
     }
     
     writer.writeEndElement(); // content
     writer.writeEndElement(); // document
     writer.writeEndDocument();
     
-    return xmlContent;
+    return !writer.hasError();
 }
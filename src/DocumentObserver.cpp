@@ -1,33 +1,167 @@
 #include "DocumentObserver.hpp"
-#include <algorithm>
+#include "AsyncDispatcher.hpp"
 
-void DocumentSubject::attach(std::shared_ptr<IDocumentObserver> observer) {
-    if (observer) {
-        observers.push_back(observer);
+SnapshotSource::SnapshotSource() : state(std::make_shared<State>()) {}
+
+std::shared_ptr<const DocumentSnapshot> SnapshotSource::snapshot() const {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (!state->cached || state->cached->revision != state->revision) {
+        // Текст читается один раз на ревизию и разделяется всеми наблюдателями
+        QString text = state->provider ? state->provider() : QString();
+        state->cached = std::make_shared<const DocumentSnapshot>(DocumentSnapshot{state->revision, text});
     }
+    return state->cached;
+}
+
+quint64 SnapshotSource::revision() const {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->revision;
+}
+
+void IDocumentObserver::changed(const QVector<DocumentDelta>&, const SnapshotSource& snapshots) {
+    update(snapshots.snapshot()->text);
+}
+
+DocumentSubject::DocumentSubject() {}
+
+DocumentSubject::~DocumentSubject() {
+    // Асинхронные наблюдатели получают все, что уже было отправлено
+    dispatcher.reset();
+    // Источник может пережить субъект в наблюдателях, но читать текст больше не из чего
+    std::lock_guard<std::mutex> lock(source.state->mutex);
+    source.state->provider = nullptr;
+}
+
+Subscription DocumentSubject::attach(std::shared_ptr<IDocumentObserver> observer) {
+    return observers.subscribe(std::move(observer));
 }
 
 void DocumentSubject::detach(std::shared_ptr<IDocumentObserver> observer) {
-    observers.erase(
-        std::remove(observers.begin(), observers.end(), observer),
-        observers.end()
-    );
+    observers.unsubscribe(observer);
+    if (dispatcher) {
+        dispatcher->unsubscribe(observer);
+    }
 }
 
 void DocumentSubject::notify(const QString& content) {
-    for (const auto& observer : observers) {
-        if (observer) {
-            observer->update(content);
+    observers.forEach([&content](const std::shared_ptr<IDocumentObserver>& observer) {
+        observer->update(content);
+    });
+}
+
+void DocumentSubject::post(int position, int removed, const QString& inserted) {
+    if (removed == 0 && inserted.isEmpty()) return;
+    quint64 revision = nextRevision();
+    if (coalesce(position, removed, inserted)) {
+        pending.last().revision = revision;
+        return;
+    }
+    pending.append({revision, position, removed, inserted});
+}
+
+void DocumentSubject::replaceAll() {
+    // Прежние правки теряют смысл: наблюдатели все равно перечитают текст
+    pending.clear();
+    pending.append({nextRevision(), 0, DocumentDelta::wholeDocument, QString()});
+}
+
+void DocumentSubject::flush() {
+    if (pending.isEmpty()) return;
+    QVector<DocumentDelta> deltas;
+    deltas.swap(pending);
+    observers.forEach([&](const std::shared_ptr<IDocumentObserver>& observer) {
+        observer->changed(deltas, source);
+    });
+    if (dispatcher) {
+        dispatcher->dispatch(deltas);
+    }
+}
+
+void DocumentSubject::attachAsync(std::shared_ptr<IDocumentObserver> observer, BackpressurePolicy policy, int capacity) {
+    if (!observer) return;
+    if (!dispatcher) {
+        // Потоки создаются только при первом асинхронном наблюдателе;
+        // очереди разбираются поочередно, и двух потоков хватает
+        dispatcher = std::make_unique<AsyncDispatcher>(source, 2);
+    }
+    dispatcher->subscribe(std::move(observer), policy, capacity);
+}
+
+ObserverMetrics DocumentSubject::asyncMetrics(const std::shared_ptr<IDocumentObserver>& observer) const {
+    return dispatcher ? dispatcher->metrics(observer) : ObserverMetrics();
+}
+
+void DocumentSubject::waitForAsync() {
+    if (dispatcher) {
+        dispatcher->waitIdle();
+    }
+}
+
+SnapshotSource DocumentSubject::snapshots() const {
+    return source;
+}
+
+void DocumentSubject::setSnapshotProvider(std::function<QString()> provider) {
+    std::lock_guard<std::mutex> lock(source.state->mutex);
+    source.state->provider = std::move(provider);
+    source.state->cached.reset();
+}
+
+bool DocumentSubject::coalesce(int position, int removed, const QString& inserted) {
+    if (pending.isEmpty() || pending.last().replacesAll()) return false;
+    DocumentDelta& last = pending.last();
+    int lastEnd = last.position + last.inserted.size();
+
+    if (removed == 0 && position == lastEnd) {
+        // Набор текста продолжает предыдущую вставку
+        last.inserted += inserted;
+        return true;
+    }
+    if (!inserted.isEmpty()) return false;
+
+    if (position + removed == lastEnd) {
+        // Backspace: сначала стирается только что вставленное, затем исходный текст
+        if (removed <= last.inserted.size()) {
+            last.inserted.chop(removed);
+        } else {
+            last.removed += removed - last.inserted.size();
+            last.position = position;
+            last.inserted.clear();
         }
+        return true;
+    }
+    if (position == lastEnd) {
+        // Delete: удаление продолжается вправо от вставки
+        last.removed += removed;
+        return true;
     }
+    return false;
 }
 
-TextEditObserver::TextEditObserver() : lastUpdate() {}
+quint64 DocumentSubject::nextRevision() {
+    std::lock_guard<std::mutex> lock(source.state->mutex);
+    return ++source.state->revision;
+}
+
+TextEditObserver::TextEditObserver() : revision(0) {}
 
 void TextEditObserver::update(const QString& content) {
-    lastUpdate = content;
+    // QString разделяет данные с вызывающим, текст не копируется
+    pushed = std::make_shared<const DocumentSnapshot>(DocumentSnapshot{revision, content});
+}
+
+void TextEditObserver::changed(const QVector<DocumentDelta>& deltas, const SnapshotSource& source) {
+    if (!deltas.isEmpty()) {
+        revision = deltas.last().revision;
+    }
+    snapshots = source;
+    pushed.reset();
 }
 
 QString TextEditObserver::getLastUpdate() const {
-    return lastUpdate;
-}
\ No newline at end of file
+    return pushed ? pushed->text : snapshots.snapshot()->text;
+}
+
+quint64 TextEditObserver::lastRevision() const {
+    return revision;
+}
@@ -0,0 +1,392 @@
+#include "EditJournal.hpp"
+#include <QDataStream>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QUuid>
+#include <QDebug>
+#include <chrono>
+#include <condition_variable>
+#include <initializer_list>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+const quint32 journalMagic = 0x54454A31; // "TEJ1"
+const quint16 journalVersion = 1;
+
+enum RecordType : quint8 {
+    FileBaseRecord = 1,
+    CheckpointRecord = 2,
+    DeltaRecord = 3
+};
+
+QByteArray encodeRecord(RecordType type, const QByteArray& payload) {
+    QByteArray record;
+    record.reserve(payload.size() + 7);
+    QDataStream stream(&record, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << static_cast<quint8>(type) << static_cast<quint32>(payload.size());
+    stream.writeRawData(payload.constData(), payload.size());
+    stream << qChecksum(payload.constData(), static_cast<uint>(payload.size()));
+    return record;
+}
+
+template <typename... Fields>
+QByteArray encodePayload(const Fields&... fields) {
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    (void)std::initializer_list<int>{ (stream << fields, 0)... };
+    return payload;
+}
+
+QByteArray journalHeader() {
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << journalMagic << journalVersion;
+    return header;
+}
+
+} // namespace
+
+// Single background thread shared by all journals
+class JournalWriter {
+public:
+    static JournalWriter& getInstance() {
+        static JournalWriter instance;
+        return instance;
+    }
+
+    quint64 enqueue(std::shared_ptr<EditJournal> journal, EditJournal::Op op) {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.emplace_back(std::move(journal), std::move(op));
+        wakeUp.notify_one();
+        return ++enqueued;
+    }
+
+    void waitFor(quint64 sequence) {
+        std::unique_lock<std::mutex> lock(mutex);
+        flushRequested = true;
+        wakeUp.notify_one();
+        written.wait(lock, [this, sequence]() { return committed >= sequence; });
+    }
+
+    quint64 lastEnqueued() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return enqueued;
+    }
+
+    ~JournalWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeUp.notify_one();
+        thread.join();
+    }
+
+private:
+    using Entry = std::pair<std::shared_ptr<EditJournal>, EditJournal::Op>;
+
+    JournalWriter() : thread(&JournalWriter::run, this) {}
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wakeUp.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                break;
+            }
+
+            // Групповая фиксация: собираем правки, пришедшие за короткое окно
+            wakeUp.wait_for(lock, commitWindow, [this]() { return stopping || flushRequested; });
+            flushRequested = false;
+
+            std::vector<Entry> batch;
+            batch.swap(queue);
+            quint64 target = enqueued;
+            lock.unlock();
+
+            writeBatch(batch);
+
+            lock.lock();
+            committed = target;
+            written.notify_all();
+        }
+    }
+
+    static void writeBatch(std::vector<Entry>& batch) {
+        std::vector<std::shared_ptr<EditJournal>> order;
+        std::vector<std::vector<EditJournal::Op>> ops;
+        for (Entry& entry : batch) {
+            size_t slot = 0;
+            while (slot < order.size() && order[slot] != entry.first) {
+                ++slot;
+            }
+            if (slot == order.size()) {
+                order.push_back(entry.first);
+                ops.emplace_back();
+            }
+            ops[slot].push_back(std::move(entry.second));
+        }
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i]->writeBatch(ops[i]);
+        }
+    }
+
+    static constexpr std::chrono::milliseconds commitWindow{20};
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable written;
+    std::vector<Entry> queue;
+    quint64 enqueued = 0;
+    quint64 committed = 0;
+    bool flushRequested = false;
+    bool stopping = false;
+    std::thread thread;
+};
+
+EditJournal::EditJournal(const QString& journalPath, const QString& documentPath, int checkpointInterval)
+    : journalPath(journalPath), documentPath(documentPath), checkpointInterval(checkpointInterval),
+      editsSinceCheckpoint(0), basePath(documentPath), baseFileSize(-1), baseFileModified(0),
+      discarded(false) {
+    QFileInfo info(documentPath);
+    if (!documentPath.isEmpty() && info.exists()) {
+        baseFileSize = info.size();
+        baseFileModified = info.lastModified().toMSecsSinceEpoch();
+    }
+}
+
+EditJournal::~EditJournal() {
+    file.close();
+}
+
+std::shared_ptr<EditJournal> EditJournal::create(const QString& documentPath, int checkpointInterval) {
+    QDir().mkpath(journalDirectory());
+    QString name = QUuid::createUuid().toString().mid(1, 36);
+    QString journalPath = journalDirectory() + "/" + name + ".journal";
+    return std::shared_ptr<EditJournal>(new EditJournal(journalPath, documentPath, checkpointInterval));
+}
+
+QString EditJournal::journalDirectory() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/journal";
+}
+
+QStringList EditJournal::pendingJournals() {
+    QDir dir(journalDirectory());
+    QStringList result;
+    for (const QString& name : dir.entryList({"*.journal"}, QDir::Files, QDir::Time)) {
+        result.append(dir.absoluteFilePath(name));
+    }
+    return result;
+}
+
+QString EditJournal::path() const {
+    return journalPath;
+}
+
+void EditJournal::append(int position, int removed, const QString& inserted) {
+    ++editsSinceCheckpoint;
+    enqueue({OpKind::Delta, position, removed, inserted, QString(), false});
+}
+
+void EditJournal::checkpoint(const QString& text, bool clean) {
+    editsSinceCheckpoint = 0;
+    enqueue({OpKind::Checkpoint, 0, 0, text, documentPath, clean});
+}
+
+void EditJournal::rebase(const QString& path) {
+    documentPath = path;
+    editsSinceCheckpoint = 0;
+    // Размер и время изменения снимаются сразу: к записи файл может измениться снова
+    QFileInfo info(path);
+    Op op{OpKind::Rebase, 0, 0, QString(), path, true};
+    if (info.exists()) {
+        op.fileSize = info.size();
+        op.fileModified = info.lastModified().toMSecsSinceEpoch();
+    }
+    enqueue(std::move(op));
+}
+
+bool EditJournal::needsCheckpoint() const {
+    return editsSinceCheckpoint >= checkpointInterval;
+}
+
+void EditJournal::flush() {
+    JournalWriter& writer = JournalWriter::getInstance();
+    writer.waitFor(writer.lastEnqueued());
+}
+
+void EditJournal::discard() {
+    editsSinceCheckpoint = 0;
+    enqueue({OpKind::Discard, 0, 0, QString(), QString(), false});
+}
+
+void EditJournal::enqueue(Op op) {
+    JournalWriter::getInstance().enqueue(shared_from_this(), std::move(op));
+}
+
+QByteArray EditJournal::baseRecord() const {
+    if (baseFileSize >= 0) {
+        return encodeRecord(FileBaseRecord, encodePayload(basePath, baseFileSize, baseFileModified));
+    }
+    return encodeRecord(CheckpointRecord, encodePayload(basePath, false, QString()));
+}
+
+void EditJournal::writeBatch(const std::vector<Op>& ops) {
+    QByteArray appended;
+    QByteArray rewritten;
+    bool rewrite = false;
+
+    for (const Op& op : ops) {
+        switch (op.kind) {
+        case OpKind::Delta:
+            if (!discarded) {
+                (rewrite ? rewritten : appended)
+                    .append(encodeRecord(DeltaRecord, encodePayload(op.position, op.removed, op.text)));
+            }
+            break;
+        case OpKind::Checkpoint:
+            // Снимок делает все предыдущие правки ненужными
+            rewrite = true;
+            discarded = false;
+            appended.clear();
+            rewritten = encodeRecord(CheckpointRecord, encodePayload(op.documentPath, op.clean, op.text));
+            break;
+        case OpKind::Rebase:
+            // Правки до этой точки уже в файле; журнал создается заново,
+            // когда придет следующая правка, и начинается со ссылки на файл
+            file.close();
+            QFile::remove(journalPath);
+            basePath = op.documentPath;
+            baseFileSize = op.fileSize;
+            baseFileModified = op.fileModified;
+            discarded = false;
+            rewrite = false;
+            appended.clear();
+            rewritten.clear();
+            break;
+        case OpKind::Discard:
+            file.close();
+            QFile::remove(journalPath);
+            discarded = true;
+            rewrite = false;
+            appended.clear();
+            rewritten.clear();
+            break;
+        }
+    }
+
+    if (rewrite) {
+        file.close();
+        QSaveFile out(journalPath);
+        if (!out.open(QIODevice::WriteOnly) ||
+            out.write(journalHeader() + rewritten) < 0 || !out.commit()) {
+            qWarning() << "Failed to write journal checkpoint" << journalPath;
+        }
+        return;
+    }
+
+    if (appended.isEmpty() || discarded) {
+        return;
+    }
+
+    if (!file.isOpen()) {
+        bool exists = QFile::exists(journalPath);
+        file.setFileName(journalPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            qWarning() << "Failed to open journal" << journalPath;
+            return;
+        }
+        if (!exists) {
+            appended.prepend(journalHeader() + baseRecord());
+        }
+    }
+
+    if (file.write(appended) < 0 || !file.flush()) {
+        qWarning() << "Failed to append to journal" << journalPath;
+    }
+}
+
+bool EditJournal::recover(const QString& journalPath, const Loader& loader, Recovery& result) {
+    QFile in(journalPath);
+    if (!in.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("Cannot open journal: " + in.errorString().toStdString());
+    }
+    QByteArray data = in.readAll();
+    in.close();
+
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    stream >> magic >> version;
+    if (stream.status() != QDataStream::Ok || magic != journalMagic || version != journalVersion) {
+        throw std::runtime_error("Unsupported journal format");
+    }
+
+    bool hasBase = false;
+    bool clean = true;
+    result = Recovery();
+
+    while (!stream.atEnd()) {
+        quint8 type = 0;
+        quint32 size = 0;
+        stream >> type >> size;
+        if (stream.status() != QDataStream::Ok || size > static_cast<quint32>(data.size())) {
+            break;
+        }
+        QByteArray payload(static_cast<int>(size), Qt::Uninitialized);
+        if (stream.readRawData(payload.data(), payload.size()) != payload.size()) {
+            break;
+        }
+        quint16 checksum = 0;
+        stream >> checksum;
+        // Оборванная запись в конце журнала означает сбой во время записи
+        if (stream.status() != QDataStream::Ok ||
+            checksum != qChecksum(payload.constData(), static_cast<uint>(payload.size()))) {
+            break;
+        }
+
+        QDataStream record(payload);
+        record.setVersion(QDataStream::Qt_5_0);
+        if (type == FileBaseRecord) {
+            qint64 fileSize = 0;
+            qint64 modified = 0;
+            record >> result.documentPath >> fileSize >> modified;
+            QFileInfo info(result.documentPath);
+            if (!info.exists() || info.size() != fileSize ||
+                info.lastModified().toMSecsSinceEpoch() != modified) {
+                throw std::runtime_error("Journal base file has changed: " + result.documentPath.toStdString());
+            }
+            result.text = loader(result.documentPath);
+            result.replayedEdits = 0;
+            hasBase = true;
+            clean = true;
+        } else if (type == CheckpointRecord) {
+            record >> result.documentPath >> clean >> result.text;
+            result.replayedEdits = 0;
+            hasBase = true;
+        } else if (type == DeltaRecord && hasBase) {
+            qint32 position = 0;
+            qint32 removed = 0;
+            QString inserted;
+            record >> position >> removed >> inserted;
+            result.text.replace(position, removed, inserted);
+            ++result.replayedEdits;
+            clean = false;
+        } else {
+            break;
+        }
+    }
+
+    return hasBase && !clean;
+}
@@ -1,57 +1,118 @@
 #include "EditorState.hpp"
+#include "EditJournal.hpp"
 #include <QDateTime>
 
-EditorContext::EditorContext() : state(std::make_shared<SavedState>()) {
+EditorContext::EditorContext()
+    : state(SavedState::getInstance()), revision(0), savedRevision(0), deferNotify(false) {
     status = state->getStateName();
 }
 
 void EditorContext::setState(std::shared_ptr<IEditorState> newState) {
+    // Повторная установка того же состояния переходом не считается
+    if (newState == state) return;
     this->state = newState;
     this->status = state->getStateName();
     this->lastModified = QDateTime::currentDateTime();
-    notifyStateChanged();
+    if (!deferNotify) {
+        notifyStateChanged();
+    }
 }
 
 void EditorContext::requestEdit(const QString& text) {
     if (state) {
-        state->handleEdit(this, text);
-        notifyStateChanged();
+        ++revision;
+        transition([&] { state->handleEdit(this, text); });
     }
 }
 
 void EditorContext::requestSave() {
     if (state) {
-        state->handleSave(this);
+        transition([&] { state->handleSave(this); });
+    }
+}
+
+void EditorContext::requestTick() {
+    if (state) {
+        transition([&] { state->handleTick(this); });
+    }
+}
+
+void EditorContext::transition(const std::function<void()>& handler) {
+    QString before = status;
+    std::shared_ptr<IEditorState> previous = state;
+    // Обработчик может сменить и состояние, и статус; наблюдатели узнают
+    // об этом один раз и только если что-то изменилось
+    deferNotify = true;
+    handler();
+    deferNotify = false;
+    if (state != previous || status != before) {
         notifyStateChanged();
     }
 }
 
+void EditorContext::recordEdit() {
+    ++revision;
+    syncDirtyState();
+}
+
+void EditorContext::markSaved() {
+    savedRevision = revision;
+    syncDirtyState();
+}
+
+void EditorContext::syncDirtyState() {
+    // Измененный документ с журналом автосохраняется в журнал; ошибка не
+    // зависит от того, сохранен ли текст
+    if (isDirty() && dynamic_cast<SavedState*>(state.get())) {
+        setState(journal ? AutoSavingState::getInstance() : ModifiedState::getInstance());
+    } else if (!isDirty() && (dynamic_cast<ModifiedState*>(state.get()) ||
+                              dynamic_cast<AutoSavingState*>(state.get()))) {
+        setState(SavedState::getInstance());
+    }
+}
+
 QString EditorContext::getStatus() const {
     return status;
 }
 
+void EditorContext::setTextProvider(std::function<QString()> provider) {
+    textProvider = std::move(provider);
+}
+
+QString EditorContext::currentText() const {
+    return textProvider ? textProvider() : QString();
+}
+
 QDateTime EditorContext::getLastModified() const {
     return lastModified;
 }
 
 void EditorContext::notifyStateChanged() {
-    for (const auto& observer : observers) {
-        if (observer) {
-            observer->onStateChanged(status);
-        }
-    }
+    observers.forEach([this](const std::shared_ptr<IStateObserver>& observer) {
+        observer->onStateChanged(status);
+    });
 }
 
-void EditorContext::addStateObserver(std::shared_ptr<IStateObserver> observer) {
-    if (observer) {
-        observers.push_back(observer);
-    }
+void EditorContext::setJournal(std::shared_ptr<EditJournal> newJournal) {
+    journal = newJournal;
+}
+
+std::shared_ptr<EditJournal> EditorContext::getJournal() const {
+    return journal;
+}
+
+Subscription EditorContext::addStateObserver(std::shared_ptr<IStateObserver> observer) {
+    return observers.subscribe(std::move(observer));
 }
 
 // Saved State
-void SavedState::handleEdit(EditorContext* context, const QString& text) {
-    context->content = text;
-    context->setState(std::make_shared<ModifiedState>());
+const std::shared_ptr<IEditorState>& SavedState::getInstance() {
+    static const std::shared_ptr<IEditorState> instance = std::make_shared<SavedState>();
+    return instance;
+}
+
+void SavedState::handleEdit(EditorContext* context, const QString&) {
+    context->setState(ModifiedState::getInstance());
 }
 
 void SavedState::handleSave(EditorContext* context) {
@@ -64,14 +125,19 @@ QString SavedState::getStateName() const {
 }
 
 // Modified State
-void ModifiedState::handleEdit(EditorContext* context, const QString& text) {
-    context->content = text;
+const std::shared_ptr<IEditorState>& ModifiedState::getInstance() {
+    static const std::shared_ptr<IEditorState> instance = std::make_shared<ModifiedState>();
+    return instance;
+}
+
+void ModifiedState::handleEdit(EditorContext* context, const QString&) {
     context->status = "Document modified";
 }
 
 void ModifiedState::handleSave(EditorContext* context) {
     // Здесь была бы логика сохранения
-    context->setState(std::make_shared<SavedState>());
+    context->savedRevision = context->revision;
+    context->setState(SavedState::getInstance());
     context->status = "Document saved successfully";
 }
 
@@ -80,28 +146,58 @@ QString ModifiedState::getStateName() const {
 }
 
 // AutoSaving State
+const std::shared_ptr<IEditorState>& AutoSavingState::getInstance() {
+    static const std::shared_ptr<IEditorState> instance = std::make_shared<AutoSavingState>();
+    return instance;
+}
+
 void AutoSavingState::handleEdit(EditorContext* context, const QString& text) {
-    context->content = text;
-    if (shouldAutoSave()) {
-        handleSave(context);
+    if (shouldAutoSave(context)) {
+        // Текст правки уже на руках, поставщик текста не нужен
+        checkpoint(context, text);
     } else {
         context->status = "Document modified (auto-save pending)";
     }
 }
 
 void AutoSavingState::handleSave(EditorContext* context) {
-    // Здесь была бы логика автосохранения
-    lastAutoSave = QDateTime::currentDateTime();
-    context->setState(std::make_shared<SavedState>());
+    // Файл записан; журнал больше не хранит несохраненных правок
+    context->savedRevision = context->revision;
+    context->setState(SavedState::getInstance());
+    context->status = "Document saved successfully";
+}
+
+void AutoSavingState::checkpoint(EditorContext* context, const QString& text) {
+    // Снимок уходит в журнал восстановления; сам файл не перезаписывается,
+    // поэтому документ остается в состоянии автосохранения
+    if (context->journal) {
+        context->journal->checkpoint(text);
+    }
+    // Время снимка хранится в контексте: экземпляр состояния общий
+    context->lastAutoSave = QDateTime::currentDateTime();
     context->status = "Document auto-saved";
 }
 
+void AutoSavingState::handleTick(EditorContext* context) {
+    if (shouldAutoSave(context)) {
+        checkpoint(context, context->currentText());
+    }
+}
+
 QString AutoSavingState::getStateName() const {
     return "AutoSaving";
 }
 
-bool AutoSavingState::shouldAutoSave() const {
-    return lastAutoSave.secsTo(QDateTime::currentDateTime()) >= autoSaveInterval;
+bool AutoSavingState::shouldAutoSave(const EditorContext* context) const {
+    // Правки и так попадают в журнал; снимок нужен, когда их накопилось
+    // столько, что восстановление стало бы долгим
+    if (context->journal) {
+        return context->journal->needsCheckpoint();
+    }
+    if (!context->lastAutoSave.isValid()) {
+        return true;
+    }
+    return context->lastAutoSave.secsTo(QDateTime::currentDateTime()) >= autoSaveInterval;
 }
 
 // Error State
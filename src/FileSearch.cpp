@@ -0,0 +1,316 @@
+#include "FileSearch.hpp"
+#include "WorkStealingPool.hpp"
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Символов перед совпадением, которые остаются в строке предпросмотра
+const int previewContext = 40;
+
+bool isContinuationByte(char byte) {
+    return (uchar(byte) & 0xC0) == 0x80;
+}
+
+// Длина текста UTF-8 в кодовых единицах UTF-16
+int utf16Length(const char* data, qint64 length) {
+    int units = 0;
+    for (qint64 i = 0; i < length; ++i) {
+        if (!isContinuationByte(data[i])) ++units;
+        // Символ вне BMP занимает суррогатную пару
+        if (uchar(data[i]) >= 0xF0) ++units;
+    }
+    return units;
+}
+
+QString bytePreview(const char* data, qint64 lineStart, qint64 start, qint64 lineEnd) {
+    qint64 begin = qMax(lineStart, start - previewContext);
+    while (begin > lineStart && isContinuationByte(data[begin])) --begin;
+    qint64 end = qMin(lineEnd, begin + FileSearch::previewLength);
+    while (end < lineEnd && end > begin && isContinuationByte(data[end])) --end;
+    if (end > begin && data[end - 1] == '\r') --end;
+    return QString::fromUtf8(data + begin, static_cast<int>(end - begin));
+}
+
+QString charPreview(const QString& text, int lineStart, int start, int lineEnd) {
+    int begin = qMax(lineStart, start - previewContext);
+    if (begin > lineStart && text.at(begin).isLowSurrogate()) --begin;
+    int end = qMin(lineEnd, begin + FileSearch::previewLength);
+    if (end < lineEnd && end > begin && text.at(end).isLowSurrogate()) --end;
+    if (end > begin && text.at(end - 1) == QLatin1Char('\r')) --end;
+    return text.mid(begin, end - begin);
+}
+
+} // namespace
+
+FileSearch::Run::Run(quint64 generation, const QVector<OpenBuffer>& buffers, const FileSearchOptions& options,
+                     const TextSearch& search)
+    : generation(generation), buffers(buffers), options(options), matcher(search),
+      files(0), binaryFiles(0), unreadableFiles(0), bytes(0), matches(0), truncated(false) {
+    SearchOptions settings = search.options();
+    if (settings.caseSensitive && !settings.regularExpression) {
+        bytePattern = search.pattern().toUtf8();
+    }
+}
+
+FileSearch::FileSearch(ResultHandler resultHandler, FinishedHandler finishedHandler)
+    : resultHandler(std::move(resultHandler)), finishedHandler(std::move(finishedHandler)), generation(0) {
+    if (!this->resultHandler || !this->finishedHandler) {
+        throw std::invalid_argument("Search handlers cannot be null");
+    }
+}
+
+FileSearch::~FileSearch() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++generation;
+    threads.joinAll();
+}
+
+quint64 FileSearch::start(const QVector<OpenBuffer>& buffers, const FileSearchOptions& options,
+                          const TextSearch& search) {
+    std::lock_guard<std::mutex> lock(mutex);
+    quint64 current = ++generation;
+    auto state = std::make_shared<Run>(current, buffers, options, search);
+    threads.start([this, state]() { run(state); });
+    return current;
+}
+
+void FileSearch::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++generation;
+    threads.retire();
+}
+
+void FileSearch::wait() {
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.wait();
+}
+
+bool FileSearch::isBinary(const char* data, qint64 length) {
+    return length > 0 && std::memchr(data, 0, static_cast<size_t>(length)) != nullptr;
+}
+
+bool FileSearch::stopped(const Run& state) const {
+    return generation.load(std::memory_order_relaxed) != state.generation || state.truncated.load();
+}
+
+bool FileSearch::accept(Run& state) {
+    if (state.matches.fetch_add(1) < state.options.maxMatches) return true;
+    state.truncated = true;
+    return false;
+}
+
+void FileSearch::deliver(const Run& state, QVector<FileMatch>& found) {
+    if (!found.isEmpty() && generation.load() == state.generation) {
+        resultHandler(state.generation, found);
+    }
+    found.clear();
+}
+
+void FileSearch::run(std::shared_ptr<Run> state) {
+    QElapsedTimer timer;
+    timer.start();
+    {
+        WorkStealingPool pool(state->options.threads);
+        QSet<QString> openPaths;
+        for (int i = 0; i < state->buffers.size(); ++i) {
+            QFileInfo info(state->buffers[i].path);
+            if (info.isAbsolute()) openPaths.insert(info.absoluteFilePath());
+            pool.submit([this, state, i]() { searchBuffer(*state, i); });
+        }
+        // Файлы уходят в пул по мере обхода, не дожидаясь полного списка
+        for (const QString& directory : state->options.directories) {
+            QDirIterator it(directory, state->options.nameFilters, QDir::Files | QDir::NoDotAndDotDot,
+                            QDirIterator::Subdirectories);
+            while (it.hasNext() && !stopped(*state)) {
+                QString path = it.next();
+                if (openPaths.contains(it.fileInfo().absoluteFilePath())) continue;
+                pool.submit([this, state, path]() { searchFile(*state, path); });
+            }
+        }
+        pool.wait();
+    }
+
+    if (generation.load() == state->generation) {
+        FileSearchSummary summary;
+        summary.files = state->files;
+        summary.binaryFiles = state->binaryFiles;
+        summary.unreadableFiles = state->unreadableFiles;
+        summary.bytes = state->bytes;
+        summary.matches = qMin(state->matches.load(), state->options.maxMatches);
+        summary.truncated = state->truncated;
+        summary.elapsedMs = timer.elapsed();
+        finishedHandler(state->generation, summary);
+    }
+}
+
+void FileSearch::searchBuffer(Run& state, int index) {
+    if (stopped(state)) return;
+    const OpenBuffer& buffer = state.buffers[index];
+    ++state.files;
+    QVector<FileMatch> found;
+    Position position = {1, 0};
+    searchChars(state, buffer.text, position, buffer.path, index, false, found);
+    deliver(state, found);
+}
+
+void FileSearch::searchFile(Run& state, const QString& path) {
+    if (stopped(state)) return;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        ++state.unreadableFiles;
+        return;
+    }
+    ++state.files;
+
+    const qint64 size = file.size();
+    QVector<FileMatch> found;
+    QByteArray fallback;
+    qint64 offset = 0;
+    Position position = {1, 0};
+    while (offset < size && !stopped(state)) {
+        qint64 length = qMin(windowSize, size - offset);
+        uchar* mapped = file.map(offset, length);
+        const char* data = reinterpret_cast<const char*>(mapped);
+        if (!mapped) {
+            // Файловые системы без поддержки отображения читаются окнами
+            file.seek(offset);
+            fallback = file.read(length);
+            if (fallback.isEmpty()) break;
+            data = fallback.constData();
+            length = fallback.size();
+        }
+
+        // Нулевой байт в начале файла почти всегда означает двоичные данные
+        if (offset == 0 && isBinary(data, qMin<qint64>(length, binaryProbeLength))) {
+            ++state.binaryFiles;
+            if (mapped) file.unmap(mapped);
+            return;
+        }
+
+        // Окно заканчивается на переводе строки, чтобы строки и символы не разрезались
+        const bool last = offset + length >= size;
+        qint64 cut = length;
+        if (!last) {
+            const char* lineBreak = data + length - 1;
+            while (lineBreak >= data && *lineBreak != '\n') --lineBreak;
+            if (lineBreak >= data) {
+                cut = lineBreak - data + 1;
+            } else {
+                // Строка длиннее окна режется перед последним символом
+                cut = length - 1;
+                while (cut > 1 && isContinuationByte(data[cut])) --cut;
+            }
+        }
+
+        if (state.bytePattern.isEmpty()) {
+            searchChars(state, QString::fromUtf8(data, static_cast<int>(cut)), position, path, -1, !last, found);
+        } else {
+            searchBytes(state, data, cut, position, path, !last, found);
+        }
+        state.bytes += cut;
+        offset += cut;
+        if (mapped) file.unmap(mapped);
+    }
+    deliver(state, found);
+}
+
+void FileSearch::searchBytes(Run& state, const char* data, qint64 length, Position& position, const QString& path,
+                             bool countLines, QVector<FileMatch>& found) {
+    const char* pattern = state.bytePattern.constData();
+    const qint64 patternLength = state.bytePattern.size();
+    const int matchLength = state.matcher.pattern().size();
+    // Переводы строк просчитаны до counted; колонка растет от совпадения к
+    // совпадению, чтобы длинная строка не просматривалась с начала для каждого
+    qint64 counted = 0;
+    qint64 lineStart = 0;
+    qint64 columnFrom = 0;
+    int column = position.column;
+    auto countLineBreaks = [&](qint64 to) {
+        while (const char* lineBreak = static_cast<const char*>(
+                   std::memchr(data + counted, '\n', static_cast<size_t>(to - counted)))) {
+            ++position.line;
+            counted = lineBreak - data + 1;
+            lineStart = counted;
+        }
+        counted = to;
+        if (lineStart > columnFrom) {
+            columnFrom = lineStart;
+            column = 0;
+        }
+        column += utf16Length(data + columnFrom, to - columnFrom);
+        columnFrom = to;
+    };
+
+    // Конец строки последнего совпадения; следующие совпадения той же строки его не ищут заново
+    qint64 lineEnd = -1;
+    qint64 offset = 0;
+    while (offset + patternLength <= length) {
+        const char* hit = static_cast<const char*>(
+            std::memchr(data + offset, pattern[0], static_cast<size_t>(length - patternLength - offset + 1)));
+        if (!hit) break;
+        const qint64 start = hit - data;
+        if (std::memcmp(hit, pattern, static_cast<size_t>(patternLength)) != 0) {
+            offset = start + 1;
+            continue;
+        }
+        if (stopped(state) || !accept(state)) return;
+
+        countLineBreaks(start);
+        if (lineEnd < start) {
+            const char* lineBreak = static_cast<const char*>(
+                std::memchr(hit, '\n', static_cast<size_t>(length - start)));
+            lineEnd = lineBreak ? lineBreak - data : length;
+        }
+        found.append({path, -1, position.line, column, matchLength, bytePreview(data, lineStart, start, lineEnd)});
+        if (found.size() >= batchSize) deliver(state, found);
+        offset = start + patternLength;
+    }
+
+    if (countLines) {
+        countLineBreaks(length);
+        position.column = column;
+    }
+}
+
+void FileSearch::searchChars(Run& state, const QString& text, Position& position, const QString& path, int buffer,
+                             bool countLines, QVector<FileMatch>& found) {
+    const QChar* data = text.constData();
+    int counted = 0;
+    int lineStart = 0;
+    // Колонка начала окна относится только к его первой строке
+    int firstColumn = position.column;
+    auto countLineBreaks = [&](int to) {
+        for (; counted < to; ++counted) {
+            if (data[counted] == QLatin1Char('\n')) {
+                ++position.line;
+                lineStart = counted + 1;
+                firstColumn = 0;
+            }
+        }
+    };
+
+    int lineEnd = -1;
+    state.matcher.forEachMatch(text, [&](const SearchMatch& match) {
+        if (stopped(state) || !accept(state)) return false;
+        countLineBreaks(match.start);
+        if (lineEnd < match.start) {
+            lineEnd = text.indexOf(QLatin1Char('\n'), match.start);
+            if (lineEnd < 0) lineEnd = text.size();
+        }
+        found.append({path, buffer, position.line, firstColumn + match.start - lineStart, match.length,
+                      charPreview(text, lineStart, match.start, lineEnd)});
+        if (found.size() >= batchSize) deliver(state, found);
+        return true;
+    });
+
+    if (countLines) {
+        countLineBreaks(text.size());
+        position.column = firstColumn + text.size() - lineStart;
+    }
+}
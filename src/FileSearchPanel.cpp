@@ -0,0 +1,177 @@
+#include "FileSearchPanel.hpp"
+#include <QDir>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QToolButton>
+#include <QVBoxLayout>
+
+namespace {
+
+QStringList splitList(const QString& text) {
+    QStringList items;
+    for (const QString& item : text.split(QLatin1Char(';'))) {
+        QString trimmed = item.trimmed();
+        if (!trimmed.isEmpty()) items.append(trimmed);
+    }
+    return items;
+}
+
+} // namespace
+
+FileSearchPanel::FileSearchPanel(QWidget* parent) : QWidget(parent), searching(false) {
+    patternEdit = new QLineEdit(this);
+    patternEdit->setPlaceholderText(tr("Find in files"));
+    patternEdit->setClearButtonEnabled(true);
+    directoryEdit = new QLineEdit(QDir::currentPath(), this);
+    directoryEdit->setPlaceholderText(tr("Directories"));
+    filterEdit = new QLineEdit(this);
+    filterEdit->setPlaceholderText(tr("File names, e.g. *.txt; *.html"));
+    caseBox = new QCheckBox(tr("Match case"), this);
+    regexBox = new QCheckBox(tr("Regular expression"), this);
+    openTabsBox = new QCheckBox(tr("Open tabs"), this);
+    openTabsBox->setChecked(true);
+    searchButton = new QPushButton(tr("Search"), this);
+    QToolButton* browseButton = new QToolButton(this);
+    browseButton->setText(tr("..."));
+
+    results = new QTreeWidget(this);
+    results->setHeaderHidden(true);
+    results->setUniformRowHeights(true);
+    results->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    statusLabel = new QLabel(this);
+
+    QHBoxLayout* patternRow = new QHBoxLayout();
+    patternRow->addWidget(patternEdit, 1);
+    patternRow->addWidget(caseBox);
+    patternRow->addWidget(regexBox);
+    patternRow->addWidget(searchButton);
+
+    QHBoxLayout* whereRow = new QHBoxLayout();
+    whereRow->addWidget(directoryEdit, 2);
+    whereRow->addWidget(browseButton);
+    whereRow->addWidget(filterEdit, 1);
+    whereRow->addWidget(openTabsBox);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 2, 4, 2);
+    layout->addLayout(patternRow);
+    layout->addLayout(whereRow);
+    layout->addWidget(results, 1);
+    layout->addWidget(statusLabel);
+
+    connect(patternEdit, &QLineEdit::returnPressed, this, &FileSearchPanel::searchRequested);
+    connect(directoryEdit, &QLineEdit::returnPressed, this, &FileSearchPanel::searchRequested);
+    connect(filterEdit, &QLineEdit::returnPressed, this, &FileSearchPanel::searchRequested);
+    connect(browseButton, &QToolButton::clicked, this, &FileSearchPanel::chooseDirectory);
+    // Во время поиска кнопка останавливает его
+    connect(searchButton, &QPushButton::clicked, this, [this]() {
+        if (searching) {
+            emit cancelRequested();
+        } else {
+            emit searchRequested();
+        }
+    });
+    connect(results, &QTreeWidget::itemActivated, this, [this](QTreeWidgetItem* item) {
+        QVariant index = item->data(0, Qt::UserRole);
+        if (index.isValid()) emit matchActivated(matches[index.toInt()]);
+    });
+}
+
+QString FileSearchPanel::pattern() const {
+    return patternEdit->text();
+}
+
+SearchOptions FileSearchPanel::options() const {
+    SearchOptions options;
+    options.caseSensitive = caseBox->isChecked();
+    options.regularExpression = regexBox->isChecked();
+    return options;
+}
+
+FileSearchOptions FileSearchPanel::fileOptions() const {
+    FileSearchOptions options;
+    options.directories = splitList(directoryEdit->text());
+    options.nameFilters = splitList(filterEdit->text());
+    return options;
+}
+
+bool FileSearchPanel::searchOpenTabs() const {
+    return openTabsBox->isChecked();
+}
+
+void FileSearchPanel::activate(const QString& text) {
+    if (!text.isEmpty() && !text.contains(QChar::ParagraphSeparator) && !text.contains(QLatin1Char('\n'))) {
+        patternEdit->setText(text);
+    }
+    patternEdit->setFocus();
+    patternEdit->selectAll();
+}
+
+void FileSearchPanel::setDirectory(const QString& directory) {
+    directoryEdit->setText(QDir::toNativeSeparators(directory));
+}
+
+void FileSearchPanel::chooseDirectory() {
+    QString directory = QFileDialog::getExistingDirectory(this, tr("Search in Directory"), directoryEdit->text());
+    if (!directory.isEmpty()) {
+        setDirectory(directory);
+    }
+}
+
+void FileSearchPanel::clearResults() {
+    results->clear();
+    matches.clear();
+    fileItems.clear();
+    statusLabel->setStyleSheet("");
+    statusLabel->clear();
+}
+
+void FileSearchPanel::addResults(const QVector<FileMatch>& batch) {
+    // Пачки приходят во время поиска, поэтому перерисовка откладывается до конца вставки
+    results->setUpdatesEnabled(false);
+    for (const FileMatch& match : batch) {
+        QTreeWidgetItem*& fileItem = fileItems[match.path];
+        if (!fileItem) {
+            fileItem = new QTreeWidgetItem(results, QStringList(QDir::toNativeSeparators(match.path)));
+            fileItem->setExpanded(true);
+        }
+        auto* item = new QTreeWidgetItem(fileItem, QStringList(
+            tr("%1: %2").arg(match.line).arg(match.preview.trimmed())));
+        item->setData(0, Qt::UserRole, matches.size());
+        matches.append(match);
+    }
+    results->setUpdatesEnabled(true);
+    statusLabel->setText(tr("%1 matches in %2 files...").arg(matches.size()).arg(fileItems.size()));
+}
+
+void FileSearchPanel::setSearching(bool searching) {
+    this->searching = searching;
+    searchButton->setText(searching ? tr("Stop") : tr("Search"));
+    if (searching) {
+        statusLabel->setText(tr("Searching..."));
+    }
+}
+
+void FileSearchPanel::setSummary(const FileSearchSummary& summary) {
+    setSearching(false);
+    QString text = tr("%1 matches in %2 of %3 files, %4 MB in %5 ms")
+        .arg(summary.matches).arg(fileItems.size()).arg(summary.files)
+        .arg(summary.bytes / (1024.0 * 1024.0), 0, 'f', 1).arg(summary.elapsedMs);
+    if (summary.binaryFiles > 0) {
+        text += tr(", %1 binary skipped").arg(summary.binaryFiles);
+    }
+    if (summary.unreadableFiles > 0) {
+        text += tr(", %1 unreadable").arg(summary.unreadableFiles);
+    }
+    if (summary.truncated) {
+        text += tr(" (stopped at the match limit)");
+    }
+    statusLabel->setText(text);
+}
+
+void FileSearchPanel::setError(const QString& message) {
+    setSearching(false);
+    statusLabel->setStyleSheet("QLabel { color: #FF6B6B; }");
+    statusLabel->setText(message);
+}
@@ -0,0 +1,56 @@
+#include "FileStatistics.hpp"
+#include "TextIterator.hpp"
+#include <QFile>
+#include <QTextCodec>
+#include <QTextDecoder>
+#include <memory>
+#include <stdexcept>
+
+FileStatistics countFileStatistics(const QString& filePath, int chunkSize) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error(QString("Cannot open file for reading: %1").arg(filePath).toStdString());
+    }
+
+    // Декодер хранит состояние между окнами, как QTextStream в FileHandler
+    std::unique_ptr<QTextDecoder> decoder(QTextCodec::codecForName("UTF-8")->makeDecoder());
+    TextCounter counter;
+    FileStatistics statistics;
+    QByteArray fallback;
+
+    const qint64 size = file.size();
+    qint64 offset = 0;
+    // Зарезервированный буфер переиспользуется декодером во всех окнах
+    QString text;
+    text.reserve(chunkSize);
+    while (true) {
+        qint64 length = qMin<qint64>(chunkSize, size - offset);
+        uchar* mapped = length > 0 ? file.map(offset, length) : nullptr;
+        const char* data = reinterpret_cast<const char*>(mapped);
+        if (!mapped) {
+            // Файлы без поддержки отображения (каналы, /proc) читаются блоками
+            if (!file.isSequential() && file.pos() != offset) {
+                file.seek(offset);
+            }
+            fallback = file.read(chunkSize);
+            if (fallback.isEmpty()) break;
+            data = fallback.constData();
+            length = fallback.size();
+        }
+
+        decoder->toUnicode(&text, data, static_cast<int>(length));
+        counter.feed(text.constData(), text.size());
+        statistics.bytes += length;
+        offset += length;
+
+        if (mapped) {
+            file.unmap(mapped);
+        }
+    }
+
+    counter.finish();
+    statistics.chars = counter.charCount();
+    statistics.words = counter.wordCount();
+    statistics.lines = counter.lineCount();
+    return statistics;
+}
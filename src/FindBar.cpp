@@ -0,0 +1,120 @@
+#include "FindBar.hpp"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QToolButton>
+
+FindBar::FindBar(QWidget* parent) : QWidget(parent) {
+    findEdit = new QLineEdit(this);
+    findEdit->setPlaceholderText(tr("Find"));
+    findEdit->setClearButtonEnabled(true);
+    replaceEdit = new QLineEdit(this);
+    replaceEdit->setPlaceholderText(tr("Replace"));
+    caseBox = new QCheckBox(tr("Match case"), this);
+    regexBox = new QCheckBox(tr("Regular expression"), this);
+    countLabel = new QLabel(this);
+    countLabel->setMinimumWidth(120);
+
+    QPushButton* previousButton = new QPushButton(tr("Previous"), this);
+    QPushButton* nextButton = new QPushButton(tr("Next"), this);
+    QPushButton* replaceButton = new QPushButton(tr("Replace"), this);
+    QPushButton* replaceAllButton = new QPushButton(tr("Replace All"), this);
+    QToolButton* closeButton = new QToolButton(this);
+    closeButton->setIcon(QIcon::fromTheme("window-close"));
+    closeButton->setAutoRaise(true);
+
+    QHBoxLayout* findRow = new QHBoxLayout();
+    findRow->addWidget(findEdit, 1);
+    findRow->addWidget(previousButton);
+    findRow->addWidget(nextButton);
+    findRow->addWidget(caseBox);
+    findRow->addWidget(regexBox);
+    findRow->addWidget(countLabel);
+    findRow->addWidget(closeButton);
+
+    replaceRow = new QWidget(this);
+    QHBoxLayout* replaceLayout = new QHBoxLayout(replaceRow);
+    replaceLayout->setContentsMargins(0, 0, 0, 0);
+    replaceLayout->addWidget(replaceEdit, 1);
+    replaceLayout->addWidget(replaceButton);
+    replaceLayout->addWidget(replaceAllButton);
+    replaceLayout->addStretch();
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 2, 4, 2);
+    layout->addLayout(findRow);
+    layout->addWidget(replaceRow);
+
+    connect(findEdit, &QLineEdit::textChanged, this, &FindBar::searchChanged);
+    connect(caseBox, &QCheckBox::toggled, this, &FindBar::searchChanged);
+    connect(regexBox, &QCheckBox::toggled, this, &FindBar::searchChanged);
+    connect(findEdit, &QLineEdit::returnPressed, this, &FindBar::findNext);
+    connect(replaceEdit, &QLineEdit::returnPressed, this, &FindBar::replaceOne);
+    connect(nextButton, &QPushButton::clicked, this, &FindBar::findNext);
+    connect(previousButton, &QPushButton::clicked, this, &FindBar::findPrevious);
+    connect(replaceButton, &QPushButton::clicked, this, &FindBar::replaceOne);
+    connect(replaceAllButton, &QPushButton::clicked, this, &FindBar::replaceAll);
+    connect(closeButton, &QToolButton::clicked, this, [this]() {
+        hide();
+        emit closed();
+    });
+}
+
+QString FindBar::pattern() const {
+    return findEdit->text();
+}
+
+QString FindBar::replacement() const {
+    return replaceEdit->text();
+}
+
+SearchOptions FindBar::options() const {
+    SearchOptions options;
+    options.caseSensitive = caseBox->isChecked();
+    options.regularExpression = regexBox->isChecked();
+    return options;
+}
+
+void FindBar::showFind(const QString& text) {
+    open(false, text);
+}
+
+void FindBar::showReplace(const QString& text) {
+    open(true, text);
+}
+
+void FindBar::open(bool withReplace, const QString& text) {
+    replaceRow->setVisible(withReplace);
+    show();
+    // Выделенный текст из одной строки становится образцом
+    if (!text.isEmpty() && !text.contains(QChar::ParagraphSeparator) && !text.contains(QLatin1Char('\n'))) {
+        findEdit->setText(text);
+    }
+    findEdit->setFocus();
+    findEdit->selectAll();
+}
+
+void FindBar::setMatchCount(int current, int total, bool searching) {
+    countLabel->setStyleSheet("");
+    if (total == 0) {
+        countLabel->setText(searching ? tr("Searching...") : tr("No matches"));
+    } else if (current >= 0) {
+        countLabel->setText(tr("%1 of %2%3").arg(current + 1).arg(total).arg(searching ? "+" : ""));
+    } else {
+        countLabel->setText(tr("%1%2 matches").arg(total).arg(searching ? "+" : ""));
+    }
+}
+
+void FindBar::setError(const QString& message) {
+    countLabel->setStyleSheet("QLabel { color: #FF6B6B; }");
+    countLabel->setText(message);
+}
+
+void FindBar::keyPressEvent(QKeyEvent* event) {
+    if (event->key() == Qt::Key_Escape) {
+        hide();
+        emit closed();
+        return;
+    }
+    QWidget::keyPressEvent(event);
+}
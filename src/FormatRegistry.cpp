@@ -0,0 +1,141 @@
+#include "FormatRegistry.hpp"
+#include <QFile>
+#include <QFileInfo>
+#include <cstring>
+
+namespace {
+
+// ASCII view of a prefix in UTF-8 or UTF-16; non-ASCII code units read as 0
+class PrefixReader {
+public:
+    PrefixReader(const uchar* data, qint64 size) : data(data), size(size), position(0), step(1), high(0) {
+        if (size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
+            position = 3;
+        } else if (size >= 2 && data[0] == 0xFF && data[1] == 0xFE) {
+            position = 2;
+            step = 2;
+            high = 1;
+        } else if (size >= 2 && data[0] == 0xFE && data[1] == 0xFF) {
+            position = 2;
+            step = 2;
+            high = 0;
+        }
+    }
+
+    char at(qint64 index) const {
+        qint64 offset = position + index * step;
+        if (offset + step > size) return 0;
+        if (step == 2) {
+            uchar low = data[offset + 1 - high];
+            return data[offset + high] == 0 && low < 0x80 ? static_cast<char>(low) : 0;
+        }
+        return data[offset] < 0x80 ? static_cast<char>(data[offset]) : 0;
+    }
+
+    qint64 length() const { return (size - position) / step; }
+
+    void skipSpaces() {
+        while (length() > 0) {
+            char c = at(0);
+            if (c != ' ' && c != '\t' && c != '\r' && c != '\n') break;
+            position += step;
+        }
+    }
+
+    bool startsWith(const char* pattern, qint64 from = 0) const {
+        for (qint64 k = 0; pattern[k]; ++k) {
+            char c = at(from + k);
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c | 0x20);
+            if (c != pattern[k]) return false;
+        }
+        return true;
+    }
+
+    bool contains(const char* pattern) const {
+        for (qint64 i = 0; i < length(); ++i) {
+            if (startsWith(pattern, i)) return true;
+        }
+        return false;
+    }
+
+private:
+    const uchar* data;
+    qint64 size;
+    qint64 position;
+    int step;
+    int high;
+};
+
+} // namespace
+
+FormatRegistry& FormatRegistry::getInstance() {
+    static FormatRegistry instance;
+    return instance;
+}
+
+FormatRegistry::FormatRegistry() {
+    formats.push_back({DocumentFormat::PlainText, "txt",
+                       0,
+                       std::make_shared<TextDocumentAdapter>()});
+    formats.push_back({DocumentFormat::Html, "html",
+                       FormatInfo::RichText,
+                       std::make_shared<HtmlDocumentAdapter>()});
+    formats.push_back({DocumentFormat::Xml, "xml",
+                       0,
+                       std::make_shared<XmlDocumentAdapter>()});
+    formats.push_back({DocumentFormat::Rtf, "rtf",
+                       FormatInfo::RichText,
+                       std::make_shared<RtfDocumentAdapter>()});
+}
+
+const FormatInfo& FormatRegistry::info(DocumentFormat format) const {
+    for (const FormatInfo& entry : formats) {
+        if (entry.format == format) return entry;
+    }
+    return formats.front();
+}
+
+const FormatInfo& FormatRegistry::forExtension(const QString& filePath) const {
+    QString extension = QFileInfo(filePath).suffix().toLower();
+    if (extension == "htm") extension = "html";
+    for (const FormatInfo& entry : formats) {
+        if (entry.extension == extension) return entry;
+    }
+    return info(DocumentFormat::PlainText);
+}
+
+const FormatInfo* FormatRegistry::sniff(const uchar* data, qint64 size) const {
+    PrefixReader prefix(data, size);
+    prefix.skipSpaces();
+
+    if (prefix.startsWith("{\\rtf")) {
+        return &info(DocumentFormat::Rtf);
+    }
+    if (prefix.startsWith("<?xml")) {
+        // XHTML начинается с объявления XML
+        bool xhtml = prefix.contains("<!doctype html") || prefix.contains("<html");
+        return &info(xhtml ? DocumentFormat::Html : DocumentFormat::Xml);
+    }
+    if (prefix.startsWith("<!doctype html") || prefix.startsWith("<html")) {
+        return &info(DocumentFormat::Html);
+    }
+    return nullptr;
+}
+
+const FormatInfo& FormatRegistry::detect(const QString& filePath) const {
+    QFile file(filePath);
+    if (file.open(QIODevice::ReadOnly)) {
+        qint64 length = qMin<qint64>(file.size(), sniffLength);
+        const FormatInfo* sniffed = nullptr;
+        if (uchar* mapped = length > 0 ? file.map(0, length) : nullptr) {
+            sniffed = sniff(mapped, length);
+            file.unmap(mapped);
+        } else if (length > 0) {
+            // Устройства без поддержки отображения читаются в небольшой буфер
+            QByteArray head = file.read(length);
+            sniffed = sniff(reinterpret_cast<const uchar*>(head.constData()), head.size());
+        }
+        if (sniffed) return *sniffed;
+    }
+    return forExtension(filePath);
+}
@@ -0,0 +1,39 @@
+#include "HibernatedTab.hpp"
+#include <stdexcept>
+
+HibernatedTab::HibernatedTab()
+    : cursorPosition(0), scrollPosition(0), keepsText(false), length(0) {}
+
+HibernatedTab HibernatedTab::fromFile(const QString& filePath) {
+    if (filePath.isEmpty()) {
+        throw std::invalid_argument("A tab without a file must keep its text");
+    }
+    HibernatedTab tab;
+    tab.path = filePath;
+    return tab;
+}
+
+HibernatedTab HibernatedTab::fromText(const QString& text, const QVector<TextFormatRun>& runs) {
+    HibernatedTab tab;
+    tab.keepsText = true;
+    // Обычный текст сжимается в несколько раз; быстрый уровень сжатия
+    // не задерживает переключение вкладок
+    tab.compressed = qCompress(text.toUtf8(), 1);
+    tab.formatRuns = runs;
+    tab.length = text.size();
+    return tab;
+}
+
+QString HibernatedTab::text() const {
+    if (!keepsText) return QString();
+    QByteArray utf8 = qUncompress(compressed);
+    if (utf8.isEmpty() && length > 0) {
+        throw std::runtime_error("Hibernated tab content is corrupted");
+    }
+    return QString::fromUtf8(utf8);
+}
+
+qint64 HibernatedTab::memoryUsage() const {
+    return sizeof(*this) + qint64(path.capacity()) * sizeof(QChar) + compressed.capacity() +
+           qint64(formatRuns.capacity()) * sizeof(TextFormatRun);
+}
@@ -0,0 +1,585 @@
+#include "HtmlTokenizer.hpp"
+#include <QColor>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+struct Entity {
+    const char* name;
+    uint codePoint;
+};
+
+// HTML 4 character entity set, sorted by name
+const Entity entities[] = {
+    {"AElig", 0x00C6}, {"Aacute", 0x00C1}, {"Acirc", 0x00C2}, {"Agrave", 0x00C0},
+    {"Alpha", 0x0391}, {"Aring", 0x00C5}, {"Atilde", 0x00C3}, {"Auml", 0x00C4}, {"Beta", 0x0392},
+    {"Ccedil", 0x00C7}, {"Chi", 0x03A7}, {"Dagger", 0x2021}, {"Delta", 0x0394}, {"ETH", 0x00D0},
+    {"Eacute", 0x00C9}, {"Ecirc", 0x00CA}, {"Egrave", 0x00C8}, {"Epsilon", 0x0395},
+    {"Eta", 0x0397}, {"Euml", 0x00CB}, {"Gamma", 0x0393}, {"Iacute", 0x00CD}, {"Icirc", 0x00CE},
+    {"Igrave", 0x00CC}, {"Iota", 0x0399}, {"Iuml", 0x00CF}, {"Kappa", 0x039A}, {"Lambda", 0x039B},
+    {"Mu", 0x039C}, {"Ntilde", 0x00D1}, {"Nu", 0x039D}, {"OElig", 0x0152}, {"Oacute", 0x00D3},
+    {"Ocirc", 0x00D4}, {"Ograve", 0x00D2}, {"Omega", 0x03A9}, {"Omicron", 0x039F},
+    {"Oslash", 0x00D8}, {"Otilde", 0x00D5}, {"Ouml", 0x00D6}, {"Phi", 0x03A6}, {"Pi", 0x03A0},
+    {"Prime", 0x2033}, {"Psi", 0x03A8}, {"Rho", 0x03A1}, {"Scaron", 0x0160}, {"Sigma", 0x03A3},
+    {"THORN", 0x00DE}, {"Tau", 0x03A4}, {"Theta", 0x0398}, {"Uacute", 0x00DA}, {"Ucirc", 0x00DB},
+    {"Ugrave", 0x00D9}, {"Upsilon", 0x03A5}, {"Uuml", 0x00DC}, {"Xi", 0x039E}, {"Yacute", 0x00DD},
+    {"Yuml", 0x0178}, {"Zeta", 0x0396}, {"aacute", 0x00E1}, {"acirc", 0x00E2}, {"acute", 0x00B4},
+    {"aelig", 0x00E6}, {"agrave", 0x00E0}, {"alefsym", 0x2135}, {"alpha", 0x03B1}, {"amp", 0x0026},
+    {"and", 0x2227}, {"ang", 0x2220}, {"apos", 0x0027}, {"aring", 0x00E5}, {"asymp", 0x2248},
+    {"atilde", 0x00E3}, {"auml", 0x00E4}, {"bdquo", 0x201E}, {"beta", 0x03B2}, {"brvbar", 0x00A6},
+    {"bull", 0x2022}, {"cap", 0x2229}, {"ccedil", 0x00E7}, {"cedil", 0x00B8}, {"cent", 0x00A2},
+    {"chi", 0x03C7}, {"circ", 0x02C6}, {"clubs", 0x2663}, {"cong", 0x2245}, {"copy", 0x00A9},
+    {"crarr", 0x21B5}, {"cup", 0x222A}, {"curren", 0x00A4}, {"dArr", 0x21D3}, {"dagger", 0x2020},
+    {"darr", 0x2193}, {"deg", 0x00B0}, {"delta", 0x03B4}, {"diams", 0x2666}, {"divide", 0x00F7},
+    {"eacute", 0x00E9}, {"ecirc", 0x00EA}, {"egrave", 0x00E8}, {"empty", 0x2205}, {"emsp", 0x2003},
+    {"ensp", 0x2002}, {"epsilon", 0x03B5}, {"equiv", 0x2261}, {"eta", 0x03B7}, {"eth", 0x00F0},
+    {"euml", 0x00EB}, {"euro", 0x20AC}, {"exist", 0x2203}, {"fnof", 0x0192}, {"forall", 0x2200},
+    {"frac12", 0x00BD}, {"frac14", 0x00BC}, {"frac34", 0x00BE}, {"frasl", 0x2044},
+    {"gamma", 0x03B3}, {"ge", 0x2265}, {"gt", 0x003E}, {"hArr", 0x21D4}, {"harr", 0x2194},
+    {"hearts", 0x2665}, {"hellip", 0x2026}, {"iacute", 0x00ED}, {"icirc", 0x00EE},
+    {"iexcl", 0x00A1}, {"igrave", 0x00EC}, {"image", 0x2111}, {"infin", 0x221E}, {"int", 0x222B},
+    {"iota", 0x03B9}, {"iquest", 0x00BF}, {"isin", 0x2208}, {"iuml", 0x00EF}, {"kappa", 0x03BA},
+    {"lArr", 0x21D0}, {"lambda", 0x03BB}, {"lang", 0x2329}, {"laquo", 0x00AB}, {"larr", 0x2190},
+    {"lceil", 0x2308}, {"ldquo", 0x201C}, {"le", 0x2264}, {"lfloor", 0x230A}, {"lowast", 0x2217},
+    {"loz", 0x25CA}, {"lrm", 0x200E}, {"lsaquo", 0x2039}, {"lsquo", 0x2018}, {"lt", 0x003C},
+    {"macr", 0x00AF}, {"mdash", 0x2014}, {"micro", 0x00B5}, {"middot", 0x00B7}, {"minus", 0x2212},
+    {"mu", 0x03BC}, {"nabla", 0x2207}, {"nbsp", 0x00A0}, {"ndash", 0x2013}, {"ne", 0x2260},
+    {"ni", 0x220B}, {"not", 0x00AC}, {"notin", 0x2209}, {"nsub", 0x2284}, {"ntilde", 0x00F1},
+    {"nu", 0x03BD}, {"oacute", 0x00F3}, {"ocirc", 0x00F4}, {"oelig", 0x0153}, {"ograve", 0x00F2},
+    {"oline", 0x203E}, {"omega", 0x03C9}, {"omicron", 0x03BF}, {"oplus", 0x2295}, {"or", 0x2228},
+    {"ordf", 0x00AA}, {"ordm", 0x00BA}, {"oslash", 0x00F8}, {"otilde", 0x00F5}, {"otimes", 0x2297},
+    {"ouml", 0x00F6}, {"para", 0x00B6}, {"part", 0x2202}, {"permil", 0x2030}, {"perp", 0x22A5},
+    {"phi", 0x03C6}, {"pi", 0x03C0}, {"piv", 0x03D6}, {"plusmn", 0x00B1}, {"pound", 0x00A3},
+    {"prime", 0x2032}, {"prod", 0x220F}, {"prop", 0x221D}, {"psi", 0x03C8}, {"quot", 0x0022},
+    {"rArr", 0x21D2}, {"radic", 0x221A}, {"rang", 0x232A}, {"raquo", 0x00BB}, {"rarr", 0x2192},
+    {"rceil", 0x2309}, {"rdquo", 0x201D}, {"real", 0x211C}, {"reg", 0x00AE}, {"rfloor", 0x230B},
+    {"rho", 0x03C1}, {"rlm", 0x200F}, {"rsaquo", 0x203A}, {"rsquo", 0x2019}, {"sbquo", 0x201A},
+    {"scaron", 0x0161}, {"sdot", 0x22C5}, {"sect", 0x00A7}, {"shy", 0x00AD}, {"sigma", 0x03C3},
+    {"sigmaf", 0x03C2}, {"sim", 0x223C}, {"spades", 0x2660}, {"sub", 0x2282}, {"sube", 0x2286},
+    {"sum", 0x2211}, {"sup", 0x2283}, {"sup1", 0x00B9}, {"sup2", 0x00B2}, {"sup3", 0x00B3},
+    {"supe", 0x2287}, {"szlig", 0x00DF}, {"tau", 0x03C4}, {"there4", 0x2234}, {"theta", 0x03B8},
+    {"thetasym", 0x03D1}, {"thinsp", 0x2009}, {"thorn", 0x00FE}, {"tilde", 0x02DC},
+    {"times", 0x00D7}, {"trade", 0x2122}, {"uArr", 0x21D1}, {"uacute", 0x00FA}, {"uarr", 0x2191},
+    {"ucirc", 0x00FB}, {"ugrave", 0x00F9}, {"uml", 0x00A8}, {"upsih", 0x03D2}, {"upsilon", 0x03C5},
+    {"uuml", 0x00FC}, {"weierp", 0x2118}, {"xi", 0x03BE}, {"yacute", 0x00FD}, {"yen", 0x00A5},
+    {"yuml", 0x00FF}, {"zeta", 0x03B6}, {"zwj", 0x200D}, {"zwnj", 0x200C}
+};
+
+// Sorted, used with binary search
+const char* const blockElements[] = {
+    "address", "article", "aside", "blockquote", "body", "caption", "center", "dd",
+    "details", "dialog", "div", "dl", "dt", "fieldset", "figcaption", "figure", "footer",
+    "form", "h1", "h2", "h3", "h4", "h5", "h6", "head", "header", "hr", "html", "li",
+    "main", "nav", "ol", "p", "pre", "section", "summary", "table", "tbody", "tfoot",
+    "thead", "title", "tr", "ul"
+};
+
+const int maxNameLength = 15;
+const int maxEntityLength = 32;
+
+inline bool isAsciiSpace(ushort c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+inline bool isAsciiAlpha(ushort c) {
+    return (c | 0x20) >= 'a' && (c | 0x20) <= 'z';
+}
+
+inline bool isNameChar(ushort c) {
+    return isAsciiAlpha(c) || (c >= '0' && c <= '9') || c == '-' || c == ':';
+}
+
+inline ushort toAsciiLower(ushort c) {
+    return (c >= 'A' && c <= 'Z') ? c | 0x20 : c;
+}
+
+bool matchesAscii(const QChar* data, int length, int pos, const char* pattern, bool caseInsensitive) {
+    for (int k = 0; pattern[k]; ++k, ++pos) {
+        if (pos >= length) return false;
+        ushort c = data[pos].unicode();
+        if (caseInsensitive) c = toAsciiLower(c);
+        if (c != static_cast<uchar>(pattern[k])) return false;
+    }
+    return true;
+}
+
+// Position of the first occurrence of an ASCII pattern at or after from, -1 if none
+int findAscii(const QChar* data, int length, int from, const char* pattern, bool caseInsensitive) {
+    ushort first = static_cast<uchar>(pattern[0]);
+    for (int pos = from; pos < length; ++pos) {
+        ushort c = data[pos].unicode();
+        if (caseInsensitive) c = toAsciiLower(c);
+        if (c == first && matchesAscii(data, length, pos, pattern, caseInsensitive)) {
+            return pos;
+        }
+    }
+    return -1;
+}
+
+// Position just after the closing '>' of a tag; quoted attribute values may contain '>'
+int skipTag(const QChar* data, int length, int from) {
+    ushort quote = 0;
+    for (int pos = from; pos < length; ++pos) {
+        ushort c = data[pos].unicode();
+        if (quote) {
+            if (c == quote) quote = 0;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '>') {
+            return pos + 1;
+        }
+    }
+    return length;
+}
+
+// Writes into the preallocated tail of the output string; with runs set it
+// also records where the character style changes
+class PlainTextWriter {
+public:
+    PlainTextWriter(QString& out, int capacity, QVector<TextFormatRun>* runs = nullptr)
+        : out(out), pendingSpace(false), runs(runs) {
+        int start = out.size();
+        out.resize(start + capacity);
+        begin = out.data() + start;
+        cursor = begin;
+    }
+
+    void text(QChar ch) {
+        if (pendingSpace) {
+            if (cursor != begin && cursor[-1] != QLatin1Char('\n')) {
+                *cursor++ = QLatin1Char(' ');
+            }
+            pendingSpace = false;
+        }
+        if (runs && style != recordedStyle) {
+            // Смена стиля фиксируется лениво, при первом символе после нее
+            RichTextBuilder::addRun(*runs, static_cast<int>(cursor - begin), style);
+            recordedStyle = style;
+        }
+        *cursor++ = ch;
+    }
+
+    void setStyle(const TextStyle& current) {
+        style = current;
+    }
+
+    void space() {
+        pendingSpace = true;
+    }
+
+    void blockBreak() {
+        pendingSpace = false;
+        if (cursor != begin && cursor[-1] != QLatin1Char('\n')) {
+            *cursor++ = QLatin1Char('\n');
+        }
+    }
+
+    void lineBreak() {
+        pendingSpace = false;
+        *cursor++ = QLatin1Char('\n');
+    }
+
+    void finish() {
+        out.resize(static_cast<int>(cursor - out.constData()));
+    }
+
+private:
+    QString& out;
+    QChar* begin;
+    QChar* cursor;
+    bool pendingSpace;
+    QVector<TextFormatRun>* runs;
+    TextStyle style;
+    TextStyle recordedStyle;
+};
+
+int parseEntity(const QChar* data, int length, int pos, PlainTextWriter& writer) {
+    int end = pos + 1;
+    int limit = qMin(length, pos + maxEntityLength);
+    while (end < limit && data[end] != QLatin1Char(';') && data[end] != QLatin1Char('&') &&
+           data[end] != QLatin1Char('<') && !isAsciiSpace(data[end].unicode())) {
+        ++end;
+    }
+
+    uint codePoint = 0;
+    if (end < limit && data[end] == QLatin1Char(';')) {
+        codePoint = HtmlTokenizer::decodeEntity(data + pos + 1, end - pos - 1);
+    }
+    if (!codePoint) {
+        writer.text(QLatin1Char('&'));
+        return pos + 1;
+    }
+
+    if (codePoint == 0xA0) {
+        writer.text(QLatin1Char(' '));
+    } else if (QChar::requiresSurrogates(codePoint)) {
+        writer.text(QChar(QChar::highSurrogate(codePoint)));
+        writer.text(QChar(QChar::lowSurrogate(codePoint)));
+    } else {
+        writer.text(QChar(static_cast<ushort>(codePoint)));
+    }
+    return end + 1;
+}
+
+struct Markup {
+    enum Kind { NotMarkup, Skipped, Tag };
+    Kind kind;
+    int end;
+    bool closing;
+    // Attributes of a tag lie between attributesStart and attributesEnd
+    int attributesStart;
+    int attributesEnd;
+    char name[maxNameLength + 1];
+};
+
+// Finds where the markup starting with '<' at pos ends; shared by the
+// converter and the split point scan so both see the same structure
+Markup scanMarkup(const QChar* data, int length, int pos) {
+    Markup markup;
+    markup.kind = Markup::Skipped;
+    markup.closing = false;
+    markup.attributesStart = markup.attributesEnd = pos;
+    markup.name[0] = '\0';
+
+    int next = pos + 1;
+    ushort c = next < length ? data[next].unicode() : 0;
+
+    if (c == '!') {
+        if (matchesAscii(data, length, pos, "<!--", false)) {
+            int end = findAscii(data, length, pos + 4, "-->", false);
+            markup.end = end < 0 ? length : end + 3;
+        } else {
+            markup.end = skipTag(data, length, next);
+        }
+        return markup;
+    }
+    if (c == '?') {
+        markup.end = skipTag(data, length, next);
+        return markup;
+    }
+
+    bool closing = c == '/';
+    int nameStart = closing ? next + 1 : next;
+    if (nameStart >= length || !isAsciiAlpha(data[nameStart].unicode())) {
+        // Не тег: '<' остается обычным символом
+        markup.kind = Markup::NotMarkup;
+        markup.end = next;
+        return markup;
+    }
+
+    int nameLength = 0;
+    int end = nameStart;
+    while (end < length && isNameChar(data[end].unicode())) {
+        if (nameLength < maxNameLength) {
+            markup.name[nameLength] = static_cast<char>(toAsciiLower(data[end].unicode()));
+        }
+        ++nameLength;
+        ++end;
+    }
+    markup.name[nameLength <= maxNameLength ? nameLength : 0] = '\0';
+    markup.closing = closing;
+    markup.attributesStart = end;
+    end = skipTag(data, length, end);
+    markup.attributesEnd = end - 1;
+
+    if (!closing && (std::strcmp(markup.name, "script") == 0 || std::strcmp(markup.name, "style") == 0)) {
+        // Содержимое script/style пропускается до закрывающего тега
+        const char* closeTag = markup.name[1] == 'c' ? "</script" : "</style";
+        int close = findAscii(data, length, end, closeTag, true);
+        markup.end = close < 0 ? length : skipTag(data, length, close + static_cast<int>(std::strlen(closeTag)));
+        return markup;
+    }
+
+    markup.kind = Markup::Tag;
+    markup.end = end;
+    return markup;
+}
+
+// Case-insensitive comparison of an attribute or property name with a lower-case pattern
+bool equalsAscii(const QChar* data, int length, const char* pattern) {
+    return static_cast<int>(std::strlen(pattern)) == length && matchesAscii(data, length, 0, pattern, true);
+}
+
+// Named or #rrggbb color; an unknown value gives an invalid color, i.e. the default one
+QColor parseColor(const QChar* data, int length) {
+    return QColor(QString(data, length).trimmed());
+}
+
+// Applies a CSS declaration list such as "color: red; font-weight: bold"
+void applyStyleAttribute(const QChar* data, int length, TextStyle& style) {
+    int pos = 0;
+    while (pos < length) {
+        int end = pos;
+        while (end < length && data[end] != QLatin1Char(';')) ++end;
+        int colon = pos;
+        while (colon < end && data[colon] != QLatin1Char(':')) ++colon;
+        if (colon < end) {
+            QString property = QString(data + pos, colon - pos).trimmed().toLower();
+            QString value = QString(data + colon + 1, end - colon - 1).trimmed().toLower();
+            if (property == QLatin1String("color")) {
+                style.color = parseColor(value.constData(), value.size());
+            } else if (property == QLatin1String("font-weight")) {
+                bool numeric = false;
+                int weight = value.toInt(&numeric);
+                style.bold = numeric ? weight >= 600
+                                     : value == QLatin1String("bold") || value == QLatin1String("bolder");
+            } else if (property == QLatin1String("font-style")) {
+                style.italic = value == QLatin1String("italic") || value == QLatin1String("oblique");
+            }
+        }
+        pos = end + 1;
+    }
+}
+
+// Stack of open inline formatting elements
+class StyleStack {
+public:
+    StyleStack() {
+        entries.push_back(Entry());
+    }
+
+    const TextStyle& current() const {
+        return entries.back().style;
+    }
+
+    void apply(const QChar* data, const Markup& markup) {
+        if (!isFormattingElement(markup.name)) {
+            return;
+        }
+        if (markup.closing) {
+            // Закрывающий тег снимает свой элемент и все незакрытые выше него
+            for (size_t i = entries.size() - 1; i > 0; --i) {
+                if (std::strcmp(entries[i].name, markup.name) == 0) {
+                    entries.resize(i);
+                    break;
+                }
+            }
+            return;
+        }
+
+        Entry entry;
+        std::strcpy(entry.name, markup.name);
+        entry.style = current();
+        if (std::strcmp(markup.name, "b") == 0 || std::strcmp(markup.name, "strong") == 0) {
+            entry.style.bold = true;
+        } else if (std::strcmp(markup.name, "i") == 0 || std::strcmp(markup.name, "em") == 0) {
+            entry.style.italic = true;
+        }
+        applyAttributes(data, markup, entry.style);
+        entries.push_back(entry);
+    }
+
+private:
+    struct Entry {
+        char name[maxNameLength + 1] = "";
+        TextStyle style;
+    };
+
+    static bool isFormattingElement(const char* name) {
+        static const char* const elements[] = {"b", "em", "font", "i", "span", "strong"};
+        return std::binary_search(std::begin(elements), std::end(elements), name,
+                                  [](const char* a, const char* b) { return std::strcmp(a, b) < 0; });
+    }
+
+    static void applyAttributes(const QChar* data, const Markup& markup, TextStyle& style) {
+        int pos = markup.attributesStart;
+        const int end = markup.attributesEnd;
+        while (pos < end) {
+            while (pos < end && (isAsciiSpace(data[pos].unicode()) || data[pos] == QLatin1Char('/'))) ++pos;
+            int nameStart = pos;
+            while (pos < end && isNameChar(data[pos].unicode())) ++pos;
+            int nameLength = pos - nameStart;
+            if (nameLength == 0) {
+                ++pos;
+                continue;
+            }
+            while (pos < end && isAsciiSpace(data[pos].unicode())) ++pos;
+            if (pos >= end || data[pos] != QLatin1Char('=')) {
+                continue;
+            }
+            ++pos;
+            while (pos < end && isAsciiSpace(data[pos].unicode())) ++pos;
+
+            int valueStart = pos;
+            int valueEnd;
+            if (pos < end && (data[pos] == QLatin1Char('"') || data[pos] == QLatin1Char('\''))) {
+                QChar quote = data[pos];
+                valueStart = ++pos;
+                while (pos < end && data[pos] != quote) ++pos;
+                valueEnd = pos++;
+            } else {
+                while (pos < end && !isAsciiSpace(data[pos].unicode())) ++pos;
+                valueEnd = pos;
+            }
+
+            if (equalsAscii(data + nameStart, nameLength, "style")) {
+                applyStyleAttribute(data + valueStart, valueEnd - valueStart, style);
+            } else if (equalsAscii(data + nameStart, nameLength, "color") &&
+                       std::strcmp(markup.name, "font") == 0) {
+                style.color = parseColor(data + valueStart, valueEnd - valueStart);
+            }
+        }
+    }
+
+    std::vector<Entry> entries;
+};
+
+int parseMarkup(const QChar* data, int length, int pos, PlainTextWriter& writer, StyleStack* styles) {
+    Markup markup = scanMarkup(data, length, pos);
+    if (markup.kind == Markup::NotMarkup) {
+        writer.text(QLatin1Char('<'));
+    } else if (markup.kind == Markup::Tag) {
+        if (std::strcmp(markup.name, "br") == 0) {
+            writer.lineBreak();
+        } else if (HtmlTokenizer::isBlockElement(markup.name)) {
+            writer.blockBreak();
+        } else if (styles) {
+            styles->apply(data, markup);
+            writer.setStyle(styles->current());
+        }
+    }
+    return markup.end;
+}
+
+void convert(const QChar* data, int length, QString& out, QVector<TextFormatRun>* runs) {
+    PlainTextWriter writer(out, length, runs);
+    StyleStack styles;
+    StyleStack* tracked = runs ? &styles : nullptr;
+    int pos = 0;
+    while (pos < length) {
+        ushort c = data[pos].unicode();
+        if (c == '<') {
+            pos = parseMarkup(data, length, pos, writer, tracked);
+        } else if (c == '&') {
+            pos = parseEntity(data, length, pos, writer);
+        } else if (isAsciiSpace(c)) {
+            writer.space();
+            ++pos;
+        } else {
+            writer.text(data[pos]);
+            ++pos;
+        }
+    }
+    writer.finish();
+}
+
+} // namespace
+
+QString HtmlTokenizer::toPlainText(const QString& html) {
+    QString text;
+    appendPlainText(html.constData(), html.size(), text);
+    trimLineBreaks(text);
+    return text;
+}
+
+QString HtmlTokenizer::toRichText(const QString& html, QVector<TextFormatRun>& runs) {
+    QString text;
+    runs.clear();
+    convert(html.constData(), html.size(), text, &runs);
+    int removed = trimLineBreaks(text);
+    RichTextBuilder::trimRuns(runs, removed, text.size());
+    return text;
+}
+
+int HtmlTokenizer::trimLineBreaks(QString& text) {
+    int start = 0;
+    while (start < text.size() && text.at(start) == QLatin1Char('\n')) {
+        ++start;
+    }
+    int end = text.size();
+    while (end > start && text.at(end - 1) == QLatin1Char('\n')) {
+        --end;
+    }
+    text.truncate(end);
+    text.remove(0, start);
+    return start;
+}
+
+void HtmlTokenizer::appendPlainText(const QChar* data, int length, QString& out) {
+    convert(data, length, out, nullptr);
+}
+
+QVector<int> HtmlTokenizer::findSplitPoints(const QChar* data, int length, int chunkSize) {
+    QVector<int> points;
+    int target = chunkSize;
+    int pos = 0;
+    while (pos < length && target < length) {
+        if (data[pos] != QLatin1Char('<')) {
+            ++pos;
+            continue;
+        }
+        Markup markup = scanMarkup(data, length, pos);
+        if (pos >= target && markup.kind == Markup::Tag && isBlockElement(markup.name)) {
+            points.append(pos);
+            target = pos + chunkSize;
+        }
+        pos = markup.end;
+    }
+    return points;
+}
+
+void HtmlTokenizer::joinChunk(QString& out, const QString& chunk) {
+    // Блочный тег в начале фрагмента завершает строку предыдущего текста
+    if (!out.isEmpty() && out.at(out.size() - 1) != QLatin1Char('\n')) {
+        out.append(QLatin1Char('\n'));
+    }
+    out.append(chunk);
+}
+
+bool HtmlTokenizer::isBlockElement(const char* name) {
+    return std::binary_search(std::begin(blockElements), std::end(blockElements), name,
+                              [](const char* a, const char* b) { return std::strcmp(a, b) < 0; });
+}
+
+uint HtmlTokenizer::decodeEntity(const QChar* name, int length) {
+    if (length <= 0) {
+        return 0;
+    }
+
+    if (name[0] == QLatin1Char('#')) {
+        bool hex = length > 1 && (name[1] == QLatin1Char('x') || name[1] == QLatin1Char('X'));
+        int pos = hex ? 2 : 1;
+        if (pos >= length) return 0;
+
+        uint value = 0;
+        for (; pos < length; ++pos) {
+            ushort c = name[pos].unicode();
+            uint digit;
+            if (c >= '0' && c <= '9') {
+                digit = c - '0';
+            } else if (hex && (c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+                digit = (c | 0x20) - 'a' + 10;
+            } else {
+                return 0;
+            }
+            value = value * (hex ? 16 : 10) + digit;
+            if (value > 0x10FFFF) {
+                return QChar::ReplacementCharacter;
+            }
+        }
+        // Недопустимые кодовые точки заменяются, как это делают браузеры
+        if (value == 0 || QChar::isSurrogate(value)) {
+            return QChar::ReplacementCharacter;
+        }
+        return value;
+    }
+
+    char key[maxNameLength + 1];
+    if (length > maxNameLength) return 0;
+    for (int i = 0; i < length; ++i) {
+        ushort c = name[i].unicode();
+        if (!isNameChar(c)) return 0;
+        key[i] = static_cast<char>(c);
+    }
+    key[length] = '\0';
+
+    auto it = std::lower_bound(std::begin(entities), std::end(entities), key,
+                               [](const Entity& entity, const char* k) { return std::strcmp(entity.name, k) < 0; });
+    if (it != std::end(entities) && std::strcmp(it->name, key) == 0) {
+        return it->codePoint;
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include "LineBuffer.hpp"
+#include <cstring>
+#include <stdexcept>
+
+LineBuffer::LineBuffer(const QString& filePath)
+    : path(filePath), data(nullptr), length(0), lines(1) {
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error(QString("Cannot open file for reading: %1").arg(filePath).toStdString());
+    }
+    length = file.size();
+    if (length > 0) {
+        data = reinterpret_cast<const char*>(file.map(0, length));
+        if (!data) {
+            throw std::runtime_error(QString("Cannot map file: %1").arg(filePath).toStdString());
+        }
+    }
+    buildIndex();
+}
+
+LineBuffer::LineBuffer(const QByteArray& utf8)
+    : owned(utf8), data(owned.constData()), length(owned.size()), lines(1) {
+    buildIndex();
+}
+
+LineBuffer::~LineBuffer() {
+    if (file.isOpen() && data) {
+        file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(data)));
+    }
+}
+
+bool LineBuffer::canRead(const QString& filePath) {
+    QFile probe(filePath);
+    if (!probe.open(QIODevice::ReadOnly)) return false;
+    // Метка порядка байтов UTF-16 в любом порядке
+    QByteArray head = probe.read(2);
+    return !(head == QByteArray("\xFF\xFE", 2) || head == QByteArray("\xFE\xFF", 2));
+}
+
+void LineBuffer::buildIndex() {
+    checkpoints.clear();
+    checkpoints.reserve(static_cast<size_t>(length / (checkpointInterval * 40) + 1));
+    checkpoints.push_back(0);
+    lines = 1;
+    // memchr проходит по отображенному файлу быстрее побайтового цикла
+    const char* position = data;
+    const char* end = data + length;
+    while (position < end) {
+        const void* found = std::memchr(position, '\n', static_cast<size_t>(end - position));
+        if (!found) break;
+        position = static_cast<const char*>(found) + 1;
+        if (lines % checkpointInterval == 0) {
+            checkpoints.push_back(position - data);
+        }
+        ++lines;
+    }
+}
+
+qint64 LineBuffer::lineEnd(qint64 start) const {
+    if (start >= length) return length;
+    const void* found = std::memchr(data + start, '\n', static_cast<size_t>(length - start));
+    return found ? static_cast<const char*>(found) - data : length;
+}
+
+qint64 LineBuffer::lineStart(qint64 index) const {
+    if (index < 0 || index >= lines) {
+        throw std::out_of_range("Line index out of range");
+    }
+    qint64 start = checkpoints[static_cast<size_t>(index / checkpointInterval)];
+    for (qint64 skip = index % checkpointInterval; skip > 0; --skip) {
+        start = lineEnd(start) + 1;
+    }
+    return start;
+}
+
+QString LineBuffer::line(qint64 index) const {
+    qint64 start = lineStart(index);
+    qint64 end = lineEnd(start);
+    if (end > start && data[end - 1] == '\r') --end;
+
+    // Символ UTF-8 занимает не меньше байта, поэтому отрезается по байтам,
+    // не разрывая последовательность
+    if (end - start > maxLineLength) {
+        end = start + maxLineLength;
+        while (end > start && (static_cast<uchar>(data[end]) & 0xC0) == 0x80) --end;
+    }
+    return QString::fromUtf8(data + start, static_cast<int>(end - start));
+}
+
+QString LineBuffer::text() const {
+    // QString хранит не больше 2^30 символов UTF-16
+    if (length > (1 << 30)) {
+        throw std::runtime_error("Text is too large to be loaded at once");
+    }
+    return QString::fromUtf8(data, static_cast<int>(length));
+}
+
+qint64 LineBuffer::memoryUsage() const {
+    return qint64(checkpoints.capacity() * sizeof(qint64)) + owned.capacity();
+}
@@ -1,5 +1,7 @@
 #include "MainWindow.hpp"
 #include "DocumentAdapter.hpp"
+#include "FormatRegistry.hpp"
+#include "DecoratedText.hpp"
 #include <QMenuBar>
 #include <QFileDialog>
 #include <QMessageBox>
@@ -10,6 +12,162 @@
 #include <QStatusBar>
 #include <QLabel>
 #include <QRegularExpression>
+#include <QScrollBar>
+#include <QSignalBlocker>
+#include <QTimer>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QPlainTextEdit>
+#include <QPointer>
+#include <QVBoxLayout>
+#include <QTextBlock>
+#include <QTextFragment>
+#include <algorithm>
+
+namespace {
+
+// Фрагмент документа в том же виде, что и в toPlainText()
+QString plainTextRange(QTextDocument* document, int position, int length) {
+    int end = qMin(position + length, document->characterCount() - 1);
+    if (end <= position) return QString();
+
+    QTextCursor cursor(document);
+    cursor.setPosition(position);
+    cursor.setPosition(end, QTextCursor::KeepAnchor);
+    QString text = cursor.selectedText();
+    for (QChar& ch : text) {
+        ushort code = ch.unicode();
+        if (code == QChar::ParagraphSeparator || code == 0xfdd0 || code == 0xfdd1) {
+            ch = QLatin1Char('\n');
+        } else if (code == QChar::Nbsp) {
+            ch = QLatin1Char(' ');
+        }
+    }
+    return text;
+}
+
+QTextDocument* editorDocument(QWidget* widget) {
+    if (auto* textEdit = qobject_cast<QTextEdit*>(widget)) return textEdit->document();
+    if (auto* plainTextEdit = qobject_cast<QPlainTextEdit*>(widget)) return plainTextEdit->document();
+    return nullptr;
+}
+
+void setEditorPlainText(QWidget* widget, const QString& text) {
+    if (auto* textEdit = qobject_cast<QTextEdit*>(widget)) {
+        textEdit->setPlainText(text);
+    } else if (auto* plainTextEdit = qobject_cast<QPlainTextEdit*>(widget)) {
+        plainTextEdit->setPlainText(text);
+    }
+}
+
+QTextCursor editorCursor(QWidget* widget) {
+    if (auto* textEdit = qobject_cast<QTextEdit*>(widget)) return textEdit->textCursor();
+    if (auto* plainTextEdit = qobject_cast<QPlainTextEdit*>(widget)) return plainTextEdit->textCursor();
+    return QTextCursor();
+}
+
+void setEditorCursor(QWidget* widget, const QTextCursor& cursor) {
+    if (auto* textEdit = qobject_cast<QTextEdit*>(widget)) {
+        textEdit->setTextCursor(cursor);
+    } else if (auto* plainTextEdit = qobject_cast<QPlainTextEdit*>(widget)) {
+        plainTextEdit->setTextCursor(cursor);
+    }
+}
+
+void setEditorReadOnly(QWidget* widget, bool readOnly) {
+    if (auto* textEdit = qobject_cast<QTextEdit*>(widget)) {
+        textEdit->setReadOnly(readOnly);
+    } else if (auto* plainTextEdit = qobject_cast<QPlainTextEdit*>(widget)) {
+        plainTextEdit->setReadOnly(readOnly);
+    }
+}
+
+// Грубая оценка памяти блока: сам блок, его компоновка и одна строка
+const qint64 blockOverhead = 256;
+
+// Позиция текста в точке области просмотра
+int positionAt(QWidget* widget, const QPoint& point) {
+    if (auto* textEdit = qobject_cast<QTextEdit*>(widget)) return textEdit->cursorForPosition(point).position();
+    if (auto* plainTextEdit = qobject_cast<QPlainTextEdit*>(widget)) return plainTextEdit->cursorForPosition(point).position();
+    return 0;
+}
+
+void setExtraSelections(QWidget* widget, const QList<QTextEdit::ExtraSelection>& selections) {
+    if (auto* textEdit = qobject_cast<QTextEdit*>(widget)) {
+        textEdit->setExtraSelections(selections);
+    } else if (auto* plainTextEdit = qobject_cast<QPlainTextEdit*>(widget)) {
+        plainTextEdit->setExtraSelections(selections);
+    }
+}
+
+// Формат символов участка документа, снятый до правки
+struct FormatSpan {
+    int start;
+    int end;
+    QTextCharFormat format;
+};
+
+QVector<FormatSpan> formatSpans(QTextDocument* document, int start, int end) {
+    QVector<FormatSpan> spans;
+    for (QTextBlock block = document->findBlock(start); block.isValid() && block.position() < end;
+         block = block.next()) {
+        for (QTextBlock::iterator it = block.begin(); !it.atEnd(); ++it) {
+            QTextFragment fragment = it.fragment();
+            int from = qMax(fragment.position(), start);
+            int to = qMin(fragment.position() + fragment.length(), end);
+            if (from < to) spans.append({from, to, fragment.charFormat()});
+        }
+    }
+    return spans;
+}
+
+// Возвращает форматы участка, в котором заменены все совпадения: текст между
+// ними сдвигается на накопленную разницу длин, а замена получает формат
+// первого символа совпадения
+void restoreFormats(QTextCursor& cursor, const QVector<FormatSpan>& spans, const QVector<Replacement>& replaced) {
+    if (spans.isEmpty()) return;
+    int span = 0;
+    int delta = 0;
+    auto setFormat = [&cursor](int start, int end, const QTextCharFormat& format) {
+        cursor.setPosition(start);
+        cursor.setPosition(end, QTextCursor::KeepAnchor);
+        cursor.setCharFormat(format);
+    };
+    // Участок [from, to) в старых позициях, не затронутый заменой
+    auto formatGap = [&](int from, int to) {
+        for (; span < spans.size() && spans[span].start < to; ++span) {
+            int start = qMax(from, spans[span].start);
+            int end = qMin(to, spans[span].end);
+            if (start < end) setFormat(start + delta, end + delta, spans[span].format);
+            if (spans[span].end > to) break;
+        }
+    };
+
+    int copied = spans.first().start;
+    for (const Replacement& range : replaced) {
+        int matchStart = range.start - delta;
+        formatGap(copied, matchStart);
+        if (range.length > 0) {
+            setFormat(range.start, range.start + range.length, spans[qMin(span, spans.size() - 1)].format);
+        }
+        copied = matchStart + range.originalLength;
+        delta += range.length - range.originalLength;
+    }
+}
+
+class StateCallback : public IStateObserver {
+public:
+    explicit StateCallback(std::function<void()> callback) : callback(std::move(callback)) {}
+    void onStateChanged(const QString&) override { callback(); }
+
+private:
+    std::function<void()> callback;
+};
+
+} // namespace
 
 MainWindow* MainWindow::instance = nullptr;
 std::mutex MainWindow::mutex;
@@ -22,18 +180,37 @@ MainWindow* MainWindow::getInstance() {
     return instance;
 }
 
-MainWindow::MainWindow() : currentIndex(-1) {
+MainWindow::MainWindow()
+    : currentIndex(-1), hibernationDelay(600), autoSaveTimer(nullptr), frameTimer(nullptr), suppressJournal(false),
+      findBar(nullptr), searchGeneration(0), searchRunning(false), currentMatch(-1), searchedWidget(nullptr),
+      searchTimer(nullptr), fileSearchDock(nullptr), fileSearchPanel(nullptr), fileSearchGeneration(0) {
     initializeUI();
     initializeConnections();
     setupMenus();
     initializeComponents();
+    recoverJournals();
+    restoreSession();
 }
 
 void MainWindow::initializeUI() {
     resize(1200, 900);
-    tabs = new QTabWidget(this);
+    QWidget* central = new QWidget(this);
+    QVBoxLayout* layout = new QVBoxLayout(central);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(0);
+    tabs = new QTabWidget(central);
     tabs->setTabsClosable(true);
-    setCentralWidget(tabs);
+    layout->addWidget(tabs);
+    findBar = new FindBar(central);
+    findBar->hide();
+    layout->addWidget(findBar);
+    setCentralWidget(central);
+    fileSearchPanel = new FileSearchPanel(this);
+    fileSearchDock = new QDockWidget(tr("Find in Files"), this);
+    fileSearchDock->setObjectName("fileSearchDock");
+    fileSearchDock->setWidget(fileSearchPanel);
+    addDockWidget(Qt::BottomDockWidgetArea, fileSearchDock);
+    fileSearchDock->hide();
     setupToolBar();
     setupStatusBar();
 }
@@ -97,9 +274,13 @@ void MainWindow::setupStatusBar() {
     updateDocumentState();
 }
 
+EditorContext* MainWindow::currentContext() const {
+    return currentIndex >= 0 && currentIndex < contexts.size() ? contexts[currentIndex].get() : nullptr;
+}
+
 void MainWindow::updateDocumentState() {
-    if (editorContext) {
-        QString state = editorContext->getStatus();
+    if (EditorContext* context = currentContext()) {
+        QString state = context->getStatus();
         stateLabel->setText(state);
         
         // Изменяем цвет текста в зависимости от состояния
@@ -124,6 +305,7 @@ void MainWindow::initializeConnections() {
 
 void MainWindow::setupMenus() {
     createFileMenu();
+    createEditMenu();
 }
 
 void MainWindow::createFileMenu() {
@@ -133,15 +315,94 @@ void MainWindow::createFileMenu() {
     saveAction = fileMenu->addAction(tr("Save"), this, &MainWindow::saveFile, QKeySequence::Save);
 }
 
+void MainWindow::createEditMenu() {
+    QMenu* editMenu = menuBar()->addMenu(tr("Edit"));
+    editMenu->addAction(tr("Find"), this, &MainWindow::showFind, QKeySequence::Find);
+    editMenu->addAction(tr("Replace"), this, &MainWindow::showReplace, QKeySequence::Replace);
+    editMenu->addAction(tr("Find Next"), this, &MainWindow::findNext, QKeySequence::FindNext);
+    editMenu->addAction(tr("Find Previous"), this, &MainWindow::findPrevious, QKeySequence::FindPrevious);
+    editMenu->addSeparator();
+    editMenu->addAction(tr("Find in Files"), this, &MainWindow::showFindInFiles,
+                        QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_F));
+}
+
 void MainWindow::initializeComponents() {
     subject = std::make_shared<DocumentSubject>();
-    editorContext = std::make_shared<EditorContext>();
+    subject->setSnapshotProvider([this]() {
+        // Файл в режиме просмотра не декодируется целиком ради наблюдателей
+        return currentIndex >= 0 && currentIndex < editors.size() && editorDocument(tabs->widget(currentIndex))
+            ? editors[currentIndex]->getText() : QString();
+    });
+    // Строка состояния обновляется только при смене состояния документа
+    stateObserver = std::make_shared<StateCallback>([this]() { updateDocumentState(); });
+
+    // Правки текущего документа доставляются наблюдателям раз в кадр
+    frameTimer = new QTimer(this);
+    frameTimer->setSingleShot(true);
+    frameTimer->setInterval(16);
+    connect(frameTimer, &QTimer::timeout, this, [this]() { subject->flush(); });
+
+    autoSaveTimer = new QTimer(this);
+    connect(autoSaveTimer, &QTimer::timeout, this, &MainWindow::autoSaveTick);
+    autoSaveTimer->start(5000);
+
+    backgroundSearch = std::make_unique<BackgroundSearch>(
+        [this](quint64 generation, const QVector<SearchMatch>& batch, bool finished) {
+        // Пачка передается в поток интерфейса через очередь событий
+        QMetaObject::invokeMethod(this, [this, generation, batch, finished]() {
+            onSearchResults(generation, batch, finished);
+        }, Qt::QueuedConnection);
+    });
+    // Поиск перезапускается после паузы в наборе образца или правках текста
+    searchTimer = new QTimer(this);
+    searchTimer->setSingleShot(true);
+    searchTimer->setInterval(150);
+    connect(searchTimer, &QTimer::timeout, this, &MainWindow::startSearch);
+    connect(findBar, &FindBar::searchChanged, searchTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(findBar, &FindBar::findNext, this, &MainWindow::findNext);
+    connect(findBar, &FindBar::findPrevious, this, &MainWindow::findPrevious);
+    connect(findBar, &FindBar::replaceOne, this, &MainWindow::replaceOne);
+    connect(findBar, &FindBar::replaceAll, this, &MainWindow::replaceAll);
+    connect(findBar, &FindBar::closed, this, &MainWindow::clearSearch);
+
+    // Результаты приходят из потоков пула и передаются в поток интерфейса через очередь событий
+    fileSearch = std::make_unique<FileSearch>(
+        [this](quint64 generation, const QVector<FileMatch>& batch) {
+        QMetaObject::invokeMethod(this, [this, generation, batch]() {
+            onFileSearchResults(generation, batch);
+        }, Qt::QueuedConnection);
+    }, [this](quint64 generation, const FileSearchSummary& summary) {
+        QMetaObject::invokeMethod(this, [this, generation, summary]() {
+            onFileSearchFinished(generation, summary);
+        }, Qt::QueuedConnection);
+    });
+    connect(fileSearchPanel, &FileSearchPanel::searchRequested, this, &MainWindow::startFileSearch);
+    connect(fileSearchPanel, &FileSearchPanel::cancelRequested, this, &MainWindow::cancelFileSearch);
+    connect(fileSearchPanel, &FileSearchPanel::matchActivated, this, &MainWindow::openFileMatch);
 }
 
 void MainWindow::onTabChanged(int index) {
     currentIndex = index;
+    if (pendingRestore.contains(tabs->widget(index))) {
+        hydrateTab(tabs->widget(index));
+    }
+    if (hibernated.contains(tabs->widget(index))) {
+        wakeTab(tabs->widget(index));
+    }
+    if (index >= 0 && index < lastUsed.size()) {
+        lastUsed[index] = QDateTime::currentMSecsSinceEpoch();
+    }
+    if (subject) {
+        // Для наблюдателей текущим стал другой документ
+        subject->replaceAll();
+        if (!frameTimer->isActive()) frameTimer->start();
+    }
+    if (findBar->isVisible()) {
+        startSearch();
+    }
     updateWindowTitle();
     updateTextStatistics();
+    updateDocumentState();
 }
 
 void MainWindow::updateWindowTitle() {
@@ -154,23 +415,133 @@ void MainWindow::updateWindowTitle() {
 }
 
 std::shared_ptr<TextComponent> MainWindow::createTextComponent(QTextEdit* textEdit) {
-    auto simpleText = std::make_shared<SimpleTextEdit>(textEdit);
-    auto italicText = std::make_shared<ItalicDecorator>(simpleText);
-    return std::make_shared<BoldDecorator>(italicText);
+    // Набор декораторов известен при сборке, поэтому цепочка собирается шаблоном
+    return std::make_shared<Decorated<SimpleTextEdit, Italic, Bold>>(textEdit);
 }
 
-void MainWindow::newFile() {
+QWidget* MainWindow::createEditorWidget(bool plainTextMode, qint64 size) {
+    if (plainTextMode) {
+        QPlainTextEdit* plainTextEdit = new QPlainTextEdit();
+        if (size > largeFileThreshold) {
+            // Перенос строк заставляет компоновать весь большой документ при изменении ширины
+            plainTextEdit->setLineWrapMode(QPlainTextEdit::NoWrap);
+        }
+        connect(plainTextEdit, &QPlainTextEdit::textChanged, this, &MainWindow::onTextChanged);
+        return plainTextEdit;
+    }
+
     QTextEdit* textEdit = new QTextEdit();
     connect(textEdit, &QTextEdit::textChanged, this, &MainWindow::onTextChanged);
-    auto editor = createTextComponent(textEdit);
-    
-    editors.push_back(editor);
-    receivers.push_back(std::make_shared<TextReceiver>());
-    filePaths.push_back("");
-    commandHistory.push_back(std::vector<std::shared_ptr<ICommand>>());
-    commandIndex.push_back(-1);
+    return textEdit;
+}
+
+bool MainWindow::usePlainTextMode(const FormatInfo& format, qint64 size) {
+    return !format.has(FormatInfo::RichText) || size > largeFileThreshold;
+}
+
+bool MainWindow::useVirtualView(const QString& filePath, const FormatInfo& format, qint64 size) {
+    // Строки читаются прямо из файла в UTF-8, поэтому подходит только простой текст
+    return format.format == DocumentFormat::PlainText && size > virtualViewThreshold &&
+        LineBuffer::canRead(filePath);
+}
+
+int MainWindow::addEditorTab(QWidget* editorWidget, const QString& filePath, const QString& title) {
+    if (QTextEdit* textEdit = qobject_cast<QTextEdit*>(editorWidget)) {
+        editors.push_back(createTextComponent(textEdit));
+    } else if (auto* view = qobject_cast<VirtualTextView*>(editorWidget)) {
+        editors.push_back(std::make_shared<VirtualTextComponent>(view));
+    } else {
+        editors.push_back(std::make_shared<SimplePlainTextEdit>(qobject_cast<QPlainTextEdit*>(editorWidget)));
+    }
+    // Контекст читает текст из вкладки, а не хранит свою копию
+    auto readText = [this, editorWidget]() {
+        if (hibernated.contains(editorWidget)) return hibernatedText(editorWidget);
+        int index = tabs->indexOf(editorWidget);
+        return index >= 0 ? editors[index]->getText() : QString();
+    };
+    filePaths.push_back(filePath);
+    fileFormats.push_back(filePath.isEmpty() ? DocumentFormat::PlainText
+                                             : FormatRegistry::getInstance().detect(filePath).format);
+    journals.push_back(EditJournal::create(filePath));
+    auto context = std::make_shared<EditorContext>();
+    context->setJournal(journals.last());
+    context->setTextProvider(readText);
+    context->addStateObserver(stateObserver);
+    contexts.push_back(context);
+    diskStates.push_back({std::make_shared<ContentHash>(), -1, -1});
+    lastUsed.push_back(QDateTime::currentMSecsSinceEpoch());
+
+    connectDocument(editorWidget);
+    return tabs->addTab(editorWidget, title);
+}
+
+void MainWindow::connectDocument(QWidget* editorWidget) {
+    QTextDocument* document = editorDocument(editorWidget);
+    if (!document) return;
+    connect(document, &QTextDocument::contentsChange, this,
+            [this, editorWidget, document](int position, int removed, int added) {
+        int index = tabs->indexOf(editorWidget);
+        if (suppressJournal || index < 0) return;
+        QString inserted = plainTextRange(document, position, added);
+        journals[index]->append(position, removed, inserted);
+        contexts[index]->recordEdit();
+        diskStates[index].hash->edit(position, removed, added, document->characterCount() - 1,
+                                     [document](int start, int length) {
+            return plainTextRange(document, start, length);
+        });
+        if (index == currentIndex) {
+            subject->post(position, removed, inserted);
+            if (!frameTimer->isActive()) frameTimer->start();
+        }
+        if (editorWidget == searchedWidget) {
+            // Позиции найденных совпадений устарели
+            searchTimer->start();
+        }
+    });
+    // Документ сам помнит точку сохранения в стеке отмены: отмена до нее
+    // снимает флаг изменения, и контекст снова считает текст сохраненным
+    connect(document, &QTextDocument::modificationChanged, this, [this, editorWidget](bool modified) {
+        int index = tabs->indexOf(editorWidget);
+        if (!modified && index >= 0 && !suppressJournal) {
+            contexts[index]->markSaved();
+        }
+    });
+}
+
+void MainWindow::loadIntoEditor(QWidget* editorWidget, const QString& filePath, const FormatInfo& format) {
+    auto* textEdit = qobject_cast<QTextEdit*>(editorWidget);
+    if (!textEdit) {
+        setEditorPlainText(editorWidget, format.adapter->loadDocument(filePath));
+        return;
+    }
 
-    int index = tabs->addTab(textEdit, tr("Untitled"));
+    // Документ собирается без редактора: без компоновки вставка не вызывает
+    // пересчет разметки, и документ компонуется один раз в setDocument()
+    std::unique_ptr<QTextDocument> document(new QTextDocument());
+    document->setDefaultFont(textEdit->document()->defaultFont());
+    format.adapter->loadIntoDocument(filePath, document.get());
+    installDocument(textEdit, std::move(document));
+}
+
+void MainWindow::installDocument(QTextEdit* textEdit, std::unique_ptr<QTextDocument> document) {
+    // Документ, созданный самим редактором, удаляется в setDocument(); ранее
+    // установленный здесь принадлежит виджету и удаляется явно
+    QPointer<QTextDocument> previous = textEdit->document();
+    document->setParent(textEdit);
+    textEdit->setDocument(document.release());
+    if (previous && previous->parent() == textEdit) {
+        delete previous.data();
+    }
+    int index = tabs->indexOf(textEdit);
+    if (index >= 0) {
+        // Вкладка уже создана: журнал и отрезки форматирования переходят на новый документ
+        connectDocument(textEdit);
+        editors[index] = createTextComponent(textEdit);
+    }
+}
+
+void MainWindow::newFile() {
+    int index = addEditorTab(createEditorWidget(), "", tr("Untitled"));
     tabs->setCurrentIndex(index);
 }
 
@@ -185,8 +556,47 @@ void MainWindow::closeTab(int index) {
 }
 
 bool MainWindow::hasUnsavedChanges(int index) {
-    // Implement change detection logic here
-    return false;
+    if (index < 0 || index >= contexts.size() || !contexts[index]->isDirty()) return false;
+    // Несохраненный буфер еще не загруженной вкладки лежит в сессии, а хеш
+    // заполняется только при загрузке
+    if (pendingRestore.contains(tabs->widget(index))) return true;
+    // Правки могли вернуть текст к сохраненному, например набор и удаление
+    return diskStates[index].hash->isDirty();
+}
+
+void MainWindow::markOnDisk(int index, const QString& text) {
+    DiskState& disk = diskStates[index];
+    disk.hash->reset(text);
+    disk.hash->markSaved();
+    QFileInfo info(filePaths[index]);
+    disk.size = info.exists() ? info.size() : -1;
+    disk.modified = info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+}
+
+void MainWindow::checkDiskChanges(int index) {
+    DiskState& disk = diskStates[index];
+    QWidget* widget = tabs->widget(index);
+    if (disk.modified < 0 || filePaths[index].isEmpty() || pendingRestore.contains(widget) ||
+        hibernated.contains(widget)) {
+        return;
+    }
+
+    QFileInfo info(filePaths[index]);
+    if (!info.exists()) return;
+    qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    if (info.size() == disk.size && modified == disk.modified) return;
+    // Предупреждение выдается один раз на изменение файла
+    disk.size = info.size();
+    disk.modified = modified;
+
+    // Файл перечитывается только при новой отметке, и сравниваются хэши, а не текст
+    try {
+        if (!disk.hash->matchesSaved(loadDocumentContent(filePaths[index]))) {
+            statusBar->showMessage(tr("%1 was changed on disk").arg(info.fileName()), 5000);
+        }
+    } catch (const std::exception& e) {
+        qWarning() << "Failed to check" << filePaths[index] << e.what();
+    }
 }
 
 bool MainWindow::confirmClose() {
@@ -204,12 +614,25 @@ bool MainWindow::confirmClose() {
 }
 
 void MainWindow::removeTab(int index) {
+    if (tabs->widget(index) == searchedWidget) {
+        // Поиск перезапустится для вкладки, которая станет текущей
+        searchGeneration = 0;
+        backgroundSearch->cancel();
+        disconnect(scrollConnection);
+        matches.clear();
+        searchedWidget = nullptr;
+    }
+    pendingRestore.remove(tabs->widget(index));
+    hibernated.remove(tabs->widget(index));
+    journals[index]->discard();
+    journals.removeAt(index);
+    contexts.removeAt(index);
+    diskStates.removeAt(index);
+    lastUsed.removeAt(index);
     tabs->removeTab(index);
     editors.removeAt(index);
     filePaths.removeAt(index);
-    receivers.removeAt(index);
-    commandHistory.removeAt(index);
-    commandIndex.removeAt(index);
+    fileFormats.removeAt(index);
 }
 
 void MainWindow::closeEvent(QCloseEvent* event) {
@@ -222,6 +645,7 @@ void MainWindow::closeEvent(QCloseEvent* event) {
     }
 
     if (canClose) {
+        writeSession();
         cleanup();
         event->accept();
     } else {
@@ -230,12 +654,21 @@ void MainWindow::closeEvent(QCloseEvent* event) {
 }
 
 void MainWindow::cleanup() {
+    fileSearch->cancel();
+    pendingRestore.clear();
+    hibernated.clear();
+    restoreStore.reset();
+    for (const auto& journal : journals) {
+        journal->discard();
+    }
+    journals.clear();
+    contexts.clear();
+    diskStates.clear();
+    lastUsed.clear();
     tabs->clear();
     editors.clear();
     filePaths.clear();
-    receivers.clear();
-    commandHistory.clear();
-    commandIndex.clear();
+    fileFormats.clear();
 }
 
 void MainWindow::openFile() {
@@ -251,50 +684,50 @@ void MainWindow::openFile() {
     openFileAtPath(filePath);
 }
 
-void MainWindow::openFileAtPath(const QString& filePath) {
-    QString format = QFileInfo(filePath).suffix().toLower();
-    
-    // Создаем соответствующий адаптер в зависимости от формата файла
-    std::shared_ptr<IDocumentAdapter> adapter;
-    if (format == "html") {
-        adapter = std::make_shared<HtmlDocumentAdapter>();
-    } else if (format == "xml") {
-        adapter = std::make_shared<XmlDocumentAdapter>();
-    } else if (format == "rtf") {
-        adapter = std::make_shared<RtfDocumentAdapter>();
-    } else {
-        adapter = std::make_shared<TextDocumentAdapter>();
-    }
+QString MainWindow::loadDocumentContent(const QString& filePath) {
+    // Формат определяется по содержимому файла, а не только по расширению
+    return FormatRegistry::getInstance().detect(filePath).adapter->loadDocument(filePath);
+}
 
+void MainWindow::openFileAtPath(const QString& filePath) {
     try {
-        QString content = adapter->loadDocument(filePath);
-        
-        QTextEdit* textEdit = new QTextEdit();
-        connect(textEdit, &QTextEdit::textChanged, this, &MainWindow::onTextChanged);
-        textEdit->setPlainText(content);
-        auto editor = createTextComponent(textEdit);
-
-        editors.push_back(editor);
-        filePaths.push_back(filePath);
-        receivers.push_back(std::make_shared<TextReceiver>());
-        commandHistory.push_back({});
-        commandIndex.push_back(-1);
-
-        int index = tabs->addTab(textEdit, QFileInfo(filePath).fileName());
+        const FormatInfo& format = FormatRegistry::getInstance().detect(filePath);
+        qint64 size = QFileInfo(filePath).size();
+        if (useVirtualView(filePath, format, size)) {
+            openVirtualTab(filePath);
+            return;
+        }
+
+        // Простые форматы и большие файлы открываются в QPlainTextEdit
+        std::unique_ptr<QWidget> editorWidget(createEditorWidget(usePlainTextMode(format, size), size));
+        loadIntoEditor(editorWidget.get(), filePath, format);
+
+        // Новый контекст начинается в состоянии Saved
+        int index = addEditorTab(editorWidget.release(), filePath, QFileInfo(filePath).fileName());
+        markOnDisk(index, editors[index]->getText());
         tabs->setCurrentIndex(index);
-        
-        // Устанавливаем начальное состояние документа как сохраненный
-        editorContext->setState(std::make_shared<SavedState>());
-        editorContext->requestEdit("Load");
     } catch (const std::exception& e) {
         QMessageBox::warning(this, tr("Error"), tr("Failed to open file: %1").arg(e.what()));
     }
 }
 
+void MainWindow::openVirtualTab(const QString& filePath) {
+    std::unique_ptr<VirtualTextView> view(new VirtualTextView());
+    auto buffer = std::make_shared<LineBuffer>(filePath);
+    view->setBuffer(buffer);
+
+    // У просмотра нет документа: журнал, хэш и проверка файла на диске его пропускают
+    int index = addEditorTab(view.release(), filePath, QFileInfo(filePath).fileName());
+    tabs->setCurrentIndex(index);
+    statusBar->showMessage(tr("%1 is opened read-only, %2 lines")
+        .arg(QFileInfo(filePath).fileName()).arg(buffer->lineCount()), 5000);
+}
+
 void MainWindow::saveFile() {
     if (currentIndex < 0) return;
 
-    QString& path = filePaths[currentIndex];
+    // Путь вкладки меняется только после успешного сохранения
+    QString path = filePaths[currentIndex];
     if (path.isEmpty()) {
         QString filter = tr("Text Files (*.txt);;HTML Files (*.html);;XML Files (*.xml);;RTF Files (*.rtf);;All Files (*.*)");
         QString selectedFilter;
@@ -319,46 +752,350 @@ void MainWindow::saveFile() {
 }
 
 void MainWindow::saveFileToPath(const QString& path) {
-    QTextEdit* editorWidget = qobject_cast<QTextEdit*>(tabs->currentWidget());
-    if (!editorWidget) return;
-
-    QString content = editorWidget->toPlainText();
-    QString format = QFileInfo(path).suffix().toLower();
-    
-    std::shared_ptr<IDocumentAdapter> adapter;
-    if (format == "html") {
-        adapter = std::make_shared<HtmlDocumentAdapter>();
-    } else if (format == "xml") {
-        adapter = std::make_shared<XmlDocumentAdapter>();
-    } else if (format == "rtf") {
-        adapter = std::make_shared<RtfDocumentAdapter>();
-    } else {
-        adapter = std::make_shared<TextDocumentAdapter>();
+    QTextDocument* document = getCurrentDocument();
+    if (!document) return;
+    if (hibernated.contains(tabs->currentWidget())) {
+        // Текст вкладки не удалось восстановить, а пустой редактор сохранять нельзя
+        QMessageBox::warning(this, tr("Error"), tr("The tab could not be restored and cannot be saved"));
+        return;
     }
 
+    // Текст берется из кэша компонента: повторное сохранение без правок его не пересобирает
+    QString content = editors[currentIndex]->getText();
+    // Тот же файл пишется в формате, определенном при открытии, новый путь - по расширению
+    FormatRegistry& registry = FormatRegistry::getInstance();
+    bool samePath = !filePaths[currentIndex].isEmpty() && filePaths[currentIndex] == path;
+    const FormatInfo& format = samePath ? registry.info(fileFormats[currentIndex]) : registry.forExtension(path);
+    std::shared_ptr<IDocumentAdapter> adapter = format.adapter;
+
     try {
-        adapter->saveDocument(path, content);
-        tabs->setTabText(currentIndex, QFileInfo(path).fileName());
+        if (qobject_cast<QTextEdit*>(tabs->widget(currentIndex))) {
+            // Форматирование берется из отрезков; простые форматы пишут только текст
+            adapter->saveFormatted(path, content, editors[currentIndex]->getAttributes().runs());
+        } else {
+            adapter->saveDocument(path, content);
+        }
+        contexts[currentIndex]->requestSave();
+        contexts[currentIndex]->markSaved();
+        document->setModified(false);
+        journals[currentIndex]->rebase(path);
+        // Состояние на диске снимается уже с нового пути
         filePaths[currentIndex] = path;
+        fileFormats[currentIndex] = format.format;
+        markOnDisk(currentIndex, content);
+        tabs->setTabText(currentIndex, QFileInfo(path).fileName());
         updateWindowTitle();
-        
-        // Устанавливаем состояние "Saved" после успешного сохранения
-        editorContext->setState(std::make_shared<SavedState>());
-        updateDocumentState();
     } catch (const std::exception& e) {
         QMessageBox::warning(this, tr("Error"), tr("Failed to save file: %1").arg(e.what()));
     }
 }
 
+void MainWindow::showFind() {
+    findBar->showFind(editorCursor(tabs->currentWidget()).selectedText());
+    startSearch();
+}
+
+void MainWindow::showReplace() {
+    findBar->showReplace(editorCursor(tabs->currentWidget()).selectedText());
+    startSearch();
+}
+
+void MainWindow::startSearch() {
+    searchTimer->stop();
+    setExtraSelections(searchedWidget, {});
+    disconnect(scrollConnection);
+    matches.clear();
+    currentMatch = -1;
+    activeSearch.reset();
+    searchRunning = false;
+    // Пачки отмененного поиска еще могут стоять в очереди событий
+    searchGeneration = 0;
+    backgroundSearch->cancel();
+    searchedWidget = nullptr;
+
+    if (!findBar->isVisible() || findBar->pattern().isEmpty() || !getCurrentDocument()) {
+        findBar->setMatchCount(-1, 0, false);
+        return;
+    }
+    try {
+        activeSearch = std::make_unique<TextSearch>(findBar->pattern(), findBar->options());
+    } catch (const std::invalid_argument& e) {
+        findBar->setError(tr("Invalid pattern: %1").arg(e.what()));
+        return;
+    }
+
+    searchedWidget = tabs->widget(currentIndex);
+    // Подсвечиваются только видимые совпадения, поэтому подсветка следует за прокруткой
+    auto* scrollArea = qobject_cast<QAbstractScrollArea*>(searchedWidget);
+    scrollConnection = connect(scrollArea->verticalScrollBar(), &QScrollBar::valueChanged,
+                               this, &MainWindow::highlightVisibleMatches);
+    searchRunning = true;
+    searchGeneration = backgroundSearch->start(editors[currentIndex]->getText(), *activeSearch);
+    updateMatchCount();
+}
+
+void MainWindow::onSearchResults(quint64 generation, const QVector<SearchMatch>& batch, bool finished) {
+    if (generation != searchGeneration) return;
+    // Совпадения приходят по порядку, и список остается отсортированным
+    matches += batch;
+    searchRunning = !finished;
+    updateMatchCount();
+    highlightVisibleMatches();
+}
+
+void MainWindow::clearSearch() {
+    findBar->hide();
+    startSearch();
+}
+
+void MainWindow::updateMatchCount() {
+    findBar->setMatchCount(currentMatch, matches.size(), searchRunning);
+}
+
+void MainWindow::highlightVisibleMatches() {
+    if (!searchedWidget || searchedWidget != tabs->currentWidget()) return;
+
+    auto* scrollArea = qobject_cast<QAbstractScrollArea*>(searchedWidget);
+    QRect viewport = scrollArea->viewport()->rect();
+    int first = positionAt(searchedWidget, viewport.topLeft());
+    int last = positionAt(searchedWidget, viewport.bottomRight());
+    // Совпадения, заканчивающиеся до видимой области, пропускаются двоичным поиском
+    auto begin = std::lower_bound(matches.constBegin(), matches.constEnd(), first,
+                                  [](const SearchMatch& match, int position) { return match.end() < position; });
+
+    QTextDocument* document = editorDocument(searchedWidget);
+    QTextCharFormat format;
+    format.setBackground(QColor(255, 235, 120));
+    QTextCharFormat currentFormat;
+    currentFormat.setBackground(QColor(255, 160, 60));
+    QList<QTextEdit::ExtraSelection> selections;
+    for (auto it = begin; it != matches.constEnd() && it->start <= last; ++it) {
+        QTextEdit::ExtraSelection selection;
+        selection.cursor = QTextCursor(document);
+        selection.cursor.setPosition(it->start);
+        selection.cursor.setPosition(it->end(), QTextCursor::KeepAnchor);
+        selection.format = (it - matches.constBegin()) == currentMatch ? currentFormat : format;
+        selections.append(selection);
+    }
+    setExtraSelections(searchedWidget, selections);
+}
+
+void MainWindow::selectMatch(int index) {
+    currentMatch = index;
+    QTextCursor cursor = editorCursor(searchedWidget);
+    cursor.setPosition(matches[index].start);
+    cursor.setPosition(matches[index].end(), QTextCursor::KeepAnchor);
+    setEditorCursor(searchedWidget, cursor);
+    updateMatchCount();
+    highlightVisibleMatches();
+}
+
+void MainWindow::findNext() {
+    if (!findBar->isVisible()) {
+        showFind();
+        return;
+    }
+    if (matches.isEmpty() || searchedWidget != tabs->currentWidget()) return;
+    int position = editorCursor(searchedWidget).selectionEnd();
+    auto it = std::lower_bound(matches.constBegin(), matches.constEnd(), position,
+                               [](const SearchMatch& match, int value) { return match.start < value; });
+    // Текущее совпадение нулевой длины не должно находиться повторно
+    if (it != matches.constEnd() && it->length == 0 && (it - matches.constBegin()) == currentMatch) ++it;
+    selectMatch(it == matches.constEnd() ? 0 : static_cast<int>(it - matches.constBegin()));
+}
+
+void MainWindow::findPrevious() {
+    if (!findBar->isVisible()) {
+        showFind();
+        return;
+    }
+    if (matches.isEmpty() || searchedWidget != tabs->currentWidget()) return;
+    int position = editorCursor(searchedWidget).selectionStart();
+    auto it = std::lower_bound(matches.constBegin(), matches.constEnd(), position,
+                               [](const SearchMatch& match, int value) { return match.start < value; });
+    selectMatch(it == matches.constBegin() ? matches.size() - 1 : static_cast<int>(it - matches.constBegin()) - 1);
+}
+
+void MainWindow::replaceOne() {
+    if (!activeSearch || searchedWidget != tabs->currentWidget()) return;
+    QTextCursor cursor = editorCursor(searchedWidget);
+    bool selected = currentMatch >= 0 && currentMatch < matches.size() &&
+        cursor.selectionStart() == matches[currentMatch].start &&
+        cursor.selectionEnd() == matches[currentMatch].end();
+    if (selected) {
+        cursor.insertText(activeSearch->expand(editors[currentIndex]->getText(), matches[currentMatch],
+                                               findBar->replacement()));
+        setEditorCursor(searchedWidget, cursor);
+        // Правка перезапускает поиск, а до тех пор следующие совпадения сдвигаются вручную
+        int shift = cursor.position() - matches[currentMatch].end();
+        matches.remove(currentMatch);
+        for (int i = currentMatch; i < matches.size(); ++i) {
+            matches[i].start += shift;
+        }
+        currentMatch = -1;
+    }
+    findNext();
+}
+
+void MainWindow::replaceAll() {
+    if (!activeSearch || searchedWidget != tabs->currentWidget()) return;
+    QTextDocument* document = getCurrentDocument();
+    if (!document) return;
+
+    // Новый текст строится одним проходом, а в документ одной правкой в одном
+    // блоке отмены попадает только участок от первого до последнего совпадения
+    const QString text = editors[currentIndex]->getText();
+    QVector<Replacement> replaced;
+    const QString result = activeSearch->replaceAll(text, findBar->replacement(), &replaced);
+    if (replaced.isEmpty()) {
+        statusBar->showMessage(tr("No matches to replace"), 3000);
+        return;
+    }
+    const int start = replaced.first().start;
+    const int unchangedTail = result.size() - (replaced.last().start + replaced.last().length);
+    const int end = text.size() - unchangedTail;
+    // Форматирование участка снимается до правки и возвращается после нее
+    QVector<FormatSpan> spans;
+    if (qobject_cast<QTextEdit*>(tabs->currentWidget())) {
+        spans = formatSpans(document, start, end);
+    }
+
+    QTextCursor cursor(document);
+    cursor.beginEditBlock();
+    cursor.setPosition(start);
+    cursor.setPosition(end, QTextCursor::KeepAnchor);
+    cursor.insertText(result.mid(start, result.size() - unchangedTail - start));
+    restoreFormats(cursor, spans, replaced);
+    cursor.endEditBlock();
+    statusBar->showMessage(tr("Replaced %1 matches").arg(replaced.size()), 5000);
+}
+
+void MainWindow::showFindInFiles() {
+    fileSearchDock->show();
+    fileSearchDock->raise();
+    fileSearchPanel->activate(editorCursor(tabs->currentWidget()).selectedText());
+}
+
+void MainWindow::startFileSearch() {
+    cancelFileSearch();
+    fileSearchPanel->clearResults();
+    fileSearchTabs.clear();
+    if (fileSearchPanel->pattern().isEmpty()) return;
+
+    std::unique_ptr<TextSearch> search;
+    try {
+        search = std::make_unique<TextSearch>(fileSearchPanel->pattern(), fileSearchPanel->options());
+    } catch (const std::invalid_argument& e) {
+        fileSearchPanel->setError(tr("Invalid pattern: %1").arg(e.what()));
+        return;
+    }
+
+    // Открытые вкладки ищутся по тексту в редакторе, с несохраненными правками
+    QVector<OpenBuffer> buffers;
+    if (fileSearchPanel->searchOpenTabs()) {
+        for (int i = 0; i < tabs->count(); ++i) {
+            QWidget* widget = tabs->widget(i);
+            QString text;
+            try {
+                if (hibernated.contains(widget)) {
+                    text = hibernatedText(widget);
+                } else if (editorDocument(widget) && !pendingRestore.contains(widget)) {
+                    text = editors[i]->getText();
+                } else {
+                    // Вкладки просмотра и еще не загруженные вкладки ищутся в файле на диске
+                    continue;
+                }
+            } catch (const std::exception& e) {
+                qWarning() << "Cannot search tab" << tabs->tabText(i) << ":" << e.what();
+                continue;
+            }
+            buffers.append({filePaths[i].isEmpty() ? tabs->tabText(i) : filePaths[i], text});
+            fileSearchTabs.append(widget);
+        }
+    }
+
+    FileSearchOptions options = fileSearchPanel->fileOptions();
+    if (buffers.isEmpty() && options.directories.isEmpty()) {
+        fileSearchPanel->setError(tr("Choose a directory or search open tabs"));
+        return;
+    }
+    fileSearchPanel->setSearching(true);
+    fileSearchGeneration = fileSearch->start(buffers, options, *search);
+}
+
+void MainWindow::cancelFileSearch() {
+    // Пачки отмененного поиска еще могут стоять в очереди событий
+    fileSearchGeneration = 0;
+    fileSearch->cancel();
+    fileSearchPanel->setSearching(false);
+}
+
+void MainWindow::onFileSearchResults(quint64 generation, const QVector<FileMatch>& batch) {
+    if (generation != fileSearchGeneration) return;
+    fileSearchPanel->addResults(batch);
+}
+
+void MainWindow::onFileSearchFinished(quint64 generation, const FileSearchSummary& summary) {
+    if (generation != fileSearchGeneration) return;
+    fileSearchPanel->setSummary(summary);
+}
+
+void MainWindow::openFileMatch(const FileMatch& match) {
+    QWidget* widget = match.buffer >= 0 && match.buffer < fileSearchTabs.size()
+        ? fileSearchTabs[match.buffer].data() : nullptr;
+    if (widget && tabs->indexOf(widget) < 0) {
+        widget = nullptr;
+    }
+    if (!widget && QFileInfo(match.path).isFile()) {
+        // Файл с диска открывается, если его еще нет среди вкладок
+        QString path = QFileInfo(match.path).absoluteFilePath();
+        for (int i = 0; i < filePaths.size() && !widget; ++i) {
+            if (!filePaths[i].isEmpty() && QFileInfo(filePaths[i]).absoluteFilePath() == path) {
+                widget = tabs->widget(i);
+            }
+        }
+        if (!widget) {
+            openFileAtPath(match.path);
+            if (currentIndex >= 0 && filePaths[currentIndex] == match.path) {
+                widget = tabs->widget(currentIndex);
+            }
+        }
+    }
+    if (!widget) {
+        statusBar->showMessage(tr("%1 is no longer open").arg(match.path), 3000);
+        return;
+    }
+
+    tabs->setCurrentWidget(widget);
+    if (auto* view = qobject_cast<VirtualTextView*>(widget)) {
+        view->scrollToLine(match.line - 1);
+        return;
+    }
+    QTextDocument* document = editorDocument(widget);
+    QTextBlock block = document ? document->findBlockByNumber(static_cast<int>(match.line - 1)) : QTextBlock();
+    if (!block.isValid()) return;
+    // Текст мог измениться после поиска, поэтому выделение не выходит за строку и документ
+    int start = block.position() + qMin(match.column, block.length() - 1);
+    QTextCursor cursor(document);
+    cursor.setPosition(start);
+    cursor.setPosition(qMin(start + match.length, document->characterCount() - 1), QTextCursor::KeepAnchor);
+    setEditorCursor(widget, cursor);
+    widget->setFocus();
+}
+
 void MainWindow::undo() {
     if (QTextEdit* editor = getCurrentEditor()) {
         editor->undo();
+    } else if (auto* plainTextEdit = qobject_cast<QPlainTextEdit*>(tabs->currentWidget())) {
+        plainTextEdit->undo();
     }
 }
 
 void MainWindow::redo() {
     if (QTextEdit* editor = getCurrentEditor()) {
         editor->redo();
+    } else if (auto* plainTextEdit = qobject_cast<QPlainTextEdit*>(tabs->currentWidget())) {
+        plainTextEdit->redo();
     }
 }
 
@@ -369,13 +1106,19 @@ QTextEdit* MainWindow::getCurrentEditor() const {
     return nullptr;
 }
 
+QTextDocument* MainWindow::getCurrentDocument() const {
+    return currentIndex >= 0 ? editorDocument(tabs->widget(currentIndex)) : nullptr;
+}
+
 void MainWindow::updateActions() {
-    bool hasEditor = getCurrentEditor() != nullptr;
+    bool hasEditor = getCurrentDocument() != nullptr;
+    // Форматирование доступно только в режиме форматированного текста
+    bool richText = getCurrentEditor() != nullptr;
     undoAction->setEnabled(hasEditor);
     redoAction->setEnabled(hasEditor);
-    boldAction->setEnabled(hasEditor);
-    italicAction->setEnabled(hasEditor);
-    colorAction->setEnabled(hasEditor);
+    boldAction->setEnabled(richText);
+    italicAction->setEnabled(richText);
+    colorAction->setEnabled(richText);
 }
 
 void MainWindow::applyTextFormat(const std::function<void(QTextEdit*)>& formatter) {
@@ -416,27 +1159,466 @@ void MainWindow::chooseColor() {
 }
 
 void MainWindow::onTextChanged() {
+    // Состояние документа меняет счетчик правок в connectDocument()
     updateTextStatistics();
-    
-    // При изменении текста устанавливаем состояние "Modified"
-    if (editorContext) {
-        editorContext->setState(std::make_shared<ModifiedState>());
-        updateDocumentState();
-    }
 }
 
 void MainWindow::updateTextStatistics() {
-    QTextEdit* editor = getCurrentEditor();
-    if (!editor) {
+    QTextDocument* document = getCurrentDocument();
+    if (!document) {
         charCountLabel->setText(tr("Characters: 0"));
         wordCountLabel->setText(tr("Words: 0"));
         return;
     }
 
-    QString text = editor->toPlainText();
+    QString text = editors[currentIndex]->getText();
     auto aggregate = std::make_shared<ConcreteTextAggregate>(text);
     auto iterator = aggregate->createIterator();
 
     charCountLabel->setText(tr("Characters: %1").arg(iterator->getCharCount()));
     wordCountLabel->setText(tr("Words: %1").arg(iterator->getWordCount()));
 }
+
+void MainWindow::restoreSession() {
+    restoreStore = std::make_unique<SessionStore>();
+    if (!restoreStore->open() || restoreStore->entryCount() == 0) {
+        restoreStore.reset();
+        return;
+    }
+
+    // Создаем пустые вкладки сразу, содержимое подгружается лениво
+    {
+        QSignalBlocker blocker(tabs);
+        int firstIndex = tabs->count();
+        for (int i = 0; i < restoreStore->entryCount(); ++i) {
+            SessionEntry entry;
+            try {
+                entry = restoreStore->entry(i, false);
+            } catch (const std::exception& e) {
+                qWarning() << "Skipping session entry:" << e.what();
+                continue;
+            }
+            // Восстановленная из журнала версия новее сохраненной в сессии
+            if (recoveredPaths.contains(entry.filePath)) continue;
+
+            // Размер несохраненного буфера оценивается по кэшированной статистике
+            qint64 size = entry.hasBuffer ? qint64(entry.charCount) * 2 : QFileInfo(entry.filePath).size();
+            bool plainTextMode = !entry.filePath.isEmpty() &&
+                usePlainTextMode(FormatRegistry::getInstance().detect(entry.filePath), size);
+            bool virtualView = !entry.hasBuffer && !entry.filePath.isEmpty() &&
+                useVirtualView(entry.filePath, FormatRegistry::getInstance().detect(entry.filePath), size);
+            QWidget* editorWidget = virtualView ? new VirtualTextView() : createEditorWidget(plainTextMode, size);
+            QString title = entry.title.isEmpty() ? tr("Untitled") : entry.title;
+            int index = addEditorTab(editorWidget, entry.filePath, title);
+            pendingRestore.insert(editorWidget, i);
+            if (entry.hasBuffer) {
+                // Несохраненный буфер остается несохраненным и до загрузки вкладки
+                contexts[index]->recordEdit();
+            }
+
+            // Кэшированная статистика актуальна, только если файл не менялся
+            QFileInfo info(entry.filePath);
+            bool cacheValid = entry.hasBuffer ||
+                (info.exists() && info.size() == entry.fileSize &&
+                 info.lastModified().toMSecsSinceEpoch() == entry.fileModified);
+            if (cacheValid) {
+                tabs->setTabToolTip(index, tr("%1 lines, %2 words")
+                    .arg(entry.lineIndex.size()).arg(entry.wordCount));
+            }
+        }
+        tabs->setCurrentIndex(qBound(0, firstIndex + restoreStore->currentIndex(), tabs->count() - 1));
+    }
+
+    // Видимая вкладка восстанавливается первой
+    onTabChanged(tabs->currentIndex());
+    updateActions();
+    if (!pendingRestore.isEmpty()) {
+        QTimer::singleShot(prefetchDelay, this, [this]() { prefetchNextTab(prefetchLimit); });
+    }
+}
+
+void MainWindow::prefetchNextTab(int remaining) {
+    if (!restoreStore || remaining <= 0) return;
+
+    // Небольшая вкладка, ближайшая к текущей: на нее переключатся вероятнее
+    // всего, а ее загрузка не задержит интерфейс
+    QWidget* next = nullptr;
+    int nearest = tabs->count();
+    for (int i = 0; i < tabs->count(); ++i) {
+        auto it = pendingRestore.find(tabs->widget(i));
+        if (it == pendingRestore.end() || qAbs(i - currentIndex) >= nearest) continue;
+        try {
+            SessionEntry entry = restoreStore->entry(it.value(), false);
+            qint64 size = entry.hasBuffer ? qint64(entry.charCount) * 2 : QFileInfo(entry.filePath).size();
+            if (size > largeFileThreshold) continue;
+        } catch (const std::exception&) {
+            continue;
+        }
+        next = tabs->widget(i);
+        nearest = qAbs(i - currentIndex);
+    }
+    if (!next) return;
+
+    hydrateTab(next);
+    if (remaining > 1 && !pendingRestore.isEmpty()) {
+        QTimer::singleShot(prefetchDelay, this, [this, remaining]() { prefetchNextTab(remaining - 1); });
+    }
+}
+
+void MainWindow::hydrateTab(QWidget* widget) {
+    auto it = pendingRestore.find(widget);
+    if (it == pendingRestore.end() || !restoreStore) return;
+    int entryIndex = it.value();
+    pendingRestore.erase(it);
+
+    try {
+        SessionEntry entry = restoreStore->entry(entryIndex);
+        if (auto* view = qobject_cast<VirtualTextView*>(widget)) {
+            view->setBuffer(std::make_shared<LineBuffer>(entry.filePath));
+            view->verticalScrollBar()->setValue(entry.scrollPosition);
+        } else {
+            {
+                QSignalBlocker blocker(widget);
+                suppressJournal = true;
+                try {
+                    if (entry.hasBuffer) {
+                        setEditorPlainText(widget, entry.buffer);
+                    } else {
+                        loadIntoEditor(widget, entry.filePath, FormatRegistry::getInstance().detect(entry.filePath));
+                    }
+                    // Флаг меняется без участия контекста: его состояние задано при восстановлении сессии
+                    editorDocument(widget)->setModified(entry.hasBuffer && !entry.filePath.isEmpty());
+                } catch (...) {
+                    suppressJournal = false;
+                    throw;
+                }
+                suppressJournal = false;
+            }
+            QTextDocument* document = editorDocument(widget);
+            int index = tabs->indexOf(widget);
+            if (entry.hasBuffer) {
+                // Базой журнала становится несохраненный буфер, а не файл на диске
+                journals[index]->checkpoint(entry.buffer);
+                // Файл не перечитывается: буфер считается отличным от него
+                diskStates[index].hash->reset(entry.buffer);
+            } else {
+                markOnDisk(index, editors[index]->getText());
+            }
+
+            QTextCursor cursor = editorCursor(widget);
+            cursor.setPosition(qBound(0, static_cast<int>(entry.cursorPosition), document->characterCount() - 1));
+            setEditorCursor(widget, cursor);
+
+            // Полоса прокрутки получает диапазон только после компоновки документа
+            int scroll = entry.scrollPosition;
+            auto* scrollArea = qobject_cast<QAbstractScrollArea*>(widget);
+            QTimer::singleShot(0, scrollArea, [scrollArea, scroll]() {
+                scrollArea->verticalScrollBar()->setValue(scroll);
+            });
+        }
+    } catch (const std::exception& e) {
+        int index = tabs->indexOf(widget);
+        statusBar->showMessage(tr("Failed to restore %1: %2")
+            .arg(tabs->tabText(index)).arg(e.what()), 5000);
+        removeTab(index);
+        widget->deleteLater();
+    }
+
+    if (pendingRestore.isEmpty()) {
+        restoreStore.reset();
+    }
+    if (widget == tabs->currentWidget()) {
+        updateTextStatistics();
+    }
+}
+
+void MainWindow::setHibernationDelay(int seconds) {
+    hibernationDelay = qMax(0, seconds);
+}
+
+void MainWindow::hibernateIdleTabs() {
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (int i = 0; i < tabs->count(); ++i) {
+        if (i == currentIndex) {
+            lastUsed[i] = now;
+        } else if (hibernationDelay > 0 && now - lastUsed[i] >= qint64(hibernationDelay) * 1000) {
+            hibernateTab(i);
+        }
+        updateTabMemory(i);
+    }
+}
+
+void MainWindow::hibernateTab(int index) {
+    QWidget* widget = tabs->widget(index);
+    if (index == currentIndex || hibernated.contains(widget) || pendingRestore.contains(widget)) return;
+    QTextDocument* document = editorDocument(widget);
+    if (!document) return;
+
+    HibernatedTab tab;
+    if (!filePaths[index].isEmpty() && !hasUnsavedChanges(index)) {
+        // Чистая вкладка перечитывается из файла
+        tab = HibernatedTab::fromFile(filePaths[index]);
+    } else if (qobject_cast<QTextEdit*>(widget)) {
+        tab = HibernatedTab::fromText(editors[index]->getText(), editors[index]->getAttributes().runs());
+    } else {
+        tab = HibernatedTab::fromText(editors[index]->getText());
+    }
+    tab.cursorPosition = editorCursor(widget).position();
+    tab.scrollPosition = qobject_cast<QAbstractScrollArea*>(widget)->verticalScrollBar()->value();
+
+    {
+        // Очистка освобождает текст, компоновку и стек отмены. Журнал и хэш
+        // содержимого ее не видят и продолжают описывать сохраненный текст
+        QSignalBlocker blocker(widget);
+        suppressJournal = true;
+        document->clear();
+        document->setModified(false);
+        suppressJournal = false;
+    }
+    if (auto* textEdit = qobject_cast<QTextEdit*>(widget)) {
+        editors[index] = createTextComponent(textEdit);
+    } else {
+        editors[index] = std::make_shared<SimplePlainTextEdit>(qobject_cast<QPlainTextEdit*>(widget));
+    }
+    hibernated.insert(widget, tab);
+}
+
+void MainWindow::wakeTab(QWidget* widget) {
+    auto it = hibernated.find(widget);
+    if (it == hibernated.end()) return;
+    HibernatedTab tab = it.value();
+    hibernated.erase(it);
+    int index = tabs->indexOf(widget);
+
+    try {
+        QSignalBlocker blocker(widget);
+        suppressJournal = true;
+        try {
+            auto* textEdit = qobject_cast<QTextEdit*>(widget);
+            if (!tab.hasText()) {
+                loadIntoEditor(widget, tab.filePath(), FormatRegistry::getInstance().detect(tab.filePath()));
+            } else if (textEdit) {
+                std::unique_ptr<QTextDocument> document(new QTextDocument());
+                document->setDefaultFont(textEdit->document()->defaultFont());
+                RichTextBuilder::build(document.get(), tab.text(), tab.runs());
+                installDocument(textEdit, std::move(document));
+            } else {
+                setEditorPlainText(widget, tab.text());
+            }
+            // История отмены не сохраняется, поэтому флаг задается по контексту
+            editorDocument(widget)->setModified(tab.hasText() && contexts[index]->isDirty());
+        } catch (...) {
+            suppressJournal = false;
+            throw;
+        }
+        suppressJournal = false;
+    } catch (const std::exception& e) {
+        // Вкладка остается спящей вместе с текстом и журналом; пустой редактор
+        // закрыт для правок, а следующее переключение на вкладку повторит попытку
+        hibernated.insert(widget, tab);
+        setEditorReadOnly(widget, true);
+        QMessageBox::warning(this, tr("Error"), tr("Failed to restore %1: %2")
+                             .arg(tabs->tabText(index)).arg(e.what()));
+        return;
+    }
+    setEditorReadOnly(widget, false);
+    if (!tab.hasText()) {
+        // Файл мог измениться, пока вкладка спала; вкладка снова совпадает с ним,
+        // и журнал переходит на новый файл, иначе правки лягут на старую основу
+        QString text = editors[index]->getText();
+        markOnDisk(index, text);
+        contexts[index]->markSaved();
+        journals[index]->rebase(tab.filePath());
+    }
+
+    QTextDocument* document = editorDocument(widget);
+    QTextCursor cursor = editorCursor(widget);
+    cursor.setPosition(qBound(0, tab.cursorPosition, document->characterCount() - 1));
+    setEditorCursor(widget, cursor);
+    int scroll = tab.scrollPosition;
+    auto* scrollArea = qobject_cast<QAbstractScrollArea*>(widget);
+    QTimer::singleShot(0, scrollArea, [scrollArea, scroll]() {
+        scrollArea->verticalScrollBar()->setValue(scroll);
+    });
+    updateTabMemory(index);
+}
+
+QString MainWindow::hibernatedText(QWidget* widget) {
+    HibernatedTab tab = hibernated.value(widget);
+    return tab.hasText() ? tab.text() : loadDocumentContent(tab.filePath());
+}
+
+qint64 MainWindow::tabMemoryUsage(int index) {
+    QWidget* widget = tabs->widget(index);
+    auto sleeping = hibernated.constFind(widget);
+    if (sleeping != hibernated.constEnd()) return sleeping->memoryUsage();
+    if (auto* view = qobject_cast<VirtualTextView*>(widget)) return view->memoryUsage();
+    QTextDocument* document = editorDocument(widget);
+    if (!document) return 0;
+    // Оценка без стека отмены: текст, блоки с компоновкой, отрезки форматирования и кэш текста
+    return qint64(document->characterCount()) * sizeof(QChar) + document->blockCount() * blockOverhead +
+           editors[index]->getAttributes().memoryUsage() + editors[index]->cachedBytes();
+}
+
+void MainWindow::updateTabMemory(int index) {
+    // Подсказка ожидающей вкладки показывает кэшированную статистику сессии
+    if (pendingRestore.contains(tabs->widget(index))) return;
+    QString memory = tr("%1 KB in memory").arg((tabMemoryUsage(index) + 1023) / 1024);
+    if (hibernated.contains(tabs->widget(index))) {
+        memory += tr(" (hibernated)");
+    }
+    tabs->setTabToolTip(index, memory);
+}
+
+void MainWindow::writeSession() {
+    QVector<SessionEntry> entries;
+    entries.reserve(tabs->count());
+
+    for (int i = 0; i < tabs->count(); ++i) {
+        QWidget* widget = tabs->widget(i);
+        auto pending = pendingRestore.find(widget);
+        if (pending != pendingRestore.end()) {
+            try {
+                entries.append(restoreStore->entry(pending.value()));
+            } catch (const std::exception& e) {
+                qWarning() << "Dropping session entry:" << e.what();
+            }
+            continue;
+        }
+
+        auto sleeping = hibernated.find(widget);
+        if (sleeping != hibernated.end()) {
+            SessionEntry entry;
+            entry.filePath = filePaths[i];
+            entry.title = tabs->tabText(i);
+            entry.cursorPosition = sleeping->cursorPosition;
+            entry.scrollPosition = sleeping->scrollPosition;
+            // Для вкладки, оставшейся путем к файлу, статистика не сохраняется:
+            // без размера файла ее кэш не считается актуальным
+            if (sleeping->hasText()) {
+                QString text = sleeping->text();
+                entry.hasBuffer = !text.isEmpty() || !entry.filePath.isEmpty();
+                entry.buffer = text;
+                ConcreteTextIterator counter(text);
+                entry.charCount = counter.getCharCount();
+                entry.wordCount = counter.getWordCount();
+                entry.lineIndex = SessionStore::buildLineIndex(text);
+            }
+            entries.append(entry);
+            continue;
+        }
+
+        if (auto* view = qobject_cast<VirtualTextView*>(widget)) {
+            // Файл в режиме просмотра не меняется, и сессия хранит только его путь
+            SessionEntry entry;
+            entry.filePath = filePaths[i];
+            entry.title = tabs->tabText(i);
+            entry.scrollPosition = view->verticalScrollBar()->value();
+            entries.append(entry);
+            continue;
+        }
+
+        QTextDocument* document = editorDocument(widget);
+        if (!document) continue;
+
+        SessionEntry entry;
+        entry.filePath = filePaths[i];
+        entry.title = tabs->tabText(i);
+
+        QString text = editors[i]->getText();
+        entry.hasBuffer = entry.filePath.isEmpty() ? !text.isEmpty() : document->isModified();
+        if (entry.hasBuffer) {
+            entry.buffer = text;
+        }
+        entry.cursorPosition = editorCursor(widget).position();
+        entry.scrollPosition = qobject_cast<QAbstractScrollArea*>(widget)->verticalScrollBar()->value();
+
+        QFileInfo info(entry.filePath);
+        if (info.exists()) {
+            entry.fileSize = info.size();
+            entry.fileModified = info.lastModified().toMSecsSinceEpoch();
+        }
+
+        ConcreteTextIterator counter(text);
+        entry.charCount = counter.getCharCount();
+        entry.wordCount = counter.getWordCount();
+        entry.lineIndex = SessionStore::buildLineIndex(text);
+
+        entries.append(entry);
+    }
+
+    // Записи незагруженных вкладок уже скопированы. Отображение старого файла
+    // снимается до записи: на Windows отображенный файл нельзя заменить
+    pendingRestore.clear();
+    restoreStore.reset();
+
+    try {
+        SessionStore(SessionStore::defaultPath()).save(entries, tabs->currentIndex());
+    } catch (const std::exception& e) {
+        qWarning() << "Failed to write session:" << e.what();
+    }
+}
+
+void MainWindow::recoverJournals() {
+    QDir().mkpath(EditJournal::journalDirectory());
+    journalLock = std::make_unique<QLockFile>(EditJournal::journalDirectory() + "/journal.lock");
+    if (!journalLock->tryLock()) {
+        // Журналы принадлежат другому запущенному экземпляру редактора
+        return;
+    }
+
+    for (const QString& journalPath : EditJournal::pendingJournals()) {
+        EditJournal::Recovery recovery;
+        try {
+            bool recovered = EditJournal::recover(journalPath, [this](const QString& path) {
+                return loadDocumentContent(path);
+            }, recovery);
+            if (!recovered) {
+                // Журнал без несохраненных правок больше не нужен
+                QFile::remove(journalPath);
+                continue;
+            }
+        } catch (const std::exception& e) {
+            // Нечитаемый журнал откладывается в сторону, чтобы правки можно было
+            // восстановить вручную, и больше не попадает в список ожидающих
+            QString keptPath = journalPath + ".failed";
+            QFile::remove(keptPath);
+            QFile::rename(journalPath, keptPath);
+            QMessageBox::warning(this, tr("Recovery"), tr("Failed to recover unsaved changes: %1\nThe journal was kept as %2")
+                                 .arg(e.what()).arg(QDir::toNativeSeparators(keptPath)));
+            continue;
+        }
+
+        qint64 size = qint64(recovery.text.size()) * 2;
+        bool plainTextMode = !recovery.documentPath.isEmpty() &&
+            usePlainTextMode(FormatRegistry::getInstance().detect(recovery.documentPath), size);
+        QWidget* editorWidget = createEditorWidget(plainTextMode, size);
+        setEditorPlainText(editorWidget, recovery.text);
+        QString name = recovery.documentPath.isEmpty() ? tr("Untitled")
+                                                       : QFileInfo(recovery.documentPath).fileName();
+        int index = addEditorTab(editorWidget, recovery.documentPath, tr("%1 (recovered)").arg(name));
+        editorDocument(editorWidget)->setModified(true);
+        contexts[index]->recordEdit();
+        diskStates[index].hash->reset(recovery.text);
+        journals[index]->checkpoint(recovery.text);
+        // Старый журнал удаляется, только когда правки уже перешли в журнал новой вкладки
+        QFile::remove(journalPath);
+
+        if (!recovery.documentPath.isEmpty()) {
+            recoveredPaths.insert(recovery.documentPath);
+        }
+        statusBar->showMessage(tr("Recovered unsaved changes in %1").arg(name), 5000);
+    }
+}
+
+void MainWindow::autoSaveTick() {
+    // Измененные вкладки находятся в состоянии автосохранения и по таймеру
+    // пишут снимки в журнал, что ограничивает время восстановления
+    for (const auto& context : contexts) {
+        context->requestTick();
+    }
+    for (int i = 0; i < diskStates.size(); ++i) {
+        checkDiskChanges(i);
+    }
+    hibernateIdleTabs();
+}
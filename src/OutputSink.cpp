@@ -0,0 +1,104 @@
+#include "OutputSink.hpp"
+#include <QIODevice>
+#include <cstring>
+
+OutputSink::OutputSink(QIODevice* device, int bufferSize)
+    : device(device), buffer(qMax(bufferSize, 16), Qt::Uninitialized), used(0),
+      pendingHighSurrogate(0), failed(false) {}
+
+OutputSink::~OutputSink() {
+    flush();
+}
+
+void OutputSink::write(QLatin1String ascii) {
+    if (pendingHighSurrogate) {
+        encode(QChar::ReplacementCharacter);
+        pendingHighSurrogate = 0;
+    }
+    const char* data = ascii.data();
+    int length = ascii.size();
+    while (length > 0) {
+        reserve(1);
+        int chunk = qMin(length, buffer.size() - used);
+        std::memcpy(buffer.data() + used, data, static_cast<size_t>(chunk));
+        used += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void OutputSink::write(const QChar* data, int length) {
+    for (int i = 0; i < length; ++i) {
+        ushort c = data[i].unicode();
+
+        if (pendingHighSurrogate) {
+            ushort high = pendingHighSurrogate;
+            pendingHighSurrogate = 0;
+            if (QChar::isLowSurrogate(c)) {
+                encode(QChar::surrogateToUcs4(high, c));
+                continue;
+            }
+            encode(QChar::ReplacementCharacter);
+        }
+
+        if (c < 0x80) {
+            // Быстрый путь для ASCII
+            reserve(1);
+            buffer.data()[used++] = static_cast<char>(c);
+        } else if (QChar::isHighSurrogate(c)) {
+            pendingHighSurrogate = c;
+        } else if (QChar::isLowSurrogate(c)) {
+            encode(QChar::ReplacementCharacter);
+        } else {
+            encode(c);
+        }
+    }
+}
+
+bool OutputSink::flush() {
+    if (pendingHighSurrogate) {
+        encode(QChar::ReplacementCharacter);
+        pendingHighSurrogate = 0;
+    }
+    drain();
+    return !failed;
+}
+
+void OutputSink::drain() {
+    if (used > 0 && !failed) {
+        if (device->write(buffer.constData(), used) != used) {
+            failed = true;
+        }
+    }
+    used = 0;
+}
+
+void OutputSink::reserve(int bytes) {
+    if (buffer.size() - used < bytes) {
+        drain();
+    }
+}
+
+void OutputSink::encode(uint codePoint) {
+    reserve(4);
+    char* out = buffer.data() + used;
+    if (codePoint < 0x80) {
+        out[0] = static_cast<char>(codePoint);
+        used += 1;
+    } else if (codePoint < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (codePoint >> 6));
+        out[1] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        used += 2;
+    } else if (codePoint < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (codePoint >> 12));
+        out[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        used += 3;
+    } else {
+        out[0] = static_cast<char>(0xF0 | (codePoint >> 18));
+        out[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        used += 4;
+    }
+}
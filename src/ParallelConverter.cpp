@@ -0,0 +1,199 @@
+#include "ParallelConverter.hpp"
+#include "DocumentAdapter.hpp"
+#include "HtmlTokenizer.hpp"
+#include <QXmlStreamReader>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+bool matchesAt(const QString& text, int pos, const char* pattern) {
+    return text.midRef(pos, static_cast<int>(std::strlen(pattern))) == QLatin1String(pattern);
+}
+
+// Position just after the next occurrence of pattern, -1 if there is none
+int skipPast(const QString& text, int pos, const char* pattern) {
+    int found = text.indexOf(QLatin1String(pattern), pos);
+    return found < 0 ? -1 : found + static_cast<int>(std::strlen(pattern));
+}
+
+// Position just after the '>' closing a tag; quoted values may contain '>'
+int skipXmlTag(const QString& text, int pos) {
+    const QChar* data = text.constData();
+    ushort quote = 0;
+    for (; pos < text.size(); ++pos) {
+        ushort c = data[pos].unicode();
+        if (quote) {
+            if (c == quote) quote = 0;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '>') {
+            return pos + 1;
+        }
+    }
+    return -1;
+}
+
+QString sequentialXmlToPlainText(const QString& xml) {
+    QXmlStreamReader reader(xml);
+    QString content;
+    XmlDocumentAdapter::appendTextRuns(reader, content);
+    XmlDocumentAdapter::trimInPlace(content);
+    return content;
+}
+
+} // namespace
+
+ParallelConverter::ParallelConverter(int threads, int chunkSize)
+    : pool(threads), chunkSize(qMax(chunkSize, 1)) {}
+
+QString ParallelConverter::htmlToPlainText(const QString& html) {
+    const QChar* data = html.constData();
+    QVector<int> points = HtmlTokenizer::findSplitPoints(data, html.size(), chunkSize);
+    if (points.isEmpty()) {
+        return HtmlTokenizer::toPlainText(html);
+    }
+    points.prepend(0);
+    points.append(html.size());
+
+    QVector<QString> results(points.size() - 1);
+    for (int i = 0; i + 1 < points.size(); ++i) {
+        QString* result = &results[i];
+        int start = points[i];
+        int length = points[i + 1] - start;
+        pool.submit([data, start, length, result]() {
+            HtmlTokenizer::appendPlainText(data + start, length, *result);
+        });
+    }
+    pool.wait();
+
+    int total = 0;
+    for (const QString& result : results) {
+        total += result.size() + 1;
+    }
+    QString text;
+    text.reserve(total);
+    for (QString& result : results) {
+        HtmlTokenizer::joinChunk(text, result);
+        result.clear();
+    }
+    HtmlTokenizer::trimLineBreaks(text);
+    return text;
+}
+
+QVector<int> ParallelConverter::findXmlSplitPoints(const QString& xml, int chunkSize,
+                                                   int& rootStart, int& rootStartEnd, QString& rootName) {
+    const QVector<int> sequential;
+    const QChar* data = xml.constData();
+    QVector<int> points;
+    int target = chunkSize;
+    int depth = 0;
+    bool rootClosed = false;
+    rootStart = rootStartEnd = -1;
+
+    int pos = 0;
+    while (pos < xml.size()) {
+        if (data[pos] != QLatin1Char('<')) {
+            ++pos;
+            continue;
+        }
+        if (matchesAt(xml, pos, "<!--")) {
+            pos = skipPast(xml, pos + 4, "-->");
+        } else if (matchesAt(xml, pos, "<![CDATA[")) {
+            pos = skipPast(xml, pos + 9, "]]>");
+        } else if (matchesAt(xml, pos, "<?")) {
+            pos = skipPast(xml, pos + 2, "?>");
+        } else if (matchesAt(xml, pos, "<!")) {
+            // DTD может объявлять сущности, которые нужны всем фрагментам
+            return sequential;
+        } else if (matchesAt(xml, pos, "</")) {
+            if (--depth < 0) return sequential;
+            rootClosed = depth == 0;
+            pos = skipXmlTag(xml, pos);
+        } else {
+            int end = skipXmlTag(xml, pos);
+            if (end < 0) return sequential;
+            bool selfClosing = data[end - 2] == QLatin1Char('/');
+            if (depth == 0) {
+                if (rootStart >= 0) return sequential;
+                rootStart = pos;
+                rootStartEnd = end;
+                int nameEnd = pos + 1;
+                while (nameEnd < end && !data[nameEnd].isSpace() && data[nameEnd] != QLatin1Char('/') &&
+                       data[nameEnd] != QLatin1Char('>')) {
+                    ++nameEnd;
+                }
+                rootName = xml.mid(pos + 1, nameEnd - pos - 1);
+                rootClosed = selfClosing;
+            } else if (depth == 1 && pos >= target) {
+                points.append(pos);
+                target = pos + chunkSize;
+            }
+            if (!selfClosing) ++depth;
+            pos = end;
+        }
+        if (pos < 0) return sequential;
+    }
+    return depth == 0 && rootClosed ? points : sequential;
+}
+
+QString ParallelConverter::xmlToPlainText(const QString& xml) {
+    int rootStart = 0;
+    int rootStartEnd = 0;
+    QString rootName;
+    QVector<int> points = findXmlSplitPoints(xml, chunkSize, rootStart, rootStartEnd, rootName);
+    if (points.isEmpty()) {
+        return sequentialXmlToPlainText(xml);
+    }
+    points.prepend(0);
+    points.append(xml.size());
+
+    // Каждый фрагмент - самостоятельный документ: начальный тег корня,
+    // часть его дочерних элементов и закрывающий тег корня
+    const QString rootOpen = xml.mid(rootStart, rootStartEnd - rootStart);
+    const QString rootClose = "</" + rootName + ">";
+    const int chunks = points.size() - 1;
+    QVector<QString> results(chunks);
+    std::atomic<bool> failed(false);
+
+    for (int i = 0; i < chunks; ++i) {
+        QString* result = &results[i];
+        int start = points[i];
+        int length = points[i + 1] - start;
+        bool first = i == 0;
+        bool last = i == chunks - 1;
+        pool.submit([&xml, &rootOpen, &rootClose, &failed, result, start, length, first, last]() {
+            QString chunk;
+            chunk.reserve(rootOpen.size() + length + rootClose.size());
+            if (!first) chunk += rootOpen;
+            chunk += xml.midRef(start, length);
+            if (!last) chunk += rootClose;
+            try {
+                QXmlStreamReader reader(chunk);
+                XmlDocumentAdapter::appendTextRuns(reader, *result);
+            } catch (const std::exception&) {
+                failed = true;
+            }
+        });
+    }
+    pool.wait();
+
+    if (failed) {
+        // Ошибка сообщается так же, как при последовательном разборе
+        return sequentialXmlToPlainText(xml);
+    }
+
+    int total = 0;
+    for (const QString& result : results) {
+        total += result.size();
+    }
+    QString text;
+    text.reserve(total);
+    for (QString& result : results) {
+        text += result;
+        result.clear();
+    }
+    XmlDocumentAdapter::trimInPlace(text);
+    return text;
+}
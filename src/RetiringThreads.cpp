@@ -0,0 +1,42 @@
+#include "RetiringThreads.hpp"
+#include <algorithm>
+
+RetiringThreads::~RetiringThreads() {
+    joinAll();
+}
+
+void RetiringThreads::start(std::function<void()> job) {
+    retire();
+    auto done = std::make_shared<std::atomic<bool>>(false);
+    active.done = done;
+    active.thread = std::thread([job = std::move(job), done]() {
+        job();
+        done->store(true);
+    });
+}
+
+void RetiringThreads::retire() {
+    if (active.thread.joinable()) {
+        retired.push_back(std::move(active));
+        active = Worker();
+    }
+    // Завершившиеся потоки присоединяются сразу, остальные ждут следующего вызова
+    auto finished = std::remove_if(retired.begin(), retired.end(), [](Worker& worker) {
+        if (!worker.done->load()) return false;
+        worker.thread.join();
+        return true;
+    });
+    retired.erase(finished, retired.end());
+}
+
+void RetiringThreads::wait() {
+    if (active.thread.joinable()) active.thread.join();
+}
+
+void RetiringThreads::joinAll() {
+    wait();
+    for (Worker& worker : retired) {
+        worker.thread.join();
+    }
+    retired.clear();
+}
@@ -0,0 +1,54 @@
+#include "RichTextBuilder.hpp"
+#include <QTextCharFormat>
+#include <QTextCursor>
+#include <QTextDocument>
+
+void RichTextBuilder::build(QTextDocument* document, const QString& text, const QVector<TextFormatRun>& runs) {
+    document->setUndoRedoEnabled(false);
+    QTextCursor cursor(document);
+    cursor.beginEditBlock();
+
+    const QChar* data = text.constData();
+    int position = 0;
+    QTextCharFormat format;
+    for (int i = 0; i <= runs.size(); ++i) {
+        int end = i < runs.size() ? qMin(runs[i].start, text.size()) : text.size();
+        if (end > position) {
+            cursor.insertText(QString::fromRawData(data + position, end - position), format);
+            position = end;
+        }
+        if (i < runs.size()) {
+            const TextStyle& style = runs[i].style;
+            format = QTextCharFormat();
+            if (style.bold) format.setFontWeight(QFont::Bold);
+            if (style.italic) format.setFontItalic(true);
+            if (style.color.isValid()) format.setForeground(style.color);
+        }
+    }
+
+    cursor.endEditBlock();
+    document->setUndoRedoEnabled(true);
+    document->setModified(false);
+}
+
+void RichTextBuilder::addRun(QVector<TextFormatRun>& runs, int position, const TextStyle& style) {
+    if (!runs.isEmpty() && runs.last().start == position) {
+        runs.removeLast();
+    }
+    const TextStyle current = runs.isEmpty() ? TextStyle() : runs.last().style;
+    if (style != current) {
+        runs.append({position, style});
+    }
+}
+
+void RichTextBuilder::trimRuns(QVector<TextFormatRun>& runs, int removedPrefix, int length) {
+    QVector<TextFormatRun> trimmed;
+    trimmed.reserve(runs.size());
+    for (const TextFormatRun& run : runs) {
+        int start = qMax(0, run.start - removedPrefix);
+        if (start < length || trimmed.isEmpty()) {
+            addRun(trimmed, qMin(start, length), run.style);
+        }
+    }
+    runs = trimmed;
+}
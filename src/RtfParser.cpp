@@ -0,0 +1,426 @@
+#include "RtfParser.hpp"
+#include "OutputSink.hpp"
+#include <QByteArray>
+#include <QColor>
+#include <QTextCodec>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+// Destinations whose text is not part of the document body, sorted
+const char* const skippedDestinations[] = {
+    "bkmkend", "bkmkstart", "colorschememapping", "colortbl", "datastore", "filetbl",
+    "fldinst", "fonttbl", "footer", "footerf", "footerl", "footerr", "footnote", "generator",
+    "header", "headerf", "headerl", "headerr", "info", "latentstyles", "listoverridetable",
+    "listtable", "object", "pgdsctbl", "pict", "private", "revtbl", "rsidtbl", "stylesheet",
+    "tc", "themedata", "xe", "xmlnstbl"
+};
+
+struct Symbol {
+    const char* word;
+    ushort character;
+};
+
+// Control words that stand for a character, sorted by name
+const Symbol symbols[] = {
+    {"bullet", 0x2022}, {"emdash", 0x2014}, {"emspace", 0x2003}, {"endash", 0x2013},
+    {"enspace", 0x2002}, {"ldblquote", 0x201C}, {"line", '\n'}, {"lquote", 0x2018},
+    {"page", '\n'}, {"par", '\n'}, {"qmspace", 0x2005}, {"rdblquote", 0x201D},
+    {"rquote", 0x2019}, {"sect", '\n'}, {"tab", '\t'}
+};
+
+const int maxWordLength = 32;
+
+struct CStringLess {
+    bool operator()(const char* a, const char* b) const { return std::strcmp(a, b) < 0; }
+};
+
+bool isSkippedDestination(const char* word) {
+    return std::binary_search(std::begin(skippedDestinations), std::end(skippedDestinations),
+                              word, CStringLess());
+}
+
+const Symbol* findSymbol(const char* word) {
+    auto it = std::lower_bound(std::begin(symbols), std::end(symbols), word,
+                               [](const Symbol& symbol, const char* name) {
+                                   return std::strcmp(symbol.word, name) < 0;
+                               });
+    return (it != std::end(symbols) && std::strcmp(it->word, word) == 0) ? it : nullptr;
+}
+
+inline bool isAsciiAlpha(ushort c) {
+    return (c | 0x20) >= 'a' && (c | 0x20) <= 'z';
+}
+
+inline bool isDigit(ushort c) {
+    return c >= '0' && c <= '9';
+}
+
+inline int hexValue(ushort c) {
+    if (isDigit(c)) return c - '0';
+    c |= 0x20;
+    return (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+}
+
+QTextCodec* codecForCodePage(int codePage) {
+    QTextCodec* codec = nullptr;
+    if (codePage == 65001) {
+        codec = QTextCodec::codecForName("UTF-8");
+    } else if (codePage > 0) {
+        codec = QTextCodec::codecForName("windows-" + QByteArray::number(codePage));
+        if (!codec) {
+            codec = QTextCodec::codecForName("CP" + QByteArray::number(codePage));
+        }
+    }
+    return codec ? codec : QTextCodec::codecForName("windows-1252");
+}
+
+class RtfReader {
+public:
+    RtfReader(const QString& input, QString& out, QVector<TextFormatRun>* runs = nullptr)
+        : data(input.constData()), length(input.size()), out(out), runs(runs),
+          codec(codecForCodePage(1252)) {
+        groups.push_back(GroupState());
+    }
+
+    void run() {
+        int pos = 0;
+        while (pos < length) {
+            ushort c = data[pos].unicode();
+            if (c == '{') {
+                flushBytes();
+                groups.push_back(groups.back());
+                groups.back().destinationPending = true;
+                skipFallback = 0;
+                ++pos;
+            } else if (c == '}') {
+                flushBytes();
+                if (groups.size() > 1) {
+                    groups.pop_back();
+                }
+                skipFallback = 0;
+                ++pos;
+            } else if (c == '\\') {
+                pos = readControl(pos + 1);
+            } else if (c == '\r' || c == '\n') {
+                // Переводы строк в исходном тексте RTF не являются содержимым
+                ++pos;
+            } else {
+                flushBytes();
+                if (c == ';' && groups.back().colorTable) {
+                    endColorEntry();
+                }
+                emitChar(c);
+                ++pos;
+            }
+        }
+        flushBytes();
+    }
+
+private:
+    struct GroupState {
+        int unicodeSkip = 1;
+        bool skipped = false;
+        bool destinationPending = false;
+        bool colorTable = false;
+        TextStyle style;
+    };
+
+    int readControl(int pos) {
+        if (pos >= length) {
+            return pos;
+        }
+        ushort c = data[pos].unicode();
+
+        if (!isAsciiAlpha(c)) {
+            return readControlSymbol(pos);
+        }
+
+        char word[maxWordLength + 1];
+        int wordLength = 0;
+        while (pos < length && isAsciiAlpha(data[pos].unicode())) {
+            if (wordLength < maxWordLength) {
+                word[wordLength++] = static_cast<char>(data[pos].unicode());
+            }
+            ++pos;
+        }
+        word[wordLength] = '\0';
+
+        bool hasParam = false;
+        bool negative = false;
+        int param = 0;
+        if (pos < length && data[pos] == QLatin1Char('-')) {
+            negative = true;
+            ++pos;
+        }
+        while (pos < length && isDigit(data[pos].unicode())) {
+            hasParam = true;
+            if (param < 100000000) {
+                param = param * 10 + (data[pos].unicode() - '0');
+            }
+            ++pos;
+        }
+        if (negative) {
+            param = -param;
+        }
+        // Пробел после управляющего слова - разделитель, а не текст
+        if (pos < length && data[pos] == QLatin1Char(' ')) {
+            ++pos;
+        }
+
+        if (std::strcmp(word, "bin") == 0 && hasParam && param > 0) {
+            // Двоичные данные пропускаются целиком
+            flushBytes();
+            return std::min(length, pos + param);
+        }
+
+        handleControlWord(word, hasParam, param);
+        return pos;
+    }
+
+    int readControlSymbol(int pos) {
+        ushort c = data[pos].unicode();
+        if (c == '\'') {
+            if (pos + 2 < length && hexValue(data[pos + 1].unicode()) >= 0 &&
+                hexValue(data[pos + 2].unicode()) >= 0) {
+                char byte = static_cast<char>(hexValue(data[pos + 1].unicode()) * 16 +
+                                              hexValue(data[pos + 2].unicode()));
+                if (skipFallback > 0) {
+                    --skipFallback;
+                } else if (!groups.back().skipped) {
+                    pendingBytes.append(byte);
+                }
+                return pos + 3;
+            }
+            return pos + 1;
+        }
+
+        flushBytes();
+        groups.back().destinationPending = false;
+        switch (c) {
+        case '*':
+            // Неизвестная приемнику группа {\*\dest ...} пропускается
+            groups.back().skipped = true;
+            break;
+        case '\\':
+        case '{':
+        case '}':
+            emitChar(c);
+            break;
+        case '~':
+            emitChar(0x00A0);
+            break;
+        case '_':
+            emitChar(0x2011);
+            break;
+        case '\r':
+        case '\n':
+            emitChar('\n');
+            break;
+        default:
+            // \- (мягкий перенос) и прочие символы не дают текста
+            break;
+        }
+        return pos + 1;
+    }
+
+    void handleControlWord(const char* word, bool hasParam, int param) {
+        GroupState& group = groups.back();
+        bool atGroupStart = group.destinationPending;
+        group.destinationPending = false;
+
+        flushBytes();
+
+        if (atGroupStart && isSkippedDestination(word)) {
+            group.skipped = true;
+            group.colorTable = runs && std::strcmp(word, "colortbl") == 0;
+            return;
+        }
+        if (group.colorTable) {
+            readColorComponent(word, param);
+            return;
+        }
+        if (skipFallback > 0) {
+            // Управляющее слово считается одним символом замены \uN
+            --skipFallback;
+            return;
+        }
+        if (std::strcmp(word, "u") == 0 && hasParam) {
+            emitChar(static_cast<ushort>(param < 0 ? param + 65536 : param));
+            skipFallback = group.unicodeSkip;
+            return;
+        }
+        if (std::strcmp(word, "uc") == 0 && hasParam) {
+            group.unicodeSkip = std::max(0, param);
+            return;
+        }
+        if (std::strcmp(word, "ansicpg") == 0 && hasParam) {
+            codec = codecForCodePage(param);
+            return;
+        }
+        if (std::strcmp(word, "mac") == 0) {
+            codec = QTextCodec::codecForName("Apple Roman");
+            if (!codec) codec = codecForCodePage(1252);
+            return;
+        }
+        if (std::strcmp(word, "pc") == 0) {
+            codec = codecForCodePage(437);
+            return;
+        }
+        if (std::strcmp(word, "pca") == 0) {
+            codec = codecForCodePage(850);
+            return;
+        }
+        if (runs && applyFormatting(word, hasParam, param, group.style)) {
+            return;
+        }
+        if (const Symbol* symbol = findSymbol(word)) {
+            emitChar(symbol->character);
+        }
+    }
+
+    // \b, \i, \cfN and \plain; returns false for other words
+    bool applyFormatting(const char* word, bool hasParam, int param, TextStyle& style) {
+        bool on = !hasParam || param != 0;
+        if (std::strcmp(word, "b") == 0) {
+            style.bold = on;
+        } else if (std::strcmp(word, "i") == 0) {
+            style.italic = on;
+        } else if (std::strcmp(word, "cf") == 0) {
+            // \cf0 и неизвестные индексы означают цвет по умолчанию
+            style.color = hasParam && param >= 0 && param < colors.size() ? colors[param] : QColor();
+        } else if (std::strcmp(word, "plain") == 0) {
+            style = TextStyle();
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    void readColorComponent(const char* word, int param) {
+        int value = std::max(0, std::min(255, param));
+        if (std::strcmp(word, "red") == 0) {
+            pendingColor.setRed(value);
+        } else if (std::strcmp(word, "green") == 0) {
+            pendingColor.setGreen(value);
+        } else if (std::strcmp(word, "blue") == 0) {
+            pendingColor.setBlue(value);
+        } else {
+            return;
+        }
+        pendingColorSet = true;
+    }
+
+    void endColorEntry() {
+        // Пустая запись таблицы - цвет по умолчанию (обычно \cf0)
+        colors.append(pendingColorSet ? pendingColor : QColor());
+        pendingColor = QColor(0, 0, 0);
+        pendingColorSet = false;
+    }
+
+    void recordStyle() {
+        const TextStyle& style = groups.back().style;
+        if (style != recordedStyle) {
+            RichTextBuilder::addRun(*runs, out.size(), style);
+            recordedStyle = style;
+        }
+    }
+
+    void emitChar(ushort c) {
+        groups.back().destinationPending = false;
+        if (skipFallback > 0) {
+            --skipFallback;
+            return;
+        }
+        if (!groups.back().skipped) {
+            if (runs) recordStyle();
+            out.append(QChar(c));
+        }
+    }
+
+    void flushBytes() {
+        if (!pendingBytes.isEmpty()) {
+            if (runs) recordStyle();
+            out.append(codec->toUnicode(pendingBytes));
+            pendingBytes.clear();
+        }
+    }
+
+    const QChar* data;
+    int length;
+    QString& out;
+    QVector<TextFormatRun>* runs;
+    QTextCodec* codec;
+    std::vector<GroupState> groups;
+    // Байты подряд идущих \'hh декодируются вместе: многобайтовые кодировки
+    // разбивают один символ на несколько экранирований
+    QByteArray pendingBytes;
+    int skipFallback = 0;
+    // Таблица цветов \colortbl для \cfN
+    QVector<QColor> colors;
+    QColor pendingColor{0, 0, 0};
+    bool pendingColorSet = false;
+    TextStyle recordedStyle;
+};
+
+} // namespace
+
+QString RtfParser::toPlainText(const QString& rtf) {
+    QString out;
+    out.reserve(rtf.size());
+    RtfReader(rtf, out).run();
+    out.squeeze();
+    return out;
+}
+
+QString RtfParser::toRichText(const QString& rtf, QVector<TextFormatRun>& runs) {
+    QString out;
+    out.reserve(rtf.size());
+    runs.clear();
+    RtfReader(rtf, out, &runs).run();
+    out.squeeze();
+    return out;
+}
+
+void RtfParser::writeEscaped(const QString& text, OutputSink& sink) {
+    const QChar* data = text.constData();
+    const int length = text.size();
+    int runStart = 0;
+    for (int i = 0; i < length; ++i) {
+        ushort c = data[i].unicode();
+        if (c < 0x80 && c != '\\' && c != '{' && c != '}' && c != '\n' && c != '\t' && c != '\r') {
+            continue;
+        }
+        // Обычные символы пишутся целыми отрезками
+        sink.write(data + runStart, i - runStart);
+        runStart = i + 1;
+        switch (c) {
+        case '\\':
+        case '{':
+        case '}':
+            sink.write(QLatin1Char('\\'));
+            sink.write(QChar(c));
+            break;
+        case '\n':
+            sink.write(QLatin1String("\\par\n"));
+            break;
+        case '\t':
+            sink.write(QLatin1String("\\tab "));
+            break;
+        case '\r':
+            break;
+        default: {
+            // \uN принимает знаковое 16-битное число
+            char escape[16];
+            int size = std::snprintf(escape, sizeof(escape), "\\u%d?", static_cast<short>(c));
+            sink.write(QLatin1String(escape, size));
+            break;
+        }
+        }
+    }
+    sink.write(data + runStart, length - runStart);
+}
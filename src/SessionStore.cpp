@@ -0,0 +1,229 @@
+#include "SessionStore.hpp"
+#include <QDataStream>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFileInfo>
+#include <climits>
+#include <stdexcept>
+
+namespace {
+
+const quint8 hasBufferFlag = 0x01;
+
+// Line starts are stored as LEB128-encoded deltas
+QByteArray encodeLineIndex(const QVector<qint32>& lineIndex) {
+    QByteArray encoded;
+    encoded.reserve(lineIndex.size() * 2);
+    qint32 previous = 0;
+    for (qint32 offset : lineIndex) {
+        quint32 delta = static_cast<quint32>(offset - previous);
+        previous = offset;
+        do {
+            quint8 byte = delta & 0x7F;
+            delta >>= 7;
+            if (delta) {
+                byte |= 0x80;
+            }
+            encoded.append(static_cast<char>(byte));
+        } while (delta);
+    }
+    return encoded;
+}
+
+QVector<qint32> decodeLineIndex(const QByteArray& encoded) {
+    QVector<qint32> lineIndex;
+    qint32 previous = 0;
+    quint32 delta = 0;
+    int shift = 0;
+    for (char ch : encoded) {
+        quint8 byte = static_cast<quint8>(ch);
+        delta |= static_cast<quint32>(byte & 0x7F) << shift;
+        if (byte & 0x80) {
+            shift += 7;
+            continue;
+        }
+        previous += static_cast<qint32>(delta);
+        lineIndex.append(previous);
+        delta = 0;
+        shift = 0;
+    }
+    return lineIndex;
+}
+
+} // namespace
+
+SessionStore::SessionStore(const QString& sessionPath)
+    : path(sessionPath), mapped(nullptr), mappedSize(0), current(-1) {}
+
+SessionStore::~SessionStore() {
+    close();
+}
+
+QString SessionStore::defaultPath() {
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return dir + "/session.bin";
+}
+
+QVector<qint32> SessionStore::buildLineIndex(const QString& text) {
+    QVector<qint32> lineIndex;
+    lineIndex.append(0);
+    int pos = text.indexOf('\n');
+    while (pos >= 0) {
+        lineIndex.append(pos + 1);
+        pos = text.indexOf('\n', pos + 1);
+    }
+    return lineIndex;
+}
+
+void SessionStore::save(const QVector<SessionEntry>& entries, int currentIndex) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        throw std::runtime_error("Cannot open session file for writing");
+    }
+
+    QDataStream stream(&out);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << magic << version << static_cast<qint32>(currentIndex)
+           << static_cast<quint32>(entries.size());
+
+    // Таблица смещений заполняется после записи записей
+    qint64 tablePos = out.pos();
+    for (int i = 0; i < entries.size(); ++i) {
+        stream << quint64(0);
+    }
+
+    QVector<quint64> entryOffsets;
+    entryOffsets.reserve(entries.size());
+    for (const SessionEntry& entry : entries) {
+        entryOffsets.append(static_cast<quint64>(out.pos()));
+
+        quint8 flags = entry.hasBuffer ? hasBufferFlag : 0;
+        stream << entry.filePath << entry.title << flags
+               << entry.cursorPosition << entry.scrollPosition
+               << entry.fileSize << entry.fileModified
+               << entry.charCount << entry.wordCount
+               << encodeLineIndex(entry.lineIndex);
+
+        QByteArray buffer = entry.hasBuffer ? entry.buffer.toUtf8() : QByteArray();
+        stream << static_cast<quint32>(buffer.size());
+        stream.writeRawData(buffer.constData(), buffer.size());
+    }
+
+    out.seek(tablePos);
+    for (quint64 offset : entryOffsets) {
+        stream << offset;
+    }
+
+    if (stream.status() != QDataStream::Ok || !out.commit()) {
+        throw std::runtime_error("Failed to write session file");
+    }
+}
+
+bool SessionStore::open() {
+    close();
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    mappedSize = file.size();
+    mapped = file.map(0, mappedSize);
+    if (!mapped) {
+        close();
+        return false;
+    }
+
+    QByteArray header = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped),
+                                                static_cast<int>(qMin<qint64>(mappedSize, INT_MAX)));
+    QDataStream stream(header);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 fileMagic = 0;
+    quint16 fileVersion = 0;
+    quint32 count = 0;
+    stream >> fileMagic >> fileVersion >> current >> count;
+    if (stream.status() != QDataStream::Ok || fileMagic != magic || fileVersion != version) {
+        close();
+        return false;
+    }
+
+    offsets.resize(static_cast<int>(count));
+    for (quint32 i = 0; i < count; ++i) {
+        stream >> offsets[static_cast<int>(i)];
+        if (offsets[static_cast<int>(i)] >= static_cast<quint64>(mappedSize)) {
+            close();
+            return false;
+        }
+    }
+    if (stream.status() != QDataStream::Ok) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SessionStore::close() {
+    if (mapped) {
+        file.unmap(const_cast<uchar*>(mapped));
+        mapped = nullptr;
+    }
+    if (file.isOpen()) {
+        file.close();
+    }
+    mappedSize = 0;
+    current = -1;
+    offsets.clear();
+}
+
+bool SessionStore::isOpen() const {
+    return mapped != nullptr;
+}
+
+int SessionStore::entryCount() const {
+    return offsets.size();
+}
+
+int SessionStore::currentIndex() const {
+    return current;
+}
+
+SessionEntry SessionStore::entry(int index, bool withBuffer) const {
+    if (!mapped || index < 0 || index >= offsets.size()) {
+        throw std::out_of_range("Session entry index out of range");
+    }
+
+    qint64 offset = static_cast<qint64>(offsets[index]);
+    QByteArray record = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped + offset),
+                                                static_cast<int>(qMin<qint64>(mappedSize - offset, INT_MAX)));
+    QDataStream stream(record);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    SessionEntry result;
+    quint8 flags = 0;
+    QByteArray encodedLineIndex;
+    quint32 bufferSize = 0;
+    stream >> result.filePath >> result.title >> flags
+           >> result.cursorPosition >> result.scrollPosition
+           >> result.fileSize >> result.fileModified
+           >> result.charCount >> result.wordCount
+           >> encodedLineIndex >> bufferSize;
+    if (stream.status() != QDataStream::Ok) {
+        throw std::runtime_error("Corrupted session entry");
+    }
+
+    result.hasBuffer = flags & hasBufferFlag;
+    result.lineIndex = decodeLineIndex(encodedLineIndex);
+
+    qint64 bufferPos = stream.device()->pos();
+    if (bufferPos + bufferSize > record.size()) {
+        throw std::runtime_error("Corrupted session entry");
+    }
+    if (withBuffer && result.hasBuffer) {
+        result.buffer = QString::fromUtf8(record.constData() + bufferPos, static_cast<int>(bufferSize));
+    }
+    return result;
+}
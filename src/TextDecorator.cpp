@@ -1,14 +1,117 @@
 #include "TextDecorator.hpp"
-#include <QRegularExpression>
+#include "VirtualTextView.hpp"
+#include <QTextBlock>
+#include <QTextCharFormat>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTextFragment>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+TextStyle styleOf(const QTextCharFormat& format) {
+    TextStyle style;
+    style.bold = format.fontWeight() >= QFont::Bold;
+    style.italic = format.fontItalic();
+    if (format.hasProperty(QTextFormat::ForegroundBrush)) {
+        style.color = format.foreground().color();
+    }
+    return style;
+}
+
+QTextCharFormat formatOf(const TextStyle& style) {
+    QTextCharFormat format;
+    // Вес и наклон задаются всегда, чтобы слияние снимало и прежнее форматирование
+    format.setFontWeight(style.bold ? QFont::Bold : QFont::Normal);
+    format.setFontItalic(style.italic);
+    if (style.color.isValid()) format.setForeground(style.color);
+    return format;
+}
+
+// Переносит форматирование символов документа в отрезки на участке [position, position + length)
+void copyFormats(QTextDocument* document, AttributeRuns& attributes, int position, int length) {
+    int end = qMin(position + length, attributes.length());
+    for (QTextBlock block = document->findBlock(position); block.isValid() && block.position() < end;
+         block = block.next()) {
+        for (QTextBlock::iterator it = block.begin(); !it.atEnd(); ++it) {
+            QTextFragment fragment = it.fragment();
+            int start = qMax(fragment.position(), position);
+            int stop = qMin(fragment.position() + fragment.length(), end);
+            if (stop <= start) continue;
+
+            TextStyle style = styleOf(fragment.charFormat());
+            QVector<TextFormatRun> current = attributes.query(start, stop - start);
+            if (current.size() != 1 || current.first().style != style) {
+                attributes.setStyle(start, stop - start, style);
+            }
+        }
+    }
+}
+
+// Держит отрезки в соответствии с документом; при readFormats стиль
+// измененного текста берется из его форматирования. changed вызывается при
+// каждой правке, чтобы компонент сбросил кэш
+QMetaObject::Connection trackDocument(QTextDocument* document, AttributeRuns& attributes, bool readFormats,
+                                      std::function<void()> changed) {
+    attributes = AttributeRuns(document->characterCount() - 1);
+    if (readFormats) {
+        copyFormats(document, attributes, 0, attributes.length());
+    }
+    return QObject::connect(document, &QTextDocument::contentsChange,
+                            [document, &attributes, readFormats, changed](int position, int removed, int added) {
+        changed();
+        attributes.edit(position, removed, added);
+        // При замене всего текста Qt учитывает и завершающий разделитель абзаца
+        int length = document->characterCount() - 1;
+        if (attributes.length() > length) {
+            attributes.remove(length, attributes.length() - length);
+        } else if (attributes.length() < length) {
+            attributes.insert(attributes.length(), length - attributes.length());
+        }
+        if (readFormats) {
+            copyFormats(document, attributes, position, added);
+        }
+    });
+}
+
+QString formatAsHtml(const QString& text, const AttributeRuns& attributes) {
+    QString html;
+    html.reserve(text.size() + text.size() / 8);
+    QVector<TextFormatRun> runs = attributes.runs();
+    for (int i = 0; i < runs.size(); ++i) {
+        int start = runs[i].start;
+        int end = i + 1 < runs.size() ? runs[i + 1].start : text.size();
+        const TextStyle& style = runs[i].style;
+        if (style.color.isValid()) html += QString("<font color='%1'>").arg(style.color.name());
+        if (style.bold) html += "<b>";
+        if (style.italic) html += "<i>";
+        html += text.mid(start, end - start).toHtmlEscaped().replace('\n', "<br>");
+        if (style.italic) html += "</i>";
+        if (style.bold) html += "</b>";
+        if (style.color.isValid()) html += "</font>";
+    }
+    return html;
+}
+
+} // namespace
 
 SimpleTextEdit::SimpleTextEdit(QTextEdit* editor) : textEdit(editor) {
     if (!editor) {
         throw std::invalid_argument("Editor cannot be null");
     }
+    tracking = trackDocument(textEdit->document(), attributes, true, [this]() {
+        text.release();
+        formattedText.release();
+    });
+}
+
+SimpleTextEdit::~SimpleTextEdit() {
+    QObject::disconnect(tracking);
 }
 
 QString SimpleTextEdit::getText() {
-    return textEdit->toPlainText();
+    return text.get(revision(), [this]() { return textEdit->toPlainText(); });
 }
 
 void SimpleTextEdit::setText(const QString& text) {
@@ -16,110 +119,185 @@ void SimpleTextEdit::setText(const QString& text) {
 }
 
 QString SimpleTextEdit::getFormattedText() {
-    return textEdit->toHtml();
+    // Разметка строится только для новой ревизии, повторное сохранение ее не пересобирает
+    return formattedText.get(revision(), [this]() { return formatAsHtml(getText(), attributes); });
 }
 
-TextDecorator::TextDecorator(std::shared_ptr<TextComponent> component) 
-    : wrapped(component) {
-    if (!component) {
-        throw std::invalid_argument("Component cannot be null");
+AttributeRuns& SimpleTextEdit::getAttributes() {
+    return attributes;
+}
+
+void SimpleTextEdit::applyStyle(int start, int length, const AttributeRuns::StyleChange& change) {
+    int end = qMin(start + length, attributes.length());
+    if (start < 0 || start >= end) return;
+
+    // Стиль меняется в документе; отрезки обновит copyFormats, когда
+    // документ сообщит о правке в конце блока
+    QVector<TextFormatRun> runs = attributes.query(start, end - start);
+    QTextCursor cursor(textEdit->document());
+    cursor.beginEditBlock();
+    for (int i = 0; i < runs.size(); ++i) {
+        TextStyle style = runs[i].style;
+        change(style);
+        if (style == runs[i].style) continue;
+        cursor.setPosition(runs[i].start);
+        cursor.setPosition(i + 1 < runs.size() ? runs[i + 1].start : end, QTextCursor::KeepAnchor);
+        cursor.mergeCharFormat(formatOf(style));
     }
+    cursor.endEditBlock();
 }
 
-QString TextDecorator::getText() {
-    return wrapped->getText();
+quint64 SimpleTextEdit::revision() {
+    // Любая правка документа проходит через отрезки форматирования
+    return attributes.revision();
 }
 
-void TextDecorator::setText(const QString& text) {
-    wrapped->setText(text);
+qint64 SimpleTextEdit::cachedBytes() {
+    return text.memoryUsage() + formattedText.memoryUsage();
 }
 
-QString TextDecorator::getFormattedText() {
-    return wrapped->getFormattedText();
+SimplePlainTextEdit::SimplePlainTextEdit(QPlainTextEdit* editor) : plainTextEdit(editor) {
+    if (!editor) {
+        throw std::invalid_argument("Editor cannot be null");
+    }
+    tracking = trackDocument(plainTextEdit->document(), attributes, false, [this]() { text.release(); });
 }
 
-// ItalicDecorator implementation
-ItalicDecorator::ItalicDecorator(std::shared_ptr<TextComponent> component)
-    : TextDecorator(component) {}
+SimplePlainTextEdit::~SimplePlainTextEdit() {
+    QObject::disconnect(tracking);
+}
 
-QString ItalicDecorator::getText() {
-    return removeItalicTags(wrapped->getText());
+QString SimplePlainTextEdit::getText() {
+    return text.get(revision(), [this]() { return plainTextEdit->toPlainText(); });
 }
 
-void ItalicDecorator::setText(const QString& text) {
-    wrapped->setText(addItalicTags(text));
+void SimplePlainTextEdit::setText(const QString& text) {
+    plainTextEdit->setPlainText(text);
 }
 
-QString ItalicDecorator::getFormattedText() {
-    return addItalicTags(wrapped->getFormattedText());
+QString SimplePlainTextEdit::getFormattedText() {
+    return getText();
 }
 
-QString ItalicDecorator::addItalicTags(const QString& text) {
-    return QString("<i>%1</i>").arg(text);
+AttributeRuns& SimplePlainTextEdit::getAttributes() {
+    return attributes;
 }
 
-QString ItalicDecorator::removeItalicTags(const QString& text) {
-    QString result = text;
-    result.remove("<i>");
-    result.remove("</i>");
-    return result;
+void SimplePlainTextEdit::applyStyle(int start, int length, const AttributeRuns::StyleChange& change) {
+    // В простом тексте форматирования нет, стиль хранится только в отрезках
+    attributes.apply(start, length, change);
 }
 
-// ColorDecorator implementation
-ColorDecorator::ColorDecorator(std::shared_ptr<TextComponent> component, const QColor& color)
-    : TextDecorator(component), textColor(color) {}
+quint64 SimplePlainTextEdit::revision() {
+    return attributes.revision();
+}
 
-QString ColorDecorator::getText() {
-    return removeColorTags(wrapped->getText());
+qint64 SimplePlainTextEdit::cachedBytes() {
+    return text.memoryUsage();
 }
 
-void ColorDecorator::setText(const QString& text) {
-    wrapped->setText(addColorTags(text));
+VirtualTextComponent::VirtualTextComponent(VirtualTextView* view) : view(view), attributesRevision(0) {
+    if (!view) {
+        throw std::invalid_argument("View cannot be null");
+    }
 }
 
-QString ColorDecorator::getFormattedText() {
-    return addColorTags(wrapped->getFormattedText());
+QString VirtualTextComponent::getText() {
+    return text.get(revision(), [this]() { return view->buffer() ? view->buffer()->text() : QString(); });
 }
 
-QString ColorDecorator::addColorTags(const QString& text) {
-    return QString("<font color='%1'>%2</font>")
-        .arg(textColor.name())
-        .arg(text);
+void VirtualTextComponent::setText(const QString& text) {
+    view->setBuffer(std::make_shared<LineBuffer>(text.toUtf8()));
 }
 
-QString ColorDecorator::removeColorTags(const QString& text) {
-    QString result = text;
-    static QRegularExpression colorTagRegex("<font color='[^']*'>(.*?)</font>");
-    QRegularExpressionMatch match = colorTagRegex.match(result);
-    if (match.hasMatch()) {
-        result = match.captured(1);
+QString VirtualTextComponent::getFormattedText() {
+    return getText();
+}
+
+AttributeRuns& VirtualTextComponent::getAttributes() {
+    // Отрезки требуют длины в символах, а ее дает только полное декодирование
+    if (attributesRevision != revision()) {
+        attributes = AttributeRuns(getText().size());
+        attributesRevision = revision();
     }
-    return result;
+    return attributes;
 }
 
-// BoldDecorator implementation
-BoldDecorator::BoldDecorator(std::shared_ptr<TextComponent> component)
-    : TextDecorator(component) {}
+void VirtualTextComponent::applyStyle(int start, int length, const AttributeRuns::StyleChange& change) {
+    getAttributes().apply(start, length, change);
+}
+
+quint64 VirtualTextComponent::revision() {
+    return view->revision();
+}
+
+qint64 VirtualTextComponent::cachedBytes() {
+    return text.memoryUsage();
+}
+
+TextDecorator::TextDecorator(std::shared_ptr<TextComponent> component) 
+    : wrapped(component) {
+    if (!component) {
+        throw std::invalid_argument("Component cannot be null");
+    }
+}
+
+QString TextDecorator::getText() {
+    return wrapped->getText();
+}
+
+void TextDecorator::setText(const QString& text) {
+    wrapped->setText(text);
+    applyTo(0, getAttributes().length());
+}
+
+QString TextDecorator::getFormattedText() {
+    return wrapped->getFormattedText();
+}
+
+AttributeRuns& TextDecorator::getAttributes() {
+    return wrapped->getAttributes();
+}
+
+void TextDecorator::applyStyle(int start, int length, const AttributeRuns::StyleChange& change) {
+    wrapped->applyStyle(start, length, change);
+}
 
-QString BoldDecorator::getText() {
-    return removeBoldTags(wrapped->getText());
+quint64 TextDecorator::revision() {
+    return wrapped->revision();
 }
 
-void BoldDecorator::setText(const QString& text) {
-    wrapped->setText(addBoldTags(text));
+qint64 TextDecorator::cachedBytes() {
+    return wrapped->cachedBytes();
 }
 
-QString BoldDecorator::getFormattedText() {
-    return addBoldTags(wrapped->getFormattedText());
+void TextDecorator::applyTo(int start, int length) {
+    applyStyle(start, length, [this](TextStyle& style) { decorate(style); });
 }
 
-QString BoldDecorator::addBoldTags(const QString& text) {
-    return QString("<b>%1</b>").arg(text);
+void TextDecorator::decorate(TextStyle&) const {
 }
 
-QString BoldDecorator::removeBoldTags(const QString& text) {
-    QString result = text;
-    result.remove("<b>");
-    result.remove("</b>");
-    return result;
+// ItalicDecorator implementation
+ItalicDecorator::ItalicDecorator(std::shared_ptr<TextComponent> component)
+    : TextDecorator(component) {}
+
+void ItalicDecorator::decorate(TextStyle& style) const {
+    style.italic = true;
+}
+
+// ColorDecorator implementation
+ColorDecorator::ColorDecorator(std::shared_ptr<TextComponent> component, const QColor& color)
+    : TextDecorator(component), textColor(color) {}
+
+void ColorDecorator::decorate(TextStyle& style) const {
+    style.color = textColor;
+}
+
+// BoldDecorator implementation
+BoldDecorator::BoldDecorator(std::shared_ptr<TextComponent> component)
+    : TextDecorator(component) {}
+
+void BoldDecorator::decorate(TextStyle& style) const {
+    style.bold = true;
 }
@@ -1,5 +1,46 @@
 #include "TextIterator.hpp"
 
+namespace {
+
+struct AsciiSeparatorTable {
+    bool values[0x80];
+    AsciiSeparatorTable() {
+        for (int c = 0; c < 0x80; ++c) {
+            values[c] = QChar(c).isSpace() || QChar(c).isPunct();
+        }
+    }
+};
+
+} // namespace
+
+void TextCounter::feed(const QChar* data, int length) {
+    // Таблица для ASCII строится из тех же QChar::isSpace()/isPunct()
+    static const AsciiSeparatorTable table;
+    chars += length;
+    for (int i = 0; i < length; ++i) {
+        ushort c = data[i].unicode();
+        bool separator = c < 0x80 ? table.values[c] : (data[i].isSpace() || data[i].isPunct());
+        if (c == '\n') {
+            ++lines;
+        }
+        if (separator) {
+            if (inWord) {
+                ++words;
+                inWord = false;
+            }
+        } else {
+            inWord = true;
+        }
+    }
+}
+
+void TextCounter::finish() {
+    if (inWord) {
+        ++words;
+        inWord = false;
+    }
+}
+
 ConcreteTextAggregate::ConcreteTextAggregate(const QString& text) : text(text) {
     iterator = std::make_shared<ConcreteTextIterator>(text);
 }
@@ -30,24 +71,12 @@ void ConcreteTextIterator::setText(const QString& newText) {
 }
 
 void ConcreteTextIterator::updateCounts() {
-    charCount = 0;
-    wordCount = 0;
+    TextCounter counter;
+    counter.feed(text.constData(), text.size());
+    counter.finish();
+    charCount = static_cast<int>(counter.charCount());
+    wordCount = static_cast<int>(counter.wordCount());
     inWord = false;
-
-    for (const QChar& ch : text) {
-        charCount++;
-        if (ch.isSpace() || ch.isPunct()) {
-            if (inWord) {
-                wordCount++;
-                inWord = false;
-            }
-        } else {
-            inWord = true;
-        }
-    }
-    if (inWord) {
-        wordCount++;
-    }
 }
 
 bool ConcreteTextIterator::hasNext() {
@@ -0,0 +1,224 @@
+#include "TextSearch.hpp"
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+TextSearch::TextSearch(const QString& pattern, const SearchOptions& options)
+    : needle(pattern), settings(options), anchorOffset(0), anchorByte(0) {
+    if (pattern.isEmpty()) {
+        throw std::invalid_argument("Search pattern cannot be empty");
+    }
+
+    if (options.regularExpression) {
+        QRegularExpression::PatternOptions flags = QRegularExpression::MultilineOption;
+        if (!options.caseSensitive) flags |= QRegularExpression::CaseInsensitiveOption;
+        regex = QRegularExpression(pattern, flags);
+        if (!regex.isValid()) {
+            throw std::invalid_argument(regex.errorString().toStdString());
+        }
+        // Выражение ищется по многу раз в одном тексте
+        regex.optimize();
+    } else if (!options.caseSensitive) {
+        matcher = QStringMatcher(pattern, Qt::CaseInsensitive);
+    } else {
+        // Нулевой байт встречается в UTF-16 тексте из ASCII через один, поэтому
+        // memchr ищет ненулевой байт первой кодовой единицы
+        const char* first = reinterpret_cast<const char*>(needle.constData());
+        anchorOffset = first[0] == 0 ? 1 : 0;
+        anchorByte = first[anchorOffset];
+    }
+}
+
+int TextSearch::findLiteral(const QString& text, int from) const {
+    const int length = needle.size();
+    if (from < 0 || length > text.size() - from) return -1;
+
+    const char* bytes = reinterpret_cast<const char*>(text.constData());
+    const char* pattern = reinterpret_cast<const char*>(needle.constData());
+    const size_t patternBytes = size_t(length) * sizeof(QChar);
+    // Байты, в которых может оказаться якорь кандидата
+    const char* scan = bytes + qint64(from) * sizeof(QChar) + anchorOffset;
+    const char* last = bytes + qint64(text.size() - length) * sizeof(QChar) + anchorOffset;
+
+    while (scan <= last) {
+        const char* hit = static_cast<const char*>(std::memchr(scan, anchorByte, size_t(last - scan) + 1));
+        if (!hit) return -1;
+        const char* candidate = hit - anchorOffset;
+        if ((candidate - bytes) % qint64(sizeof(QChar)) != 0) {
+            // Байт из соседней кодовой единицы
+            scan = hit + 1;
+            continue;
+        }
+        if (std::memcmp(candidate, pattern, patternBytes) == 0) {
+            return static_cast<int>((candidate - bytes) / qint64(sizeof(QChar)));
+        }
+        scan = hit + sizeof(QChar);
+    }
+    return -1;
+}
+
+bool TextSearch::findNext(const QString& text, int from, SearchMatch& match) const {
+    if (from < 0 || from > text.size()) return false;
+
+    if (settings.regularExpression) {
+        QRegularExpressionMatch found = regex.match(text, from);
+        if (!found.hasMatch()) return false;
+        match = {found.capturedStart(), found.capturedLength()};
+        return true;
+    }
+
+    int start = settings.caseSensitive ? findLiteral(text, from) : matcher.indexIn(text, from);
+    if (start < 0) return false;
+    match = {start, needle.size()};
+    return true;
+}
+
+void TextSearch::forEachMatch(const QString& text, const std::function<bool(const SearchMatch&)>& visit) const {
+    if (settings.regularExpression) {
+        // globalMatch сам продвигается за совпадения нулевой длины
+        QRegularExpressionMatchIterator it = regex.globalMatch(text);
+        while (it.hasNext()) {
+            QRegularExpressionMatch found = it.next();
+            if (!visit({found.capturedStart(), found.capturedLength()})) return;
+        }
+        return;
+    }
+
+    SearchMatch match;
+    int from = 0;
+    while (findNext(text, from, match)) {
+        if (!visit(match)) return;
+        from = match.end();
+    }
+}
+
+QVector<SearchMatch> TextSearch::findAll(const QString& text) const {
+    QVector<SearchMatch> matches;
+    forEachMatch(text, [&matches](const SearchMatch& match) {
+        matches.append(match);
+        return true;
+    });
+    return matches;
+}
+
+namespace {
+
+// Подставляет группы совпадения в шаблон замены
+QString substitute(const QRegularExpressionMatch& found, const QString& replacement) {
+    QString result;
+    result.reserve(replacement.size());
+    for (int i = 0; i < replacement.size(); ++i) {
+        QChar ch = replacement[i];
+        if (ch != QLatin1Char('\\') || i + 1 == replacement.size()) {
+            result += ch;
+            continue;
+        }
+        QChar next = replacement[++i];
+        if (next.isDigit()) {
+            result += found.captured(next.digitValue());
+        } else if (next == QLatin1Char('n')) {
+            result += QLatin1Char('\n');
+        } else if (next == QLatin1Char('t')) {
+            result += QLatin1Char('\t');
+        } else {
+            result += next;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+QString TextSearch::expand(const QString& text, const SearchMatch& match, const QString& replacement) const {
+    if (!settings.regularExpression || !replacement.contains(QLatin1Char('\\'))) {
+        return replacement;
+    }
+    // Совпадение повторяется на своем месте, чтобы получить группы
+    return substitute(regex.match(text, match.start, QRegularExpression::NormalMatch,
+                                  QRegularExpression::AnchoredMatchOption), replacement);
+}
+
+QString TextSearch::replaceAll(const QString& text, const QString& replacement,
+                               QVector<Replacement>* replaced) const {
+    QString result;
+    // Замена обычно не меняет размер текста сильно; рост буфера остается амортизированным
+    result.reserve(text.size());
+    const QChar* data = text.constData();
+    int copied = 0;
+    auto append = [&](const SearchMatch& match, const QString& inserted) {
+        result.append(data + copied, match.start - copied);
+        if (replaced) replaced->append({result.size(), inserted.size(), match.length});
+        result += inserted;
+        copied = match.end();
+    };
+
+    if (settings.regularExpression && replacement.contains(QLatin1Char('\\'))) {
+        // Группы берутся из того же прохода, без повторного поиска каждого совпадения
+        QRegularExpressionMatchIterator it = regex.globalMatch(text);
+        while (it.hasNext()) {
+            QRegularExpressionMatch found = it.next();
+            append({found.capturedStart(), found.capturedLength()}, substitute(found, replacement));
+        }
+    } else {
+        forEachMatch(text, [&](const SearchMatch& match) {
+            append(match, replacement);
+            return true;
+        });
+    }
+    result.append(data + copied, text.size() - copied);
+    return result;
+}
+
+BackgroundSearch::BackgroundSearch(ResultHandler handler) : handler(std::move(handler)), generation(0) {
+    if (!this->handler) {
+        throw std::invalid_argument("Result handler cannot be null");
+    }
+}
+
+BackgroundSearch::~BackgroundSearch() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++generation;
+    threads.joinAll();
+}
+
+quint64 BackgroundSearch::start(const QString& text, const TextSearch& search) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Новое поколение останавливает предыдущий поиск на следующем совпадении
+    quint64 current = ++generation;
+    threads.start([this, text, search, current]() { run(text, search, current); });
+    return current;
+}
+
+void BackgroundSearch::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++generation;
+    threads.retire();
+}
+
+void BackgroundSearch::wait() {
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.wait();
+}
+
+void BackgroundSearch::run(QString text, TextSearch search, quint64 current) {
+    using Clock = std::chrono::steady_clock;
+    QVector<SearchMatch> batch;
+    batch.reserve(batchSize);
+    Clock::time_point lastDelivery = Clock::now();
+
+    search.forEachMatch(text, [&](const SearchMatch& match) {
+        if (generation.load(std::memory_order_relaxed) != current) return false;
+        batch.append(match);
+        if (batch.size() >= batchSize ||
+            Clock::now() - lastDelivery >= std::chrono::milliseconds(batchIntervalMs)) {
+            handler(current, batch, false);
+            batch.clear();
+            lastDelivery = Clock::now();
+        }
+        return true;
+    });
+
+    if (generation.load(std::memory_order_relaxed) == current) {
+        handler(current, batch, true);
+    }
+}
@@ -0,0 +1,150 @@
+#include "VirtualTextView.hpp"
+#include <QFontDatabase>
+#include <QKeyEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollBar>
+#include <QTextLine>
+#include <QtMath>
+#include <climits>
+
+namespace {
+
+const int margin = 4;
+// Ширина строки без переноса; QTextLayout хранит координаты в QFixed
+const qreal unboundedWidth = INT_MAX >> 8;
+// Грубая оценка памяти одной строки в кэше: текст, глифы и их позиции
+const qint64 layoutOverhead = 1024;
+
+} // namespace
+
+VirtualTextView::VirtualTextView(QWidget* parent)
+    : QAbstractScrollArea(parent), linesPerStep(1), widestLine(0), changes(0) {
+    layouts.setMaxCost(cacheCapacity);
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setBackgroundRole(QPalette::Base);
+}
+
+void VirtualTextView::setBuffer(std::shared_ptr<const LineBuffer> buffer) {
+    lineBuffer = std::move(buffer);
+    layouts.clear();
+    widestLine = 0;
+    ++changes;
+    updateScrollBars();
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    viewport()->update();
+}
+
+qint64 VirtualTextView::firstVisibleLine() const {
+    return qint64(verticalScrollBar()->value()) * linesPerStep;
+}
+
+int VirtualTextView::visibleLineCount() const {
+    return qMax(1, viewport()->height() / lineHeight());
+}
+
+void VirtualTextView::scrollToLine(qint64 line) {
+    verticalScrollBar()->setValue(static_cast<int>(qMax<qint64>(0, line) / linesPerStep));
+}
+
+qint64 VirtualTextView::memoryUsage() const {
+    return (lineBuffer ? lineBuffer->memoryUsage() : 0) + qint64(layouts.size()) * layoutOverhead;
+}
+
+int VirtualTextView::lineHeight() const {
+    return qMax(1, fontMetrics().lineSpacing());
+}
+
+void VirtualTextView::updateScrollBars() {
+    qint64 lineCount = lineBuffer ? lineBuffer->lineCount() : 0;
+    int rows = visibleLineCount();
+    qint64 lastFirstLine = qMax<qint64>(0, lineCount - rows);
+    // Значение полосы прокрутки - int, поэтому у очень длинных файлов шаг больше строки
+    linesPerStep = lastFirstLine / INT_MAX + 1;
+    verticalScrollBar()->setRange(0, static_cast<int>(lastFirstLine / linesPerStep));
+    verticalScrollBar()->setPageStep(qMax<qint64>(1, rows / linesPerStep));
+    verticalScrollBar()->setSingleStep(1);
+
+    int width = viewport()->width();
+    horizontalScrollBar()->setRange(0, qMax(0, widestLine - width));
+    horizontalScrollBar()->setPageStep(width);
+    horizontalScrollBar()->setSingleStep(qMax(1, fontMetrics().averageCharWidth()));
+}
+
+QTextLayout* VirtualTextView::layoutFor(qint64 line) {
+    if (QTextLayout* cached = layouts.object(line)) return cached;
+
+    auto* layout = new QTextLayout(lineBuffer->line(line), font());
+    QTextOption option;
+    option.setWrapMode(QTextOption::NoWrap);
+    layout->setTextOption(option);
+    // Форматированная раскладка глифов хранится вместе со строкой
+    layout->setCacheEnabled(true);
+    layout->beginLayout();
+    QTextLine textLine = layout->createLine();
+    if (textLine.isValid()) {
+        textLine.setLineWidth(unboundedWidth);
+        textLine.setPosition(QPointF(0, 0));
+    }
+    layout->endLayout();
+
+    int width = qCeil(textLine.isValid() ? textLine.naturalTextWidth() : 0) + 2 * margin;
+    if (width > widestLine) {
+        widestLine = width;
+        horizontalScrollBar()->setRange(0, qMax(0, widestLine - viewport()->width()));
+    }
+    layouts.insert(line, layout);
+    return layout;
+}
+
+void VirtualTextView::paintEvent(QPaintEvent* event) {
+    if (!lineBuffer) return;
+
+    QPainter painter(viewport());
+    painter.setPen(palette().color(QPalette::Text));
+    int height = lineHeight();
+    qint64 first = firstVisibleLine();
+    qreal left = margin - horizontalScrollBar()->value();
+
+    // Рисуются только строки, пересекающие обновляемую область
+    int firstRow = qMax(0, event->rect().top() / height);
+    int lastRow = event->rect().bottom() / height;
+    for (int row = firstRow; row <= lastRow; ++row) {
+        qint64 line = first + row;
+        if (line >= lineBuffer->lineCount()) break;
+        layoutFor(line)->draw(&painter, QPointF(left, qreal(row) * height));
+    }
+}
+
+void VirtualTextView::resizeEvent(QResizeEvent* event) {
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void VirtualTextView::changeEvent(QEvent* event) {
+    QAbstractScrollArea::changeEvent(event);
+    if (event->type() == QEvent::FontChange) {
+        // Раскладка зависит от шрифта
+        layouts.clear();
+        widestLine = 0;
+        updateScrollBars();
+        viewport()->update();
+    }
+}
+
+void VirtualTextView::keyPressEvent(QKeyEvent* event) {
+    if (event->matches(QKeySequence::MoveToStartOfDocument)) {
+        verticalScrollBar()->setValue(0);
+    } else if (event->matches(QKeySequence::MoveToEndOfDocument)) {
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+    } else {
+        QAbstractScrollArea::keyPressEvent(event);
+    }
+}
+
+void VirtualTextView::scrollContentsBy(int, int) {
+    // Содержимое не сдвигается попиксельно: новые строки берутся из кэша
+    viewport()->update();
+}
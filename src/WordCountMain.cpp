@@ -0,0 +1,101 @@
+#include "FileStatistics.hpp"
+#include "WorkStealingPool.hpp"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <cstdio>
+#include <vector>
+
+// Статистика файлов в стиле wc с определением слова из строки состояния
+// редактора: editor-wc [--threads N] [--chunk КБ] [--repeat N] <файлы...>
+// С --repeat N файлы считаются N раз, и выводится лучшее время прохода.
+
+namespace {
+
+struct FileResult {
+    FileStatistics statistics;
+    QString error;
+};
+
+void printRow(const FileStatistics& statistics, const QString& name) {
+    std::printf("%10lld %10lld %12lld %12lld %s\n", static_cast<long long>(statistics.lines),
+                static_cast<long long>(statistics.words), static_cast<long long>(statistics.chars),
+                static_cast<long long>(statistics.bytes), qPrintable(name));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("editor-wc");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Prints line, word, character and byte counts of UTF-8 files.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("files", "Files to count.", "<files...>");
+    QCommandLineOption threadsOption("threads", "Worker threads (default: all cores).", "count", "0");
+    QCommandLineOption chunkOption("chunk", "Kilobytes mapped and decoded at a time.", "KB", "1024");
+    QCommandLineOption repeatOption("repeat", "Count the files N times and report the best pass.", "N", "1");
+    parser.addOption(threadsOption);
+    parser.addOption(chunkOption);
+    parser.addOption(repeatOption);
+    parser.process(app);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.isEmpty()) {
+        parser.showHelp(1);
+    }
+    const int chunkSize = qMax(4, parser.value(chunkOption).toInt()) * 1024;
+    const int repeat = qMax(1, parser.value(repeatOption).toInt());
+
+    std::vector<FileResult> results(static_cast<size_t>(files.size()));
+    WorkStealingPool pool(parser.value(threadsOption).toInt());
+    qint64 bestMs = -1;
+
+    for (int pass = 0; pass < repeat; ++pass) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < files.size(); ++i) {
+            // Каждая задача пишет только в свою ячейку результатов
+            FileResult* result = &results[static_cast<size_t>(i)];
+            QString path = files[i];
+            pool.submit([result, path, chunkSize]() {
+                try {
+                    result->statistics = countFileStatistics(path, chunkSize);
+                } catch (const std::exception& e) {
+                    result->error = e.what();
+                }
+            });
+        }
+        pool.wait();
+        qint64 elapsed = timer.elapsed();
+        bestMs = bestMs < 0 ? elapsed : qMin(bestMs, elapsed);
+    }
+
+    FileStatistics total;
+    int failed = 0;
+    for (int i = 0; i < files.size(); ++i) {
+        const FileResult& result = results[static_cast<size_t>(i)];
+        if (!result.error.isEmpty()) {
+            std::fprintf(stderr, "editor-wc: %s\n", qPrintable(result.error));
+            ++failed;
+            continue;
+        }
+        printRow(result.statistics, files[i]);
+        total.bytes += result.statistics.bytes;
+        total.chars += result.statistics.chars;
+        total.words += result.statistics.words;
+        total.lines += result.statistics.lines;
+    }
+    if (files.size() > 1) {
+        printRow(total, "total");
+    }
+
+    if (repeat > 1) {
+        double seconds = bestMs / 1000.0;
+        std::printf("best of %d passes: %lld ms, %.1f MB/s on %d threads\n", repeat,
+                    static_cast<long long>(bestMs),
+                    seconds > 0 ? total.bytes / (1024.0 * 1024.0) / seconds : 0.0, pool.threadCount());
+    }
+    return failed == 0 ? 0 : 1;
+}
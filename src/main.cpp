@@ -1,5 +1,6 @@
 #include "MainWindow.hpp"
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QTextCodec>
 
 int main(int argc, char* argv[]) {
@@ -9,7 +10,17 @@ int main(int argc, char* argv[]) {
     #endif
 
     QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption hibernateOption("hibernate-after",
+        QCoreApplication::translate("main", "Hibernate tabs idle for <seconds>, 0 to keep all tabs loaded."),
+        "seconds", "600");
+    parser.addOption(hibernateOption);
+    parser.process(app);
+
     MainWindow* window = MainWindow::getInstance();
+    window->setHibernationDelay(parser.value(hibernateOption).toInt());
     window->show();
     return app.exec();
 }
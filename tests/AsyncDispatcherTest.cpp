@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include "AsyncDispatcher.hpp"
+#include <condition_variable>
+#include <thread>
+
+namespace {
+
+// Записывает доставленные правки; пока ворота закрыты, доставка ждет
+class GatedObserver : public IDocumentObserver {
+public:
+    void update(const QString&) override {}
+    void changed(const QVector<DocumentDelta>& deltas, const SnapshotSource&) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        ++entered;
+        entry.notify_all();
+        gate.wait(lock, [this] { return open; });
+        batches.append(deltas);
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        open = true;
+        gate.notify_all();
+    }
+
+    // Ждет, пока доставка первого события не займет поток
+    void waitEntered() {
+        std::unique_lock<std::mutex> lock(mutex);
+        entry.wait(lock, [this] { return entered > 0; });
+    }
+
+    std::mutex mutex;
+    std::condition_variable gate;
+    std::condition_variable entry;
+    bool open = false;
+    int entered = 0;
+    QVector<QVector<DocumentDelta>> batches;
+};
+
+QVector<DocumentDelta> typed(quint64 revision) {
+    return {DocumentDelta{revision, static_cast<int>(revision), 0, QStringLiteral("x")}};
+}
+
+} // namespace
+
+TEST(MpscQueueTest, KeepsEveryItemFromManyProducers) {
+    BoundedMpscQueue<int> queue(8);
+    EXPECT_EQ(queue.capacity(), 8);
+
+    const int producers = 4;
+    const int perProducer = 20000;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p] {
+            for (int i = 0; i < perProducer; ++i) {
+                int value = p * perProducer + i;
+                while (!queue.tryPush(std::move(value))) std::this_thread::yield();
+            }
+        });
+    }
+
+    // Порядок сохраняется внутри каждого производителя
+    std::vector<int> lastSeen(producers, -1);
+    int received = 0;
+    int value = 0;
+    while (received < producers * perProducer) {
+        if (!queue.tryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        int producer = value / perProducer;
+        ASSERT_GT(value % perProducer, lastSeen[producer]);
+        lastSeen[producer] = value % perProducer;
+        ++received;
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(queue.size(), 0);
+    EXPECT_FALSE(queue.tryPop(value));
+}
+
+TEST(AsyncDispatcherTest, BlockDeliversEverythingInOrder) {
+    SnapshotSource source;
+    AsyncDispatcher dispatcher(source, 2);
+    auto observer = std::make_shared<GatedObserver>();
+    observer->release();
+    dispatcher.subscribe(observer, BackpressurePolicy::Block, 2);
+
+    for (quint64 revision = 1; revision <= 200; ++revision) {
+        dispatcher.dispatch(typed(revision));
+    }
+    dispatcher.waitIdle();
+
+    ASSERT_EQ(observer->batches.size(), 200);
+    for (int i = 0; i < observer->batches.size(); ++i) {
+        EXPECT_EQ(observer->batches[i][0].revision, quint64(i + 1));
+    }
+    ObserverMetrics metrics = dispatcher.metrics(observer);
+    EXPECT_EQ(metrics.delivered, 200u);
+    EXPECT_EQ(metrics.dropped, 0u);
+    EXPECT_EQ(metrics.queueDepth, 0);
+    EXPECT_GE(metrics.maxLagUs, metrics.lastLagUs);
+}
+
+TEST(AsyncDispatcherTest, DropToLatestReplacesOverflowWithResync) {
+    SnapshotSource source;
+    AsyncDispatcher dispatcher(source, 2);
+    auto observer = std::make_shared<GatedObserver>();
+    dispatcher.subscribe(observer, BackpressurePolicy::DropToLatest, 2);
+
+    dispatcher.dispatch(typed(1));
+    observer->waitEntered();
+    // Очередь на два события; остальные заменяются одним перечитыванием
+    for (quint64 revision = 2; revision <= 10; ++revision) {
+        dispatcher.dispatch(typed(revision));
+    }
+    ObserverMetrics blocked = dispatcher.metrics(observer);
+    EXPECT_EQ(blocked.queueDepth, 3);
+    EXPECT_EQ(blocked.dropped, 7u);
+
+    observer->release();
+    dispatcher.waitIdle();
+
+    ASSERT_EQ(observer->batches.size(), 4);
+    EXPECT_EQ(observer->batches[1][0].revision, 2u);
+    EXPECT_EQ(observer->batches[2][0].revision, 3u);
+    const DocumentDelta& resync = observer->batches[3][0];
+    EXPECT_TRUE(resync.replacesAll());
+    EXPECT_EQ(resync.revision, 10u);
+    EXPECT_EQ(dispatcher.metrics(observer).delivered, 4u);
+}
+
+TEST(AsyncDispatcherTest, CoalesceMergesOverflowIntoOneEvent) {
+    SnapshotSource source;
+    AsyncDispatcher dispatcher(source, 2);
+    auto observer = std::make_shared<GatedObserver>();
+    dispatcher.subscribe(observer, BackpressurePolicy::Coalesce, 2);
+
+    dispatcher.dispatch(typed(1));
+    observer->waitEntered();
+    for (quint64 revision = 2; revision <= 10; ++revision) {
+        dispatcher.dispatch(typed(revision));
+    }
+    observer->release();
+    dispatcher.waitIdle();
+
+    // Ни одна правка не теряется, и порядок сохраняется
+    QVector<quint64> revisions;
+    for (const auto& batch : observer->batches) {
+        for (const auto& delta : batch) revisions.append(delta.revision);
+    }
+    ASSERT_EQ(revisions.size(), 10);
+    for (int i = 0; i < revisions.size(); ++i) {
+        EXPECT_EQ(revisions[i], quint64(i + 1));
+    }
+    EXPECT_EQ(observer->batches.size(), 4);
+    ObserverMetrics metrics = dispatcher.metrics(observer);
+    EXPECT_EQ(metrics.coalesced, 6u);
+    EXPECT_EQ(metrics.dropped, 0u);
+}
+
+TEST(AsyncDispatcherTest, SlowObserverDoesNotDelayOthers) {
+    SnapshotSource source;
+    AsyncDispatcher dispatcher(source, 2);
+    auto slow = std::make_shared<GatedObserver>();
+    auto fast = std::make_shared<GatedObserver>();
+    fast->release();
+    dispatcher.subscribe(slow, BackpressurePolicy::DropToLatest, 4);
+    dispatcher.subscribe(fast, BackpressurePolicy::Block, 4);
+
+    for (quint64 revision = 1; revision <= 50; ++revision) {
+        dispatcher.dispatch(typed(revision));
+    }
+    slow->waitEntered();
+    // Быстрый наблюдатель получает все, пока медленный стоит
+    while (dispatcher.metrics(fast).delivered < 50u) std::this_thread::yield();
+    EXPECT_EQ(fast->batches.size(), 50);
+
+    slow->release();
+    dispatcher.waitIdle();
+    EXPECT_EQ(slow->batches.last()[0].revision, 50u);
+}
+
+TEST(AsyncDispatcherTest, SubjectDeliversFlushedDeltasAsynchronously) {
+    DocumentSubject subject;
+    subject.setSnapshotProvider([] { return QStringLiteral("abc"); });
+    auto observer = std::make_shared<GatedObserver>();
+    observer->release();
+    subject.attachAsync(observer, BackpressurePolicy::Coalesce);
+
+    subject.post(0, 0, "a");
+    subject.post(1, 0, "b");
+    subject.flush();
+    subject.replaceAll();
+    subject.flush();
+    subject.waitForAsync();
+
+    ASSERT_EQ(observer->batches.size(), 2);
+    EXPECT_EQ(observer->batches[0][0].inserted.toStdString(), "ab");
+    EXPECT_TRUE(observer->batches[1][0].replacesAll());
+    EXPECT_EQ(subject.asyncMetrics(observer).delivered, 2u);
+
+    subject.detach(observer);
+    subject.post(2, 0, "c");
+    subject.flush();
+    subject.waitForAsync();
+    EXPECT_EQ(observer->batches.size(), 2);
+    EXPECT_EQ(subject.asyncMetrics(observer).delivered, 0u);
+}
+
+TEST(AsyncDispatcherTest, RejectsEmptyQueue) {
+    SnapshotSource source;
+    AsyncDispatcher dispatcher(source, 1);
+    EXPECT_THROW(dispatcher.subscribe(std::make_shared<GatedObserver>(), BackpressurePolicy::Block, 0),
+                 std::invalid_argument);
+}
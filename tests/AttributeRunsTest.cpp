@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "AttributeRuns.hpp"
+#include <random>
+#include <vector>
+
+namespace {
+
+TextStyle bold() {
+    TextStyle style;
+    style.bold = true;
+    return style;
+}
+
+// Стиль каждого символа: эталон для сравнения с деревом отрезков
+std::vector<TextStyle> expand(const AttributeRuns& attributes) {
+    std::vector<TextStyle> styles;
+    QVector<TextFormatRun> runs = attributes.runs();
+    for (int i = 0; i < runs.size(); ++i) {
+        int end = i + 1 < runs.size() ? runs[i + 1].start : attributes.length();
+        styles.insert(styles.end(), end - runs[i].start, runs[i].style);
+    }
+    return styles;
+}
+
+} // namespace
+
+TEST(AttributeRunsTest, ApplySplitsAndMergesRuns) {
+    AttributeRuns attributes(10);
+    attributes.setStyle(2, 3, bold());
+    QVector<TextFormatRun> runs = attributes.runs();
+    ASSERT_EQ(runs.size(), 3);
+    EXPECT_EQ(runs[1].start, 2);
+    EXPECT_TRUE(runs[1].style.bold);
+    EXPECT_EQ(runs[2].start, 5);
+
+    // Смежный отрезок того же стиля сливается с существующим
+    attributes.setStyle(5, 2, bold());
+    EXPECT_EQ(attributes.runCount(), 3);
+    attributes.setStyle(0, 10, TextStyle());
+    EXPECT_EQ(attributes.runCount(), 1);
+    EXPECT_EQ(attributes.length(), 10);
+}
+
+TEST(AttributeRunsTest, EditsShiftRuns) {
+    AttributeRuns attributes(6);
+    attributes.setStyle(2, 2, bold());
+    // Набранный текст продолжает стиль предыдущего символа
+    attributes.insert(4, 3);
+    EXPECT_TRUE(attributes.styleAt(6).bold);
+    EXPECT_FALSE(attributes.styleAt(7).bold);
+    attributes.remove(1, 5);
+    EXPECT_EQ(attributes.length(), 4);
+    EXPECT_TRUE(attributes.styleAt(1).bold);
+    attributes.edit(0, 100, 2);
+    EXPECT_EQ(attributes.length(), 2);
+    EXPECT_EQ(attributes.runCount(), 1);
+}
+
+TEST(AttributeRunsTest, QueryReturnsOverlappingRuns) {
+    QVector<TextFormatRun> source = {{3, bold()}, {6, TextStyle()}};
+    AttributeRuns attributes(source, 10);
+    QVector<TextFormatRun> runs = attributes.query(4, 4);
+    ASSERT_EQ(runs.size(), 2);
+    EXPECT_EQ(runs[0].start, 4);
+    EXPECT_TRUE(runs[0].style.bold);
+    EXPECT_EQ(runs[1].start, 6);
+    EXPECT_TRUE(attributes.query(20, 5).isEmpty());
+}
+
+TEST(AttributeRunsTest, MatchesPerCharacterModel) {
+    std::mt19937 random(7);
+    AttributeRuns attributes;
+    std::vector<TextStyle> expected;
+    for (int step = 0; step < 3000; ++step) {
+        int size = static_cast<int>(expected.size());
+        int position = std::uniform_int_distribution<int>(0, size)(random);
+        int count = std::uniform_int_distribution<int>(0, 20)(random);
+        TextStyle style;
+        style.bold = random() % 2;
+        style.italic = random() % 3 == 0;
+        switch (random() % 4) {
+        case 0: {
+            TextStyle inherited = expected.empty() ? TextStyle()
+                                                   : expected[position > 0 ? position - 1 : 0];
+            attributes.insert(position, count);
+            expected.insert(expected.begin() + position, count, inherited);
+            break;
+        }
+        case 1:
+            attributes.insert(position, count, style);
+            expected.insert(expected.begin() + position, count, style);
+            break;
+        case 2: {
+            int removed = std::min(count, size - position);
+            attributes.remove(position, count);
+            expected.erase(expected.begin() + position, expected.begin() + position + removed);
+            break;
+        }
+        default: {
+            int changed = std::min(count, size - position);
+            attributes.apply(position, count, [](TextStyle& current) { current.italic = !current.italic; });
+            for (int i = position; i < position + changed; ++i) {
+                expected[i].italic = !expected[i].italic;
+            }
+            break;
+        }
+        }
+        ASSERT_EQ(attributes.length(), static_cast<int>(expected.size()));
+    }
+    EXPECT_TRUE(expand(attributes) == expected);
+
+    // Соседние отрезки всегда различаются стилем
+    QVector<TextFormatRun> runs = attributes.runs();
+    for (int i = 1; i < runs.size(); ++i) {
+        EXPECT_TRUE(runs[i].style != runs[i - 1].style);
+    }
+}
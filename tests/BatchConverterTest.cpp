@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <atomic>
+#include "BatchConverter.hpp"
+#include "WorkStealingPool.hpp"
+
+TEST(WorkStealingPoolTest, RunsAllTasksIncludingNested) {
+    std::atomic<int> counter(0);
+    WorkStealingPool pool(4);
+    for (int i = 0; i < 100; ++i) {
+        pool.submit([&pool, &counter]() {
+            // Задачи, порожденные из рабочего потока, попадают в его очередь
+            pool.submit([&counter]() { ++counter; });
+            ++counter;
+        });
+    }
+    pool.wait();
+    EXPECT_EQ(counter.load(), 200);
+}
+
+TEST(WorkStealingPoolTest, SurvivesThrowingTasks) {
+    std::atomic<int> counter(0);
+    WorkStealingPool pool(2);
+    pool.submit([]() { throw std::runtime_error("failure"); });
+    pool.submit([&counter]() { ++counter; });
+    pool.wait();
+    EXPECT_EQ(counter.load(), 1);
+}
+
+class BatchConverterTest : public ::testing::Test {
+protected:
+    void writeFile(const QString& path, const QByteArray& content) {
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(content);
+    }
+
+    QString readFile(const QString& path) {
+        QFile file(path);
+        return file.open(QIODevice::ReadOnly) ? QString::fromUtf8(file.readAll()) : QString();
+    }
+
+    QTemporaryDir input;
+    QTemporaryDir output;
+};
+
+TEST_F(BatchConverterTest, ConvertsDirectoryTree) {
+    writeFile(input.filePath("page.html"), "<html><body><p>Hello</p><p>World</p></body></html>");
+    writeFile(input.filePath("sub/letter.rtf"), "{\\rtf1\\ansi {\\fonttbl{\\f0 Arial;}}Dear\\par friend}");
+    // Расширение не совпадает с содержимым
+    writeFile(input.filePath("sub/data.txt"), "<?xml version=\"1.0\"?><doc><p>one</p><p>two</p></doc>");
+
+    BatchOptions options;
+    options.inputDirectory = input.path();
+    options.outputDirectory = output.path();
+    options.targetFormat = DocumentFormat::PlainText;
+    options.threads = 3;
+    options.maxBytesInFlight = 64;
+
+    BatchResult result = BatchConverter(options).run();
+    EXPECT_EQ(result.converted, 3);
+    EXPECT_EQ(result.failed, 0);
+
+    EXPECT_EQ(readFile(output.filePath("page.txt")), "Hello\nWorld");
+    EXPECT_EQ(readFile(output.filePath("sub/letter.txt")), "Dear\nfriend");
+    EXPECT_EQ(readFile(output.filePath("sub/data.txt")), "one\ntwo");
+}
+
+TEST_F(BatchConverterTest, KeepsSourceExtensionWhenNamesCollide) {
+    writeFile(input.filePath("a.html"), "<html><body><p>html</p></body></html>");
+    writeFile(input.filePath("a.rtf"), "{\\rtf1\\ansi rtf}");
+    writeFile(input.filePath("a.txt"), "text");
+    writeFile(input.filePath("b.html"), "<html><body><p>alone</p></body></html>");
+
+    BatchOptions options;
+    options.inputDirectory = input.path();
+    options.outputDirectory = output.path();
+    options.targetFormat = DocumentFormat::PlainText;
+
+    BatchResult result = BatchConverter(options).run();
+    EXPECT_EQ(result.converted, 4);
+    EXPECT_EQ(readFile(output.filePath("a.html.txt")), "html");
+    EXPECT_EQ(readFile(output.filePath("a.rtf.txt")), "rtf");
+    EXPECT_EQ(readFile(output.filePath("a.txt.txt")), "text");
+    EXPECT_EQ(readFile(output.filePath("b.txt")), "alone");
+    EXPECT_FALSE(QFile::exists(output.filePath("a.txt")));
+}
+
+TEST_F(BatchConverterTest, ReportsFailuresAndMissingInput) {
+    writeFile(input.filePath("broken.xml"), "<?xml version=\"1.0\"?><doc><p>open</doc>");
+
+    BatchOptions options;
+    options.inputDirectory = input.path();
+    options.outputDirectory = output.path();
+    options.targetFormat = DocumentFormat::Html;
+
+    BatchResult result = BatchConverter(options).run();
+    EXPECT_EQ(result.converted, 0);
+    EXPECT_EQ(result.failed, 1);
+    ASSERT_EQ(result.errors.size(), 1);
+    EXPECT_TRUE(result.errors.first().contains("broken.xml"));
+
+    options.inputDirectory = input.filePath("missing");
+    EXPECT_THROW(BatchConverter(options).run(), std::runtime_error);
+}
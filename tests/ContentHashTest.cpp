@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "ContentHash.hpp"
+#include <QByteArray>
+#include <random>
+
+namespace {
+
+QString generateText(int length, unsigned seed) {
+    std::mt19937 random(seed);
+    const char* words[] = {"alpha ", "beta ", "gamma ", "delta\n", "epsilon ", "zeta, ", "eta. "};
+    QString text;
+    while (text.size() < length) {
+        text += QString::fromLatin1(words[random() % 7]);
+    }
+    text.truncate(length);
+    return text;
+}
+
+ContentHash::TextReader readerFor(const QString& text) {
+    return [&text](int start, int length) { return text.mid(start, length); };
+}
+
+// Применяет правку к тексту и к хэшу
+void applyEdit(QString& text, ContentHash& hash, int position, int removed, const QString& inserted) {
+    text.remove(position, removed);
+    text.insert(position, inserted);
+    hash.edit(position, removed, inserted.size(), text.size(), readerFor(text));
+}
+
+void expectSameChunks(const ContentHash& actual, const ContentHash& expected) {
+    ASSERT_EQ(actual.chunks().size(), expected.chunks().size());
+    for (int i = 0; i < actual.chunks().size(); ++i) {
+        EXPECT_EQ(actual.chunks()[i].start, expected.chunks()[i].start);
+        EXPECT_EQ(actual.chunks()[i].length, expected.chunks()[i].length);
+        EXPECT_EQ(actual.chunks()[i].hash, expected.chunks()[i].hash);
+    }
+    EXPECT_EQ(actual.documentHash(), expected.documentHash());
+}
+
+} // namespace
+
+TEST(ContentHashTest, MatchesReferenceXxh64) {
+    EXPECT_EQ(ContentHash::hashBytes("", 0), 0xEF46DB3751D8E999ULL);
+    EXPECT_EQ(ContentHash::hashBytes("abc", 3), 0x44BC2CF5AD770999ULL);
+    QByteArray text("Nobody inspects the spammish repetition");
+    EXPECT_EQ(ContentHash::hashBytes(text.constData(), text.size()), 0xFBCEA83C8A378BF1ULL);
+}
+
+TEST(ContentHashTest, ChunksCoverTextWithinLimits) {
+    QString text = generateText(200000, 1);
+    ContentHash hash(256, 1024, 4096);
+    hash.reset(text);
+
+    int expectedStart = 0;
+    for (int i = 0; i < hash.chunks().size(); ++i) {
+        const ContentHash::Chunk& chunk = hash.chunks()[i];
+        EXPECT_EQ(chunk.start, expectedStart);
+        EXPECT_LE(chunk.length, 4096);
+        if (i + 1 < hash.chunks().size()) {
+            EXPECT_GE(chunk.length, 256);
+        }
+        expectedStart += chunk.length;
+    }
+    EXPECT_EQ(expectedStart, text.size());
+    EXPECT_GT(hash.chunks().size(), 200000 / 4096);
+}
+
+TEST(ContentHashTest, IncrementalEditsMatchFullRehash) {
+    QString text = generateText(50000, 2);
+    ContentHash hash(64, 256, 1024);
+    hash.reset(text);
+
+    std::mt19937 random(3);
+    for (int step = 0; step < 300; ++step) {
+        int position = random() % (text.size() + 1);
+        int removed = qMin(static_cast<int>(random() % 300), text.size() - position);
+        QString inserted = step % 3 == 0 ? QString() : generateText(random() % 200, step);
+        applyEdit(text, hash, position, removed, inserted);
+
+        ContentHash reference(64, 256, 1024);
+        reference.reset(text);
+        expectSameChunks(hash, reference);
+    }
+}
+
+TEST(ContentHashTest, UndoingBackToSavedTextIsClean) {
+    QString text = generateText(100000, 4);
+    ContentHash hash(256, 1024, 4096);
+    hash.reset(text);
+    hash.markSaved();
+    EXPECT_FALSE(hash.isDirty());
+
+    applyEdit(text, hash, 5000, 0, QStringLiteral("typed"));
+    EXPECT_TRUE(hash.isDirty());
+    applyEdit(text, hash, 5000, 5, QString());
+    EXPECT_FALSE(hash.isDirty());
+    EXPECT_TRUE(hash.changedRegions().isEmpty());
+}
+
+TEST(ContentHashTest, DetectsChangesOnDisk) {
+    QString text = generateText(60000, 5);
+    ContentHash hash(256, 1024, 4096);
+    hash.reset(text);
+    hash.markSaved();
+
+    // Файл перезаписан тем же содержимым
+    EXPECT_TRUE(hash.matchesSaved(text));
+    QString changed = text;
+    changed[30000] = QLatin1Char('#');
+    EXPECT_FALSE(hash.matchesSaved(changed));
+}
+
+TEST(ContentHashTest, LocatesChangedRegions) {
+    QString text = generateText(200000, 6);
+    ContentHash hash(256, 1024, 4096);
+    hash.reset(text);
+    hash.markSaved();
+
+    applyEdit(text, hash, 20000, 10, QStringLiteral("first change"));
+    applyEdit(text, hash, 150000, 0, QStringLiteral("second change"));
+
+    QVector<ContentHash::Region> regions = hash.changedRegions();
+    ASSERT_EQ(regions.size(), 2);
+    EXPECT_LE(regions[0].start, 20000);
+    EXPECT_GE(regions[0].start + regions[0].length, 20012);
+    EXPECT_LE(regions[1].start, 150000);
+    EXPECT_GE(regions[1].start + regions[1].length, 150013);
+    // Остальной текст не попадает в измененные области
+    EXPECT_LT(regions[0].length + regions[1].length, 40000);
+}
+
+TEST(ContentHashTest, ReportsRemovedChunksAsEmptyRegion) {
+    QString text = generateText(100000, 7);
+    ContentHash hash(256, 1024, 4096);
+    hash.reset(text);
+    hash.markSaved();
+
+    // Удаление ровно по границам фрагментов не оставляет измененных фрагментов
+    const ContentHash::Chunk& removedChunk = hash.chunks()[5];
+    int start = removedChunk.start;
+    int length = removedChunk.length;
+    applyEdit(text, hash, start, length, QString());
+
+    EXPECT_TRUE(hash.isDirty());
+    QVector<ContentHash::Region> regions = hash.changedRegions();
+    ASSERT_EQ(regions.size(), 1);
+    EXPECT_EQ(regions[0].start, start);
+    EXPECT_EQ(regions[0].length, 0);
+}
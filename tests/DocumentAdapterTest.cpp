@@ -23,6 +23,32 @@ protected:
         EXPECT_EQ(actual.toStdString(), expected.toStdString());
     }
     
+    // Открывает source, сохраняет то, что прочитано, и открывает снова
+    void expectFormattingSurvivesSave(IDocumentAdapter& adapter, const QString& source, const QString& extension) {
+        QString sourcePath = QDir::tempPath() + "/formatted_source" + extension;
+        QString savedPath = QDir::tempPath() + "/formatted_saved" + extension;
+        QFile file(sourcePath);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(source.toUtf8());
+        file.close();
+
+        QVector<TextFormatRun> runs;
+        QString text = adapter.loadFormatted(sourcePath, runs);
+        ASSERT_FALSE(runs.isEmpty());
+        adapter.saveFormatted(savedPath, text, runs);
+        QVector<TextFormatRun> reloadedRuns;
+        expectStringsEqual(adapter.loadFormatted(savedPath, reloadedRuns), text);
+
+        ASSERT_EQ(reloadedRuns.size(), runs.size());
+        for (int i = 0; i < runs.size(); ++i) {
+            EXPECT_EQ(reloadedRuns[i].start, runs[i].start);
+            EXPECT_TRUE(reloadedRuns[i].style == runs[i].style) << "run " << i;
+        }
+
+        QFile::remove(sourcePath);
+        QFile::remove(savedPath);
+    }
+
     // Вспомогательная функция для очистки HTML
     QString cleanHtml(const QString& html) {
         QString result = html;
@@ -91,6 +117,39 @@ TEST_F(DocumentAdapterTest, XmlDocumentSaveAndLoad) {
     QFile::remove(tempPath);
 }
 
+TEST_F(DocumentAdapterTest, HtmlSaveEscapesParagraphs) {
+    QString tempPath = QDir::tempPath() + "/paragraphs.html";
+    
+    htmlAdapter->saveDocument(tempPath, QString::fromUtf8("a < b & \"c\"\n   \nТекст"));
+    QFile file(tempPath);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    QString saved = QString::fromUtf8(file.readAll());
+    file.close();
+    
+    EXPECT_TRUE(saved.contains("<p>a &lt; b &amp; &quot;c&quot;</p>\n<p>" + QString::fromUtf8("Текст") + "</p>"));
+    expectStringsEqual(htmlAdapter->loadDocument(tempPath), QString::fromUtf8("a < b & \"c\"\nТекст"));
+    
+    QFile::remove(tempPath);
+}
+
+TEST_F(DocumentAdapterTest, XmlParagraphsAndErrors) {
+    QString testContent = QString::fromUtf8("First & <second>\nВторой абзац\nThird");
+    QString tempPath = QDir::tempPath() + "/paragraphs.xml";
+    
+    EXPECT_NO_THROW({
+        xmlAdapter->saveDocument(tempPath, testContent);
+        expectStringsEqual(xmlAdapter->loadDocument(tempPath), testContent);
+    });
+    
+    QFile file(tempPath);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("<document><paragraph>broken</document>");
+    file.close();
+    EXPECT_THROW(xmlAdapter->loadDocument(tempPath), std::runtime_error);
+    
+    QFile::remove(tempPath);
+}
+
 TEST_F(DocumentAdapterTest, RtfDocumentSaveAndLoad) {
     QString testContent = "{\\rtf1\\ansi Test}";
     QString tempPath = QDir::tempPath() + "/test.rtf";
@@ -151,4 +210,11 @@ TEST_F(DocumentAdapterTest, FormatSpecificFeatures) {
         expectStringsEqual(cleanRtf(loadedRtfContent), "Bold and Italic");
     });
     QFile::remove(tempRtfPath);
-} 
\ No newline at end of file
+} 
+
+TEST_F(DocumentAdapterTest, RichFormatsKeepFormattingThroughSave) {
+    expectFormattingSurvivesSave(*htmlAdapter,
+        "<p>plain <b>bold <i>both</i></b></p>\n<p><font color=\"#ff0000\">red</font> end</p>", ".html");
+    expectFormattingSurvivesSave(*rtfAdapter,
+        "{\\rtf1{\\colortbl;\\red255\\green0\\blue0;}a\\b b\\b0 {\\i i}\\cf1 r\\plain p\\par\n\\b x}", ".rtf");
+}
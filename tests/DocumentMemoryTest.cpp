@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "DocumentObserver.hpp"
+#include "EditorState.hpp"
+#include "TextDecorator.hpp"
+#include <QSet>
+
+namespace {
+
+// Один документ и все, кто читает его текст, как во вкладке редактора
+struct DocumentHolders {
+    explicit DocumentHolders(int length)
+        : document(length, QLatin1Char('a')),
+          observer(std::make_shared<TextEditObserver>()) {
+        subject.setSnapshotProvider([this]() { return document; });
+        subject.attach(observer);
+        context.setTextProvider([this]() { return document; });
+    }
+
+    // Правка документа и уведомления о ней, как во вкладке редактора
+    void type(const QString& text, int position) {
+        document.insert(position, text);
+        subject.post(position, 0, text);
+        subject.flush();
+        context.recordEdit();
+    }
+
+    // Байты различных буферов, которые видят держатели текста
+    qint64 residentBytes() const {
+        QVector<QString> views = {
+            observer->getLastUpdate(),
+            context.currentText(),
+            subject.snapshots().snapshot()->text,
+        };
+        QSet<const QChar*> buffers;
+        qint64 bytes = 0;
+        for (const QString& view : views) {
+            if (!buffers.contains(view.constData())) {
+                buffers.insert(view.constData());
+                bytes += qint64(view.size()) * sizeof(QChar);
+            }
+        }
+        return bytes;
+    }
+
+    QString document;
+    DocumentSubject subject;
+    std::shared_ptr<TextEditObserver> observer;
+    EditorContext context;
+};
+
+} // namespace
+
+TEST(DocumentMemoryTest, HoldersShareOneCopyOfTheText) {
+    const int length = 1 << 20;
+    DocumentHolders holders(length);
+    holders.type(QStringLiteral("typed"), 100);
+    holders.type(QStringLiteral("more"), 5000);
+
+    qint64 textBytes = qint64(holders.document.size()) * sizeof(QChar);
+    // Наблюдатель, контекст и снимок держат один буфер
+    EXPECT_LE(holders.residentBytes(), textBytes * 5 / 4);
+    EXPECT_EQ(holders.observer->getLastUpdate().size(), length + 9);
+}
+
+TEST(DocumentMemoryTest, EditsReleasePreviousVersions) {
+    DocumentHolders holders(1 << 16);
+    holders.type(QStringLiteral("x"), 0);
+    holders.observer->getLastUpdate();
+
+    QString previous = holders.document;
+    EXPECT_FALSE(previous.isDetached());
+    holders.type(QStringLiteral("y"), 0);
+    holders.observer->getLastUpdate();
+    holders.context.requestEdit(holders.document);
+
+    // Прежнюю версию держит только эта проверка
+    EXPECT_TRUE(previous.isDetached());
+}
+
+TEST(DocumentMemoryTest, ObserverDropsPushedTextWhenDeltasArrive) {
+    DocumentHolders holders(1 << 16);
+    QString pushed = QString(1 << 16, QLatin1Char('b'));
+    holders.subject.notify(pushed);
+    EXPECT_FALSE(pushed.isDetached());
+
+    holders.type(QStringLiteral("z"), 0);
+    EXPECT_TRUE(pushed.isDetached());
+    EXPECT_EQ(holders.observer->getLastUpdate().at(0), QLatin1Char('z'));
+}
+
+TEST(DocumentMemoryTest, RevisionCacheKeepsOnlySmallTexts) {
+    RevisionCache cache;
+    QString small(1000, QLatin1Char('s'));
+    QString cached = cache.get(1, [&small]() { return small; });
+    // Кэш держит тот же буфер, что и документ, пока его не сбросили
+    EXPECT_EQ(cached.constData(), small.constData());
+    EXPECT_EQ(cache.memoryUsage(), qint64(small.capacity()) * 2);
+    cache.release();
+    EXPECT_EQ(cache.memoryUsage(), 0);
+
+    int builds = 0;
+    auto large = [&builds]() {
+        ++builds;
+        return QString(RevisionCache::maxLength + 1, QLatin1Char('l'));
+    };
+    QString first = cache.get(2, large);
+    EXPECT_TRUE(first.isDetached());
+    EXPECT_EQ(cache.memoryUsage(), 0);
+    // Большой текст строится заново при каждом чтении вместо второй постоянной копии
+    cache.get(2, large);
+    EXPECT_EQ(builds, 2);
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "DocumentObserver.hpp"
+
+namespace {
+
+class RecordingObserver : public IDocumentObserver {
+public:
+    void update(const QString& content) override { updates.append(content); }
+    void changed(const QVector<DocumentDelta>& deltas, const SnapshotSource&) override {
+        batches.append(deltas);
+    }
+
+    QVector<QString> updates;
+    QVector<QVector<DocumentDelta>> batches;
+};
+
+} // namespace
+
+TEST(DocumentObserverTest, CoalescesTypingBetweenFrames) {
+    DocumentSubject subject;
+    auto observer = std::make_shared<RecordingObserver>();
+    subject.attach(observer);
+
+    subject.post(0, 0, "a");
+    subject.post(1, 0, "b");
+    subject.post(2, 0, "c");
+    // Backspace стирает последний набранный символ
+    subject.post(2, 1, QString());
+    EXPECT_TRUE(observer->batches.isEmpty());
+
+    subject.flush();
+    ASSERT_EQ(observer->batches.size(), 1);
+    ASSERT_EQ(observer->batches[0].size(), 1);
+    const DocumentDelta& delta = observer->batches[0][0];
+    EXPECT_EQ(delta.position, 0);
+    EXPECT_EQ(delta.removed, 0);
+    EXPECT_EQ(delta.inserted.toStdString(), "ab");
+    EXPECT_EQ(delta.revision, 4u);
+
+    // Пустой кадр ничего не доставляет
+    subject.flush();
+    EXPECT_EQ(observer->batches.size(), 1);
+}
+
+TEST(DocumentObserverTest, KeepsSeparateEditsAndDeletions) {
+    DocumentSubject subject;
+    auto observer = std::make_shared<RecordingObserver>();
+    subject.attach(observer);
+
+    subject.post(10, 0, "x");
+    subject.post(11, 2, QString());  // Delete после вставки
+    subject.post(10, 1, QString());  // Backspace стирает вставку
+    subject.post(9, 1, QString());   // и символ перед ней
+    subject.post(40, 3, "yz");
+    subject.flush();
+
+    ASSERT_EQ(observer->batches.size(), 1);
+    ASSERT_EQ(observer->batches[0].size(), 2);
+    const DocumentDelta& merged = observer->batches[0][0];
+    EXPECT_EQ(merged.position, 9);
+    EXPECT_EQ(merged.removed, 3);
+    EXPECT_TRUE(merged.inserted.isEmpty());
+    EXPECT_EQ(observer->batches[0][1].position, 40);
+}
+
+TEST(DocumentObserverTest, SnapshotIsPulledOncePerRevision) {
+    DocumentSubject subject;
+    int reads = 0;
+    QString text = "hello";
+    subject.setSnapshotProvider([&]() {
+        ++reads;
+        return text;
+    });
+    auto first = std::make_shared<TextEditObserver>();
+    auto second = std::make_shared<TextEditObserver>();
+    subject.attach(first);
+    subject.attach(second);
+
+    subject.post(0, 0, "hello");
+    subject.flush();
+    // Доставка правок не читает документ
+    EXPECT_EQ(reads, 0);
+    EXPECT_EQ(first->getLastUpdate().toStdString(), "hello");
+    EXPECT_EQ(second->getLastUpdate().toStdString(), "hello");
+    EXPECT_EQ(reads, 1);
+    EXPECT_EQ(first->lastRevision(), 1u);
+
+    text = "hello!";
+    subject.post(5, 0, "!");
+    subject.flush();
+    EXPECT_EQ(second->getLastUpdate().toStdString(), "hello!");
+    EXPECT_EQ(reads, 2);
+}
+
+TEST(DocumentObserverTest, ReplaceAllDropsQueuedEdits) {
+    DocumentSubject subject;
+    auto observer = std::make_shared<RecordingObserver>();
+    subject.attach(observer);
+    subject.post(0, 0, "a");
+    subject.replaceAll();
+    subject.post(0, 0, "b");
+    subject.flush();
+
+    ASSERT_EQ(observer->batches.size(), 1);
+    ASSERT_EQ(observer->batches[0].size(), 2);
+    EXPECT_TRUE(observer->batches[0][0].replacesAll());
+    EXPECT_EQ(observer->batches[0][1].inserted.toStdString(), "b");
+
+    // Прежний путь с полным текстом по-прежнему работает
+    subject.notify("full");
+    ASSERT_EQ(observer->updates.size(), 1);
+    EXPECT_EQ(observer->updates[0].toStdString(), "full");
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include "EditJournal.hpp"
+
+class EditJournalTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        QStandardPaths::setTestModeEnabled(true);
+        QDir(EditJournal::journalDirectory()).removeRecursively();
+    }
+
+    void TearDown() override {
+        QDir(EditJournal::journalDirectory()).removeRecursively();
+    }
+
+    static QString noFileLoader(const QString&) {
+        throw std::runtime_error("Unexpected file load");
+    }
+};
+
+TEST_F(EditJournalTest, ReplaysEditsOnNewDocument) {
+    auto journal = EditJournal::create(QString());
+    journal->append(0, 0, "Hello World");
+    journal->append(5, 6, ", journal");
+    journal->append(0, 1, "h");
+    journal->flush();
+
+    EditJournal::Recovery recovery;
+    ASSERT_TRUE(EditJournal::recover(journal->path(), noFileLoader, recovery));
+    EXPECT_EQ(recovery.text, QString("hello, journal"));
+    EXPECT_EQ(recovery.replayedEdits, 3);
+}
+
+TEST_F(EditJournalTest, CheckpointBoundsReplay) {
+    auto journal = EditJournal::create(QString(), 2);
+    journal->append(0, 0, "abc");
+    journal->append(3, 0, "def");
+    EXPECT_TRUE(journal->needsCheckpoint());
+
+    journal->checkpoint("abcdef");
+    EXPECT_FALSE(journal->needsCheckpoint());
+    journal->append(6, 0, "!");
+    journal->flush();
+
+    EditJournal::Recovery recovery;
+    ASSERT_TRUE(EditJournal::recover(journal->path(), noFileLoader, recovery));
+    EXPECT_EQ(recovery.text, QString("abcdef!"));
+    EXPECT_EQ(recovery.replayedEdits, 1);
+}
+
+TEST_F(EditJournalTest, CleanCheckpointHasNothingToRecover) {
+    auto journal = EditJournal::create(QString());
+    journal->append(0, 0, "saved text");
+    journal->checkpoint("saved text", true);
+    journal->flush();
+
+    EditJournal::Recovery recovery;
+    EXPECT_FALSE(EditJournal::recover(journal->path(), noFileLoader, recovery));
+}
+
+TEST_F(EditJournalTest, UnusableJournalThrows) {
+    auto journal = EditJournal::create(QString());
+    journal->append(0, 0, "text");
+    journal->flush();
+
+    QFile file(journal->path());
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("not a journal");
+    file.close();
+
+    EditJournal::Recovery recovery;
+    EXPECT_THROW(EditJournal::recover(journal->path(), noFileLoader, recovery), std::runtime_error);
+    EXPECT_THROW(EditJournal::recover(journal->path() + ".missing", noFileLoader, recovery), std::runtime_error);
+}
+
+TEST_F(EditJournalTest, DiscardRemovesJournal) {
+    auto journal = EditJournal::create(QString());
+    journal->append(0, 0, "text");
+    journal->flush();
+    EXPECT_TRUE(QFile::exists(journal->path()));
+
+    journal->discard();
+    journal->flush();
+    EXPECT_FALSE(QFile::exists(journal->path()));
+    EXPECT_TRUE(EditJournal::pendingJournals().isEmpty());
+}
+
+TEST_F(EditJournalTest, TornTailIsIgnored) {
+    auto journal = EditJournal::create(QString());
+    journal->append(0, 0, "kept");
+    journal->flush();
+
+    QFile file(journal->path());
+    ASSERT_TRUE(file.open(QIODevice::Append));
+    file.write("\x03\x00\x00", 3);
+    file.close();
+
+    EditJournal::Recovery recovery;
+    ASSERT_TRUE(EditJournal::recover(journal->path(), noFileLoader, recovery));
+    EXPECT_EQ(recovery.text, QString("kept"));
+}
+
+TEST_F(EditJournalTest, RebaseStartsFromSavedFile) {
+    QString documentPath = QDir::tempPath() + "/rebased_document.txt";
+    auto journal = EditJournal::create(QString());
+    journal->append(0, 0, "saved");
+    journal->flush();
+
+    QFile document(documentPath);
+    ASSERT_TRUE(document.open(QIODevice::WriteOnly));
+    document.write("saved");
+    document.close();
+
+    // Сохранение не копирует текст в журнал: до следующей правки журнала нет
+    journal->rebase(documentPath);
+    journal->flush();
+    EXPECT_TRUE(EditJournal::pendingJournals().isEmpty());
+
+    journal->append(5, 0, "!");
+    journal->flush();
+    EditJournal::Recovery recovery;
+    ASSERT_TRUE(EditJournal::recover(journal->path(), [](const QString& path) {
+        QFile file(path);
+        return file.open(QIODevice::ReadOnly) ? QString::fromUtf8(file.readAll()) : QString();
+    }, recovery));
+    EXPECT_EQ(recovery.documentPath, documentPath);
+    EXPECT_EQ(recovery.text, QString("saved!"));
+    EXPECT_EQ(recovery.replayedEdits, 1);
+
+    QFile::remove(documentPath);
+}
@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 #include "EditorState.hpp"
+#include "EditJournal.hpp"
+#include <QDir>
+#include <QStandardPaths>
+#include <QVector>
 
 class EditorStateTest : public ::testing::Test {
 protected:
@@ -73,4 +77,108 @@ TEST_F(EditorStateTest, AutoSaving) {
     QString status = context->getStatus();
     EXPECT_TRUE(status == "Document modified (auto-save pending)" || 
                 status == "Document auto-saved");
-} 
\ No newline at end of file
+} 
+namespace {
+
+class CountingStateObserver : public IStateObserver {
+public:
+    void onStateChanged(const QString& newState) override { states.append(newState); }
+    QVector<QString> states;
+};
+
+} // namespace
+
+// Тест отслеживания изменений по ревизиям
+TEST_F(EditorStateTest, RevisionDirtyTracking) {
+    EXPECT_FALSE(context->isDirty());
+
+    context->recordEdit();
+    context->recordEdit();
+    EXPECT_TRUE(context->isDirty());
+    EXPECT_EQ(context->getRevision(), 2u);
+    EXPECT_EQ(context->getStatus(), "Modified");
+
+    context->markSaved();
+    EXPECT_FALSE(context->isDirty());
+    EXPECT_EQ(context->getSavedRevision(), 2u);
+    EXPECT_EQ(context->getStatus(), "Saved");
+
+    // Отмена до точки сохранения снова делает документ сохраненным
+    context->recordEdit();
+    EXPECT_TRUE(context->isDirty());
+    context->markSaved();
+    EXPECT_FALSE(context->isDirty());
+    EXPECT_EQ(context->getRevision(), 3u);
+}
+
+// Тест уведомлений только о реальных переходах
+TEST_F(EditorStateTest, NotifiesOnlyOnTransitions) {
+    auto observer = std::make_shared<CountingStateObserver>();
+    context->addStateObserver(observer);
+
+    for (int i = 0; i < 100; ++i) {
+        context->recordEdit();
+    }
+    ASSERT_EQ(observer->states.size(), 1);
+    EXPECT_EQ(observer->states[0], "Modified");
+
+    context->requestSave();
+    ASSERT_EQ(observer->states.size(), 2);
+    EXPECT_EQ(observer->states[1], "Document saved successfully");
+    EXPECT_FALSE(context->isDirty());
+
+    // Повторное сохранение меняет только статус
+    context->requestSave();
+    EXPECT_EQ(observer->states.size(), 3);
+    context->requestSave();
+    EXPECT_EQ(observer->states.size(), 3);
+}
+
+// Тест общих экземпляров состояний
+TEST_F(EditorStateTest, StatesAreShared) {
+    EditorContext other;
+    context->recordEdit();
+    other.recordEdit();
+    EXPECT_EQ(SavedState::getInstance(), SavedState::getInstance());
+    EXPECT_EQ(ModifiedState::getInstance(), ModifiedState::getInstance());
+    EXPECT_EQ(context->getStatus(), other.getStatus());
+
+    // Автосохранение хранит время снимка в контексте, а не в состоянии
+    context->setState(AutoSavingState::getInstance());
+    other.setState(AutoSavingState::getInstance());
+    context->requestEdit("first");
+    other.requestEdit("second");
+    EXPECT_EQ(context->getStatus(), "Document auto-saved");
+    EXPECT_EQ(other.getStatus(), "Document auto-saved");
+}
+
+// Тест автосохранения измененного документа в журнал
+TEST_F(EditorStateTest, DirtyContextCheckpointsJournalOnTick) {
+    QStandardPaths::setTestModeEnabled(true);
+    auto journal = EditJournal::create(QString(), 2);
+    context->setJournal(journal);
+    context->setTextProvider([]() { return QString("abcdef"); });
+
+    context->recordEdit();
+    EXPECT_EQ(context->getStatus(), "AutoSaving");
+    journal->append(0, 0, "abc");
+    context->requestTick();
+    EXPECT_EQ(context->getStatus(), "AutoSaving");
+
+    // Снимок пишется, когда правок накопилось на интервал
+    journal->append(3, 0, "def");
+    context->requestTick();
+    EXPECT_EQ(context->getStatus(), "Document auto-saved");
+    EXPECT_FALSE(journal->needsCheckpoint());
+    journal->flush();
+
+    EditJournal::Recovery recovery;
+    ASSERT_TRUE(EditJournal::recover(journal->path(), [](const QString&) { return QString(); }, recovery));
+    EXPECT_EQ(recovery.text, QString("abcdef"));
+    EXPECT_EQ(recovery.replayedEdits, 0);
+
+    context->requestSave();
+    EXPECT_FALSE(context->isDirty());
+    EXPECT_EQ(context->getStatus(), "Document saved successfully");
+    QDir(EditJournal::journalDirectory()).removeRecursively();
+}
@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <mutex>
+#include <tuple>
+#include "FileSearch.hpp"
+
+class FileSearchTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        search = std::make_unique<FileSearch>(
+            [this](quint64 generation, const QVector<FileMatch>& batch) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (generation == expected) found += batch;
+            },
+            [this](quint64 generation, const FileSearchSummary& result) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (generation == expected) {
+                    summary = result;
+                    ++finished;
+                }
+            });
+    }
+
+    // Отмененный поиск может еще работать и обращаться к полям теста
+    void TearDown() override {
+        search.reset();
+    }
+
+    void writeFile(const QString& path, const QByteArray& content) {
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(content);
+    }
+
+    // Запускает поиск и ждет его окончания; совпадения сортируются по файлу и позиции
+    void run(const QString& pattern, const SearchOptions& options = SearchOptions(),
+             const QVector<OpenBuffer>& buffers = QVector<OpenBuffer>(), FileSearchOptions where = FileSearchOptions()) {
+        if (where.directories.isEmpty()) where.directories.append(directory.path());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            found.clear();
+            finished = 0;
+            expected = search->start(buffers, where, TextSearch(pattern, options));
+        }
+        search->wait();
+        std::sort(found.begin(), found.end(), [](const FileMatch& a, const FileMatch& b) {
+            return std::tie(a.path, a.line, a.column) < std::tie(b.path, b.line, b.column);
+        });
+    }
+
+    QString relative(const FileMatch& match) const {
+        return QDir(directory.path()).relativeFilePath(match.path);
+    }
+
+    QTemporaryDir directory;
+    std::unique_ptr<FileSearch> search;
+    std::mutex mutex;
+    quint64 expected = 0;
+    QVector<FileMatch> found;
+    FileSearchSummary summary;
+    int finished = 0;
+};
+
+TEST_F(FileSearchTest, FindsMatchesInDirectoryTree) {
+    writeFile(directory.filePath("a.txt"), "one needle\ntwo\nneedle needle\n");
+    writeFile(directory.filePath("sub/deep/b.txt"), "no match here\r\n  needle\r\n");
+    writeFile(directory.filePath("sub/c.txt"), "nothing");
+
+    run("needle");
+    ASSERT_EQ(found.size(), 4);
+    EXPECT_EQ(relative(found[0]), QString("a.txt"));
+    EXPECT_EQ(found[0].line, 1);
+    EXPECT_EQ(found[0].column, 4);
+    EXPECT_EQ(found[0].length, 6);
+    EXPECT_EQ(found[0].buffer, -1);
+    EXPECT_EQ(found[0].preview, QString("one needle"));
+    EXPECT_EQ(found[1].line, 3);
+    EXPECT_EQ(found[2].column, 7);
+    EXPECT_EQ(relative(found[3]), QString("sub/deep/b.txt"));
+    EXPECT_EQ(found[3].line, 2);
+    EXPECT_EQ(found[3].column, 2);
+    EXPECT_EQ(found[3].preview, QString("  needle"));
+
+    EXPECT_EQ(finished, 1);
+    EXPECT_EQ(summary.files, 3);
+    EXPECT_EQ(summary.matches, 4);
+    EXPECT_FALSE(summary.truncated);
+}
+
+TEST_F(FileSearchTest, CountsColumnsInUtf16) {
+    writeFile(directory.filePath("utf8.txt"), QString::fromUtf8("мир \xF0\x9F\x98\x80 мир").toUtf8());
+
+    run(QString::fromUtf8("мир"));
+    ASSERT_EQ(found.size(), 2);
+    EXPECT_EQ(found[0].column, 0);
+    // Эмодзи занимает суррогатную пару
+    EXPECT_EQ(found[1].column, 7);
+}
+
+TEST_F(FileSearchTest, DecodesFilesForOtherModes) {
+    writeFile(directory.filePath("mixed.txt"), "Alpha\nalpha beta\nALPHA");
+
+    SearchOptions ignoreCase;
+    ignoreCase.caseSensitive = false;
+    run("alpha", ignoreCase);
+    ASSERT_EQ(found.size(), 3);
+    EXPECT_EQ(found[2].line, 3);
+
+    SearchOptions regex;
+    regex.regularExpression = true;
+    run("^\\w+ (\\w+)$", regex);
+    ASSERT_EQ(found.size(), 1);
+    EXPECT_EQ(found[0].line, 2);
+    EXPECT_EQ(found[0].length, 10);
+}
+
+TEST_F(FileSearchTest, PreviewsFollowLineBreaks) {
+    writeFile(directory.filePath("lines.txt"), "a needle and a needle\nneedle\n");
+
+    SearchOptions ignoreCase;
+    ignoreCase.caseSensitive = false;
+    // Поиск по байтам и по декодированному тексту
+    for (const SearchOptions& options : {SearchOptions(), ignoreCase}) {
+        run("needle", options);
+        ASSERT_EQ(found.size(), 3);
+        EXPECT_EQ(found[0].preview, QString("a needle and a needle"));
+        EXPECT_EQ(found[1].preview, QString("a needle and a needle"));
+        EXPECT_EQ(found[2].line, 2);
+        EXPECT_EQ(found[2].preview, QString("needle"));
+    }
+}
+
+TEST_F(FileSearchTest, SkipsBinaryAndHiddenFiles) {
+    writeFile(directory.filePath("text.txt"), "needle");
+    writeFile(directory.filePath("image.bin"), QByteArray("needle\0needle", 13));
+    writeFile(directory.filePath(".git/objects/pack.txt"), "needle");
+
+    run("needle");
+    ASSERT_EQ(found.size(), 1);
+    EXPECT_EQ(relative(found[0]), QString("text.txt"));
+    EXPECT_EQ(summary.binaryFiles, 1);
+}
+
+TEST_F(FileSearchTest, AppliesNameFilters) {
+    writeFile(directory.filePath("code.cpp"), "needle");
+    writeFile(directory.filePath("notes.txt"), "needle");
+
+    FileSearchOptions where;
+    where.nameFilters.append("*.cpp");
+    run("needle", SearchOptions(), QVector<OpenBuffer>(), where);
+    ASSERT_EQ(found.size(), 1);
+    EXPECT_EQ(relative(found[0]), QString("code.cpp"));
+}
+
+TEST_F(FileSearchTest, SearchesOpenBuffersInsteadOfTheirFiles) {
+    writeFile(directory.filePath("open.txt"), "needle on disk");
+    writeFile(directory.filePath("closed.txt"), "needle");
+
+    QVector<OpenBuffer> buffers;
+    buffers.append({QFileInfo(directory.filePath("open.txt")).absoluteFilePath(), "edited\nneedle in editor"});
+    buffers.append({"Untitled", "needle"});
+    run("needle", SearchOptions(), buffers);
+
+    ASSERT_EQ(found.size(), 3);
+    int fromBuffers = 0;
+    for (const FileMatch& match : found) {
+        if (match.buffer == 0) {
+            EXPECT_EQ(match.line, 2);
+            EXPECT_EQ(match.preview, QString("needle in editor"));
+        }
+        fromBuffers += match.buffer >= 0;
+    }
+    EXPECT_EQ(fromBuffers, 2);
+}
+
+TEST_F(FileSearchTest, StopsAtMatchLimit) {
+    QByteArray content;
+    for (int i = 0; i < 1000; ++i) {
+        content += "needle\n";
+    }
+    writeFile(directory.filePath("many.txt"), content);
+
+    FileSearchOptions where;
+    where.maxMatches = 100;
+    run("needle", SearchOptions(), QVector<OpenBuffer>(), where);
+    EXPECT_EQ(found.size(), 100);
+    EXPECT_TRUE(summary.truncated);
+    EXPECT_EQ(summary.matches, 100);
+}
+
+TEST_F(FileSearchTest, RestartsAfterCancel) {
+    for (int i = 0; i < 20; ++i) {
+        writeFile(directory.filePath(QString("file%1.txt").arg(i)), "needle\n");
+    }
+    FileSearchOptions where;
+    where.directories.append(directory.path());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        expected = search->start(QVector<OpenBuffer>(), where, TextSearch("needle"));
+    }
+    search->cancel();
+    search->wait();
+    // Поиск мог успеть закончиться до отмены, но его итог приходит не больше одного раза
+    EXPECT_LE(finished, 1);
+
+    run("needle");
+    EXPECT_EQ(found.size(), 20);
+    EXPECT_EQ(finished, 1);
+}
+
+TEST(FileSearchBinaryTest, DetectsZeroBytes) {
+    EXPECT_FALSE(FileSearch::isBinary("plain text", 10));
+    EXPECT_TRUE(FileSearch::isBinary("PK\0\3", 4));
+    EXPECT_FALSE(FileSearch::isBinary("", 0));
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <QDir>
+#include <QFile>
+#include "FileStatistics.hpp"
+#include "TextIterator.hpp"
+
+class FileStatisticsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = QDir::tempPath() + "/statistics_test.txt";
+        text = QString::fromUtf8("Привет, мир! Hello,world\n"
+                                 "  tabs\tand 😀 emoji...\nlast-line words");
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(text.toUtf8());
+    }
+
+    void TearDown() override {
+        QFile::remove(path);
+    }
+
+    QString path;
+    QString text;
+};
+
+TEST_F(FileStatisticsTest, MatchesEditorCountsForAnyChunkSize) {
+    ConcreteTextIterator iterator(text);
+
+    // Маленькие окна разрезают и слова, и многобайтовые последовательности UTF-8
+    for (int chunkSize : {1, 3, 7, 64, 1 << 20}) {
+        FileStatistics statistics = countFileStatistics(path, chunkSize);
+        EXPECT_EQ(statistics.chars, iterator.getCharCount()) << chunkSize;
+        EXPECT_EQ(statistics.words, iterator.getWordCount()) << chunkSize;
+        EXPECT_EQ(statistics.lines, 2) << chunkSize;
+        EXPECT_EQ(statistics.bytes, text.toUtf8().size()) << chunkSize;
+    }
+}
+
+TEST_F(FileStatisticsTest, CounterCarriesWordsAcrossChunks) {
+    TextCounter counter;
+    QString first = "split wo";
+    QString second = "rd here";
+    counter.feed(first.constData(), first.size());
+    counter.feed(second.constData(), second.size());
+    counter.finish();
+    EXPECT_EQ(counter.wordCount(), 3);
+    EXPECT_EQ(counter.charCount(), 15);
+}
+
+TEST_F(FileStatisticsTest, MissingFileThrows) {
+    EXPECT_THROW(countFileStatistics(QDir::tempPath() + "/missing_statistics.txt"), std::runtime_error);
+}
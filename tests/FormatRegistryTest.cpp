@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <QDir>
+#include <QFile>
+#include "FormatRegistry.hpp"
+
+class FormatRegistryTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        for (const QString& path : created) {
+            QFile::remove(path);
+        }
+    }
+
+    QString writeFile(const QString& name, const QByteArray& content) {
+        QString path = QDir::tempPath() + "/" + name;
+        QFile file(path);
+        file.open(QIODevice::WriteOnly);
+        file.write(content);
+        file.close();
+        created.append(path);
+        return path;
+    }
+
+    DocumentFormat detect(const QString& path) {
+        return FormatRegistry::getInstance().detect(path).format;
+    }
+
+    QStringList created;
+};
+
+TEST_F(FormatRegistryTest, ContentWinsOverExtension) {
+    EXPECT_EQ(detect(writeFile("page.txt", "\n  <!DOCTYPE html><html></html>")), DocumentFormat::Html);
+    EXPECT_EQ(detect(writeFile("notes", "{\\rtf1\\ansi Text}")), DocumentFormat::Rtf);
+    EXPECT_EQ(detect(writeFile("data.log", "<?xml version=\"1.0\"?><root/>")), DocumentFormat::Xml);
+    EXPECT_EQ(detect(writeFile("page.xml", "<?xml version=\"1.0\"?>\n<html xmlns=\"x\"></html>")),
+              DocumentFormat::Html);
+}
+
+TEST_F(FormatRegistryTest, ByteOrderMarks) {
+    EXPECT_EQ(detect(writeFile("bom.txt", "\xEF\xBB\xBF<HTML><body/></HTML>")), DocumentFormat::Html);
+    EXPECT_EQ(detect(writeFile("utf16.txt", QByteArray("\xFF\xFE{\0\\\0r\0t\0f\0", 12))), DocumentFormat::Rtf);
+}
+
+TEST_F(FormatRegistryTest, FallsBackToExtension) {
+    EXPECT_EQ(detect(writeFile("plain.html", "just text")), DocumentFormat::Html);
+    EXPECT_EQ(detect(writeFile("empty.rtf", "")), DocumentFormat::Rtf);
+    EXPECT_EQ(detect(writeFile("server.log", "<not markup>")), DocumentFormat::PlainText);
+    EXPECT_EQ(detect(QDir::tempPath() + "/missing.XML"), DocumentFormat::Xml);
+}
+
+TEST_F(FormatRegistryTest, AdaptersAreSharedAndCapabilitiesSet) {
+    FormatRegistry& registry = FormatRegistry::getInstance();
+    EXPECT_EQ(registry.forExtension("a.html").adapter, registry.forExtension("b.htm").adapter);
+    EXPECT_TRUE(registry.info(DocumentFormat::Rtf).has(FormatInfo::RichText));
+    EXPECT_FALSE(registry.info(DocumentFormat::Xml).has(FormatInfo::RichText));
+    EXPECT_TRUE(registry.info(DocumentFormat::Html).has(FormatInfo::RichText));
+}
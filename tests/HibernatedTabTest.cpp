@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "HibernatedTab.hpp"
+#include <stdexcept>
+
+namespace {
+
+QString generateText(int lines) {
+    QString text;
+    for (int i = 0; i < lines; ++i) {
+        text += QString("%1 Lorem ipsum dolor sit amet, consectetur adipiscing elit\n").arg(i);
+    }
+    return text;
+}
+
+} // namespace
+
+TEST(HibernatedTabTest, FileTabKeepsOnlyThePath) {
+    HibernatedTab tab = HibernatedTab::fromFile("/tmp/notes.txt");
+    EXPECT_FALSE(tab.hasText());
+    EXPECT_EQ(tab.filePath(), QString("/tmp/notes.txt"));
+    EXPECT_TRUE(tab.text().isEmpty());
+}
+
+TEST(HibernatedTabTest, FileTabRequiresPath) {
+    EXPECT_THROW(HibernatedTab::fromFile(QString()), std::invalid_argument);
+}
+
+TEST(HibernatedTabTest, TextRoundTrips) {
+    QString text = generateText(200) + QString::fromUtf8("Привет, мир \xF0\x9F\x98\x80");
+    HibernatedTab tab = HibernatedTab::fromText(text);
+    EXPECT_TRUE(tab.hasText());
+    EXPECT_EQ(tab.textLength(), text.size());
+    EXPECT_EQ(tab.text(), text);
+}
+
+TEST(HibernatedTabTest, EmptyTextRoundTrips) {
+    HibernatedTab tab = HibernatedTab::fromText(QString());
+    EXPECT_TRUE(tab.hasText());
+    EXPECT_TRUE(tab.text().isEmpty());
+}
+
+TEST(HibernatedTabTest, KeepsFormatRuns) {
+    QVector<TextFormatRun> runs;
+    TextStyle bold;
+    bold.bold = true;
+    RichTextBuilder::addRun(runs, 0, TextStyle());
+    RichTextBuilder::addRun(runs, 5, bold);
+    HibernatedTab tab = HibernatedTab::fromText("plainbold", runs);
+    ASSERT_EQ(tab.runs().size(), 2);
+    EXPECT_EQ(tab.runs()[1].start, 5);
+    EXPECT_TRUE(tab.runs()[1].style.bold);
+}
+
+TEST(HibernatedTabTest, CompressedTextIsSmallerThanDocument) {
+    QString text = generateText(10000);
+    HibernatedTab tab = HibernatedTab::fromText(text);
+    EXPECT_LT(tab.memoryUsage(), qint64(text.size()) * 2 / 4);
+}
+
+TEST(HibernatedTabTest, KeepsCursorAndScroll) {
+    HibernatedTab tab = HibernatedTab::fromText("text");
+    tab.cursorPosition = 3;
+    tab.scrollPosition = 40;
+    HibernatedTab copy = tab;
+    EXPECT_EQ(copy.cursorPosition, 3);
+    EXPECT_EQ(copy.scrollPosition, 40);
+    EXPECT_EQ(copy.text(), QString("text"));
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "HtmlTokenizer.hpp"
+
+namespace {
+
+std::string plain(const QString& html) {
+    return HtmlTokenizer::toPlainText(html).toStdString();
+}
+
+} // namespace
+
+TEST(HtmlTokenizerTest, StripsTagsAndCollapsesWhitespace) {
+    EXPECT_EQ(plain("<b>Bold</b>   and\n\t<i>Italic</i>"), "Bold and Italic");
+    EXPECT_EQ(plain("  <span> padded </span>  "), "padded");
+}
+
+TEST(HtmlTokenizerTest, SkipsCommentsDoctypeAndRawText) {
+    QString html = "<!DOCTYPE html><!-- <p>hidden</p> -->"
+                   "<style>p > b { color: red; }</style>"
+                   "<script>if (a < b && c) { document.write('</p>'); }</script>"
+                   "visible";
+    EXPECT_EQ(plain(html), "visible");
+    EXPECT_EQ(plain("<SCRIPT type=\"text/javascript\">x</SCRIPT>after"), "after");
+}
+
+TEST(HtmlTokenizerTest, BlockElementsBecomeLineBreaks) {
+    EXPECT_EQ(plain("<h1>Title</h1><p>First</p><p>Second<br>line</p><div><div>Nested</div></div>"),
+              "Title\nFirst\nSecond\nline\nNested");
+    EXPECT_EQ(plain("<ul><li>one</li><li>two</li></ul>"), "one\ntwo");
+}
+
+TEST(HtmlTokenizerTest, DecodesEntities) {
+    EXPECT_EQ(plain("&lt;tag&gt; &amp; &quot;q&quot; &apos;a&apos;"), "<tag> & \"q\" 'a'");
+    EXPECT_EQ(HtmlTokenizer::toPlainText("&eacute;&#233;&#xE9;&euro;"), QString::fromUtf8("ééé€"));
+    EXPECT_EQ(HtmlTokenizer::toPlainText("&#x1F600;"), QString::fromUtf8("\xF0\x9F\x98\x80"));
+    EXPECT_EQ(plain("a&nbsp;b"), "a b");
+}
+
+TEST(HtmlTokenizerTest, KeepsMalformedMarkupAsText) {
+    EXPECT_EQ(plain("a < b &unknown; & c"), "a < b &unknown; & c");
+    EXPECT_EQ(plain("x &amp"), "x &amp");
+    EXPECT_EQ(plain("<a title=\"1 > 0\">link</a>"), "link");
+}
+
+TEST(HtmlTokenizerTest, AppendsFragmentsWithoutTrimming) {
+    QString out = "prefix";
+    QString fragment = "<p>text</p>";
+    HtmlTokenizer::appendPlainText(fragment.constData(), fragment.size(), out);
+    EXPECT_EQ(out.toStdString(), "prefixtext\n");
+}
+
+TEST(HtmlTokenizerTest, RichTextKeepsInlineStyles) {
+    QVector<TextFormatRun> runs;
+    QString text = HtmlTokenizer::toRichText(
+        "<p>plain <b>bold <i>both</i></b> <font color=\"#ff0000\">red</font></p>", runs);
+    EXPECT_EQ(text, HtmlTokenizer::toPlainText(
+        "<p>plain <b>bold <i>both</i></b> <font color=\"#ff0000\">red</font></p>"));
+    ASSERT_EQ(runs.size(), 3);
+    EXPECT_EQ(runs[0].start, 6);
+    EXPECT_TRUE(runs[0].style.bold);
+    EXPECT_FALSE(runs[0].style.italic);
+    EXPECT_EQ(runs[1].start, 11);
+    EXPECT_TRUE(runs[1].style.bold && runs[1].style.italic);
+    EXPECT_EQ(runs[2].start, 16);
+    EXPECT_FALSE(runs[2].style.bold);
+    EXPECT_EQ(runs[2].style.color, QColor(255, 0, 0));
+}
+
+TEST(HtmlTokenizerTest, RichTextReadsStyleAttributesAndTrims) {
+    QVector<TextFormatRun> runs;
+    QString text = HtmlTokenizer::toRichText(
+        "<br><span style=\"color: blue; font-weight: 700\">s</span><em>e</em>", runs);
+    EXPECT_EQ(text.toStdString(), "se");
+    ASSERT_EQ(runs.size(), 2);
+    // Позиции сдвинуты на отброшенный в начале перевод строки
+    EXPECT_EQ(runs[0].start, 0);
+    EXPECT_TRUE(runs[0].style.bold);
+    EXPECT_EQ(runs[0].style.color, QColor(Qt::blue));
+    EXPECT_EQ(runs[1].start, 1);
+    EXPECT_TRUE(runs[1].style.italic);
+    EXPECT_FALSE(runs[1].style.color.isValid());
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "LineBuffer.hpp"
+#include <QDir>
+#include <QFile>
+#include <stdexcept>
+
+class LineBufferTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = QDir::tempPath() + "/line_buffer_test.txt";
+    }
+
+    void TearDown() override {
+        QFile::remove(path);
+    }
+
+    void writeFile(const QByteArray& data) {
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(data);
+    }
+
+    QString path;
+};
+
+TEST_F(LineBufferTest, SplitsLinesLikeDocumentBlocks) {
+    LineBuffer buffer(QByteArray("first\nsecond\r\n\nlast"));
+    ASSERT_EQ(buffer.lineCount(), 4);
+    EXPECT_EQ(buffer.line(0), QString("first"));
+    EXPECT_EQ(buffer.line(1), QString("second"));
+    EXPECT_EQ(buffer.line(2), QString());
+    EXPECT_EQ(buffer.line(3), QString("last"));
+    EXPECT_EQ(buffer.lineStart(3), 15);
+}
+
+TEST_F(LineBufferTest, TrailingLineBreakStartsEmptyLine) {
+    LineBuffer buffer(QByteArray("one\ntwo\n"));
+    ASSERT_EQ(buffer.lineCount(), 3);
+    EXPECT_EQ(buffer.line(2), QString());
+}
+
+TEST_F(LineBufferTest, EmptyBufferHasOneLine) {
+    LineBuffer buffer((QByteArray()));
+    EXPECT_EQ(buffer.lineCount(), 1);
+    EXPECT_EQ(buffer.line(0), QString());
+    EXPECT_TRUE(buffer.text().isEmpty());
+}
+
+TEST_F(LineBufferTest, FindsLinesBetweenCheckpoints) {
+    QByteArray data;
+    const int lineCount = LineBuffer::checkpointInterval * 5 + 7;
+    for (int i = 0; i < lineCount; ++i) {
+        data += "line " + QByteArray::number(i) + "\n";
+    }
+    LineBuffer buffer(data);
+    ASSERT_EQ(buffer.lineCount(), lineCount + 1);
+    for (int i = 0; i < lineCount; ++i) {
+        EXPECT_EQ(buffer.line(i), QString("line %1").arg(i)) << i;
+    }
+}
+
+TEST_F(LineBufferTest, DecodesUtf8) {
+    LineBuffer buffer(QString::fromUtf8("Привет\nмир 😀").toUtf8());
+    EXPECT_EQ(buffer.line(0), QString::fromUtf8("Привет"));
+    EXPECT_EQ(buffer.line(1), QString::fromUtf8("мир 😀"));
+    EXPECT_EQ(buffer.text(), QString::fromUtf8("Привет\nмир 😀"));
+}
+
+TEST_F(LineBufferTest, CutsLongLinesOnCharacterBoundary) {
+    // После первого байта двухбайтовые символы ставят границу отреза внутрь последовательности
+    QByteArray data = "a" + QString(LineBuffer::maxLineLength, QChar(0x0416)).toUtf8();
+    LineBuffer buffer(data);
+    QString line = buffer.line(0);
+    EXPECT_EQ(line.size(), LineBuffer::maxLineLength / 2);
+    EXPECT_FALSE(line.contains(QChar::ReplacementCharacter));
+}
+
+TEST_F(LineBufferTest, RejectsLineOutOfRange) {
+    LineBuffer buffer(QByteArray("a\nb"));
+    EXPECT_THROW(buffer.line(2), std::out_of_range);
+    EXPECT_THROW(buffer.line(-1), std::out_of_range);
+}
+
+TEST_F(LineBufferTest, MapsFile) {
+    writeFile("alpha\nbeta\ngamma\n");
+    LineBuffer buffer(path);
+    EXPECT_EQ(buffer.filePath(), path);
+    EXPECT_EQ(buffer.size(), 17);
+    ASSERT_EQ(buffer.lineCount(), 4);
+    EXPECT_EQ(buffer.line(1), QString("beta"));
+    EXPECT_EQ(buffer.text(), QString("alpha\nbeta\ngamma\n"));
+}
+
+TEST_F(LineBufferTest, MapsEmptyFile) {
+    writeFile(QByteArray());
+    LineBuffer buffer(path);
+    EXPECT_EQ(buffer.lineCount(), 1);
+    EXPECT_EQ(buffer.line(0), QString());
+}
+
+TEST_F(LineBufferTest, RejectsUtf16Files) {
+    writeFile("plain\ntext\n");
+    EXPECT_TRUE(LineBuffer::canRead(path));
+    writeFile(QByteArray("\xFF\xFEa\0\n\0", 6));
+    EXPECT_FALSE(LineBuffer::canRead(path));
+    EXPECT_FALSE(LineBuffer::canRead(QDir::tempPath() + "/line_buffer_missing.txt"));
+}
+
+TEST_F(LineBufferTest, ThrowsForMissingFile) {
+    EXPECT_THROW(LineBuffer(QDir::tempPath() + "/line_buffer_missing.txt"), std::runtime_error);
+}
+
+TEST_F(LineBufferTest, IndexIsSparse) {
+    QByteArray data;
+    for (int i = 0; i < 100000; ++i) {
+        data += "x\n";
+    }
+    writeFile(data);
+    LineBuffer buffer(path);
+    EXPECT_EQ(buffer.line(99999), QString("x"));
+    // Индекс хранит одну позицию на checkpointInterval строк
+    EXPECT_LE(buffer.memoryUsage(), 100000 / LineBuffer::checkpointInterval * 8 * 2);
+}
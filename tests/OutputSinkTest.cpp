@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include <QBuffer>
+#include "OutputSink.hpp"
+
+TEST(OutputSinkTest, EncodesUtf8AcrossBufferBoundaries) {
+    QBuffer device;
+    device.open(QIODevice::WriteOnly);
+    QString text = QString::fromUtf8("ascii é Привет 😀 end");
+    {
+        // Буфер меньше текста: запись идет несколькими порциями
+        OutputSink sink(&device, 16);
+        sink.write(QLatin1String("<"));
+        sink.write(text.constData(), text.size());
+        sink.write(QLatin1String(">"));
+        EXPECT_TRUE(sink.flush());
+    }
+    EXPECT_EQ(device.data(), "<" + text.toUtf8() + ">");
+}
+
+TEST(OutputSinkTest, SurrogatePairSplitBetweenWrites) {
+    QBuffer device;
+    device.open(QIODevice::WriteOnly);
+    QString emoji = QString::fromUtf8("😀");
+    ASSERT_EQ(emoji.size(), 2);
+
+    OutputSink sink(&device);
+    sink.write(emoji.at(0));
+    sink.write(emoji.at(1));
+    // Непарный суррогат заменяется на U+FFFD
+    sink.write(emoji.at(0));
+    sink.write(QLatin1String("x"));
+    ASSERT_TRUE(sink.flush());
+    EXPECT_EQ(device.data(), emoji.toUtf8() + "\xEF\xBF\xBDx");
+}
+
+TEST(OutputSinkTest, ReportsDeviceErrors) {
+    QBuffer device;
+    // Устройство не открыто для записи
+    OutputSink sink(&device);
+    sink.write(QLatin1String("text"));
+    EXPECT_FALSE(sink.flush());
+    EXPECT_TRUE(sink.hasError());
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <QDir>
+#include <QFile>
+#include "ParallelConverter.hpp"
+#include "HtmlTokenizer.hpp"
+#include "DocumentAdapter.hpp"
+
+namespace {
+
+QString generateHtml() {
+    QString html = "<!DOCTYPE html>\n<html><head><title>T</title>"
+                   "<style>p > b { color: red; }</style></head><body>\n";
+    for (int i = 0; i < 200; ++i) {
+        html += QString("<p class=\"a>b\">Row %1 &amp; <b>bold</b>  text&nbsp;</p>"
+                        "<!-- <div>hidden %1</div> -->"
+                        "<script>if (a < b) document.write('<p>x</p>');</script>"
+                        "tail %1<br>line<div><div>nested</div></div>\n").arg(i);
+    }
+    return html + "</body></html>";
+}
+
+QString generateXml() {
+    QString xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                  "<!-- export -->\n<root xmlns:x=\"urn:x\" a='1>2'>\n";
+    for (int i = 0; i < 200; ++i) {
+        xml += QString("  <x:item id=\"%1\">Item %1 &amp; <![CDATA[<raw>]]> text<empty/>"
+                       "<sub>  nested %1 </sub></x:item>\n  <?pi data?>\n").arg(i);
+    }
+    return xml + "</root>\n";
+}
+
+} // namespace
+
+TEST(ParallelConverterTest, HtmlMatchesSequentialConversion) {
+    QString html = generateHtml();
+    QString expected = HtmlTokenizer::toPlainText(html);
+
+    // Маленькие фрагменты дают сотни точек разбиения
+    for (int chunkSize : {1, 37, 500, 1 << 20}) {
+        ParallelConverter converter(4, chunkSize);
+        EXPECT_EQ(converter.htmlToPlainText(html), expected) << chunkSize;
+    }
+    EXPECT_FALSE(HtmlTokenizer::findSplitPoints(html.constData(), html.size(), 37).isEmpty());
+}
+
+TEST(ParallelConverterTest, XmlMatchesAdapter) {
+    QString xml = generateXml();
+    QString path = QDir::tempPath() + "/parallel_test.xml";
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(xml.toUtf8());
+    file.close();
+    QString expected = XmlDocumentAdapter().loadDocument(path);
+    QFile::remove(path);
+
+    int rootStart = 0;
+    int rootStartEnd = 0;
+    QString rootName;
+    EXPECT_FALSE(ParallelConverter::findXmlSplitPoints(xml, 37, rootStart, rootStartEnd, rootName).isEmpty());
+    EXPECT_EQ(rootName, "root");
+
+    for (int chunkSize : {1, 37, 500, 1 << 20}) {
+        ParallelConverter converter(4, chunkSize);
+        EXPECT_EQ(converter.xmlToPlainText(xml), expected) << chunkSize;
+    }
+}
+
+TEST(ParallelConverterTest, XmlFallsBackToSequential) {
+    int rootStart = 0;
+    int rootStartEnd = 0;
+    QString rootName;
+    QString withDtd = "<!DOCTYPE r [<!ENTITY e \"value\">]><r><a>&e;</a><b>x</b></r>";
+    EXPECT_TRUE(ParallelConverter::findXmlSplitPoints(withDtd, 1, rootStart, rootStartEnd, rootName).isEmpty());
+
+    ParallelConverter converter(2, 1);
+    EXPECT_EQ(converter.xmlToPlainText(withDtd), "value\nx");
+    EXPECT_THROW(converter.xmlToPlainText("<r><a>1</a><b>2</c></r>"), std::runtime_error);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "RetiringThreads.hpp"
+
+TEST(RetiringThreadsTest, WaitJoinsCurrentJob) {
+    std::atomic<int> runs(0);
+    RetiringThreads threads;
+    threads.start([&runs]() { ++runs; });
+    threads.wait();
+    EXPECT_EQ(runs.load(), 1);
+    // Повторное ожидание без задачи не блокирует
+    threads.wait();
+}
+
+TEST(RetiringThreadsTest, StartDoesNotWaitForReplacedJob) {
+    std::atomic<bool> stop(false);
+    std::atomic<int> runs(0);
+    RetiringThreads threads;
+    threads.start([&stop]() {
+        while (!stop.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    // Замененная задача еще работает, но новая начинается сразу
+    threads.start([&runs]() { ++runs; });
+    threads.wait();
+    EXPECT_EQ(runs.load(), 1);
+
+    stop = true;
+    threads.joinAll();
+}
+
+TEST(RetiringThreadsTest, DestructorJoinsRetiredJobs) {
+    std::atomic<int> finished(0);
+    {
+        RetiringThreads threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.start([&finished]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                ++finished;
+            });
+        }
+        threads.retire();
+    }
+    EXPECT_EQ(finished.load(), 4);
+}
+
+TEST(RetiringThreadsTest, RetireSkipsJobsStillRunning) {
+    std::atomic<bool> stop(false);
+    std::atomic<int> finished(0);
+    RetiringThreads threads;
+    threads.start([&stop]() {
+        while (!stop.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    threads.start([&finished]() { ++finished; });
+    threads.wait();
+    // Первая задача еще работает: retire присоединяет только завершившиеся
+    threads.retire();
+    threads.retire();
+    EXPECT_EQ(finished.load(), 1);
+
+    stop = true;
+    threads.joinAll();
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <QDir>
+#include <QFile>
+#include "RtfParser.hpp"
+#include "DocumentAdapter.hpp"
+
+namespace {
+
+std::string plain(const QString& rtf) {
+    return RtfParser::toPlainText(rtf).toStdString();
+}
+
+} // namespace
+
+TEST(RtfParserTest, SkipsHeaderDestinations) {
+    QString rtf = "{\\rtf1\\ansi\\deff0{\\fonttbl{\\f0\\fnil Arial;}{\\f1 Times;}}"
+                  "{\\colortbl;\\red255\\green0\\blue0;}{\\*\\generator Writer 1.0;}"
+                  "{\\info{\\title Secret}}\\pard\\f0 Hello {\\b bold} world}";
+    EXPECT_EQ(plain(rtf), "Hello bold world");
+}
+
+TEST(RtfParserTest, ControlWordsAndSymbols) {
+    EXPECT_EQ(plain("{\\rtf1 one\\par two\\line three\\tab four}"), "one\ntwo\nthree\tfour");
+    EXPECT_EQ(plain("{\\rtf1 a\\\\b \\{c\\} d}"), "a\\b {c} d");
+    // Разделяющий пробел после управляющего слова не входит в текст
+    EXPECT_EQ(plain("{\\rtf1 \\b  x\\b0 y}"), " xy");
+}
+
+TEST(RtfParserTest, DecodesHexEscapesWithCodePage) {
+    EXPECT_EQ(RtfParser::toPlainText("{\\rtf1\\ansi\\ansicpg1252 caf\\'e9}"),
+              QString::fromUtf8("café"));
+    EXPECT_EQ(RtfParser::toPlainText("{\\rtf1\\ansi\\ansicpg1251 \\'cf\\'f0\\'e8\\'e2\\'e5\\'f2}"),
+              QString::fromUtf8("Привет"));
+}
+
+TEST(RtfParserTest, DecodesUnicodeWithFallback) {
+    EXPECT_EQ(RtfParser::toPlainText("{\\rtf1 \\u1055?\\u1088?}"), QString::fromUtf8("Пр"));
+    EXPECT_EQ(RtfParser::toPlainText("{\\rtf1\\uc2 \\u-3913\\'3f\\'3fx}"), QString(QChar(0xF0B7)) + "x");
+    EXPECT_EQ(RtfParser::toPlainText("{\\rtf1\\uc0 \\u233 x}"), QString::fromUtf8("éx"));
+}
+
+TEST(RtfParserTest, RoundTripThroughAdapter) {
+    QString tempPath = QDir::tempPath() + "/roundtrip.rtf";
+    RtfDocumentAdapter adapter;
+    QString text = QString::fromUtf8("Line {one}\\\n\tТекст\n  indented 😀\n\n");
+
+    adapter.saveDocument(tempPath, text);
+    EXPECT_EQ(adapter.loadDocument(tempPath), text);
+
+    QFile::remove(tempPath);
+}
+
+TEST(RtfParserTest, RichTextKeepsBoldItalicAndColor) {
+    QString rtf = "{\\rtf1{\\colortbl;\\red255\\green0\\blue0;}a\\b b\\b0 {\\i i}\\cf1 r\\plain p}";
+    QVector<TextFormatRun> runs;
+    QString text = RtfParser::toRichText(rtf, runs);
+    EXPECT_EQ(text, RtfParser::toPlainText(rtf));
+    EXPECT_EQ(text.toStdString(), "abirp");
+    ASSERT_EQ(runs.size(), 4);
+    EXPECT_EQ(runs[0].start, 1);
+    EXPECT_TRUE(runs[0].style.bold);
+    EXPECT_EQ(runs[1].start, 2);
+    EXPECT_TRUE(runs[1].style.italic);
+    EXPECT_FALSE(runs[1].style.bold);
+    EXPECT_EQ(runs[2].start, 3);
+    EXPECT_EQ(runs[2].style.color, QColor(255, 0, 0));
+    EXPECT_EQ(runs[3].start, 4);
+    EXPECT_TRUE(runs[3].style == TextStyle());
+}
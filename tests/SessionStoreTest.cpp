@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <QDir>
+#include <QFile>
+#include "SessionStore.hpp"
+
+class SessionStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sessionPath = QDir::tempPath() + "/session_test.bin";
+        QFile::remove(sessionPath);
+    }
+
+    void TearDown() override {
+        QFile::remove(sessionPath);
+    }
+
+    QString sessionPath;
+};
+
+TEST_F(SessionStoreTest, SaveAndRestoreEntries) {
+    SessionEntry saved;
+    saved.filePath = "/tmp/notes.txt";
+    saved.title = "notes.txt";
+    saved.cursorPosition = 12;
+    saved.scrollPosition = 340;
+    saved.fileSize = 2048;
+    saved.fileModified = 1700000000000;
+    saved.charCount = 100;
+    saved.wordCount = 20;
+    saved.lineIndex = {0, 5, 300, 70000};
+
+    SessionEntry unsaved;
+    unsaved.title = "Untitled";
+    unsaved.hasBuffer = true;
+    unsaved.buffer = QString::fromUtf8("Несохраненный текст\nвторая строка");
+
+    SessionStore(sessionPath).save({saved, unsaved}, 1);
+
+    SessionStore store(sessionPath);
+    ASSERT_TRUE(store.open());
+    ASSERT_EQ(store.entryCount(), 2);
+    EXPECT_EQ(store.currentIndex(), 1);
+
+    SessionEntry first = store.entry(0);
+    EXPECT_EQ(first.filePath, saved.filePath);
+    EXPECT_EQ(first.cursorPosition, 12);
+    EXPECT_EQ(first.scrollPosition, 340);
+    EXPECT_EQ(first.fileModified, saved.fileModified);
+    EXPECT_EQ(first.wordCount, 20);
+    EXPECT_EQ(first.lineIndex, saved.lineIndex);
+    EXPECT_FALSE(first.hasBuffer);
+
+    SessionEntry second = store.entry(1);
+    EXPECT_TRUE(second.hasBuffer);
+    EXPECT_EQ(second.buffer, unsaved.buffer);
+
+    // Метаданные читаются без декодирования буфера
+    EXPECT_TRUE(store.entry(1, false).buffer.isEmpty());
+}
+
+TEST_F(SessionStoreTest, RejectsInvalidFile) {
+    SessionStore missing(sessionPath);
+    EXPECT_FALSE(missing.open());
+
+    QFile file(sessionPath);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("not a session file");
+    file.close();
+
+    SessionStore store(sessionPath);
+    EXPECT_FALSE(store.open());
+}
+
+TEST_F(SessionStoreTest, BuildLineIndex) {
+    QVector<qint32> expected = {0, 4, 5};
+    EXPECT_EQ(SessionStore::buildLineIndex("abc\n\nd"), expected);
+}
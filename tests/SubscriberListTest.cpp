@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "SubscriberList.hpp"
+#include "DocumentObserver.hpp"
+#include <thread>
+
+namespace {
+
+struct Counter {
+    std::atomic<int> calls{0};
+};
+
+int notifyAll(const SubscriberList<Counter>& list) {
+    int visited = 0;
+    list.forEach([&visited](const std::shared_ptr<Counter>& counter) {
+        counter->calls.fetch_add(1);
+        ++visited;
+    });
+    return visited;
+}
+
+class CountingObserver : public IDocumentObserver {
+public:
+    void update(const QString&) override { ++updates; }
+    int updates = 0;
+};
+
+} // namespace
+
+TEST(SubscriberListTest, DetachesThroughHandle) {
+    SubscriberList<Counter> list;
+    auto first = std::make_shared<Counter>();
+    auto second = std::make_shared<Counter>();
+    Subscription firstSubscription = list.subscribe(first);
+    list.subscribe(second);
+    EXPECT_EQ(notifyAll(list), 2);
+
+    EXPECT_TRUE(firstSubscription.isActive());
+    firstSubscription.detach();
+    EXPECT_FALSE(firstSubscription.isActive());
+    // Повторный вызов ничего не делает
+    firstSubscription.detach();
+
+    EXPECT_EQ(notifyAll(list), 1);
+    EXPECT_EQ(first->calls.load(), 1);
+    EXPECT_EQ(second->calls.load(), 2);
+    EXPECT_EQ(list.count(), 1);
+}
+
+TEST(SubscriberListTest, HoldsObserversWeakly) {
+    SubscriberList<Counter> list;
+    auto kept = std::make_shared<Counter>();
+    list.subscribe(kept);
+    std::weak_ptr<Counter> dropped;
+    {
+        auto temporary = std::make_shared<Counter>();
+        dropped = temporary;
+        list.subscribe(temporary);
+    }
+    EXPECT_TRUE(dropped.expired());
+    EXPECT_EQ(notifyAll(list), 1);
+
+    // Слот уничтоженного наблюдателя убирается следующей записью
+    auto added = std::make_shared<Counter>();
+    list.subscribe(added);
+    EXPECT_EQ(list.capacity(), 2);
+}
+
+TEST(SubscriberListTest, CompactsDetachedSlots) {
+    SubscriberList<Counter> list;
+    std::vector<std::shared_ptr<Counter>> counters;
+    std::vector<Subscription> subscriptions;
+    for (int i = 0; i < 100; ++i) {
+        counters.push_back(std::make_shared<Counter>());
+        subscriptions.push_back(list.subscribe(counters.back()));
+    }
+    for (int i = 0; i < 99; ++i) {
+        subscriptions[i].detach();
+    }
+    EXPECT_EQ(list.count(), 1);
+    // Выключенных слотов не больше половины массива
+    EXPECT_LE(list.capacity(), 3);
+}
+
+TEST(SubscriberListTest, DetachDuringNotifyKeepsIteration) {
+    SubscriberList<Counter> list;
+    auto first = std::make_shared<Counter>();
+    auto second = std::make_shared<Counter>();
+    Subscription firstSubscription = list.subscribe(first);
+    Subscription secondSubscription = list.subscribe(second);
+
+    int visited = 0;
+    list.forEach([&](const std::shared_ptr<Counter>&) {
+        ++visited;
+        secondSubscription.detach();
+        list.subscribe(std::make_shared<Counter>());
+    });
+    // Обход идет по снимку: отписанный позже не вызывается, новый не виден
+    EXPECT_EQ(visited, 1);
+    EXPECT_EQ(list.count(), 1);
+}
+
+TEST(SubscriberListTest, ConcurrentAttachDetachAndNotify) {
+    SubscriberList<Counter> list;
+    auto permanent = std::make_shared<Counter>();
+    list.subscribe(permanent);
+
+    std::atomic<bool> running{true};
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 4; ++w) {
+        writers.emplace_back([&list, w] {
+            std::vector<std::shared_ptr<Counter>> owned;
+            std::vector<Subscription> subscriptions;
+            for (int i = 0; i < 1000; ++i) {
+                owned.push_back(std::make_shared<Counter>());
+                subscriptions.push_back(list.subscribe(owned.back()));
+                if (i % 3 == w % 3) {
+                    subscriptions[i / 2].detach();
+                }
+                if (i % 5 == 0) {
+                    // Уничтоженный наблюдатель без отписки
+                    owned[i / 2].reset();
+                }
+            }
+            for (auto& subscription : subscriptions) subscription.detach();
+        });
+    }
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&list, &running] {
+            while (running.load()) {
+                notifyAll(list);
+            }
+        });
+    }
+
+    for (auto& writer : writers) writer.join();
+    running.store(false);
+    for (auto& reader : readers) reader.join();
+
+    EXPECT_EQ(list.count(), 1);
+    EXPECT_GT(permanent->calls.load(), 0);
+    EXPECT_EQ(notifyAll(list), 1);
+}
+
+TEST(SubscriberListTest, DocumentSubjectSkipsDestroyedObservers) {
+    DocumentSubject subject;
+    auto kept = std::make_shared<CountingObserver>();
+    Subscription subscription = subject.attach(kept);
+    {
+        auto temporary = std::make_shared<CountingObserver>();
+        subject.attach(temporary);
+    }
+    subject.notify("text");
+    EXPECT_EQ(kept->updates, 1);
+
+    subscription.detach();
+    subject.notify("text");
+    EXPECT_EQ(kept->updates, 1);
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "DecoratedText.hpp"
+
+namespace {
+
+// Компонент без виджета: текст и отрезки меняются напрямую
+class FakeComponent : public TextComponent {
+public:
+    QString getText() override {
+        return text.get(revision(), [this]() {
+            ++textBuilds;
+            return content;
+        });
+    }
+    void setText(const QString& value) override {
+        content = value;
+        attributes.edit(0, attributes.length(), value.size());
+    }
+    QString getFormattedText() override { return getText(); }
+    AttributeRuns& getAttributes() override { return attributes; }
+    void applyStyle(int start, int length, const AttributeRuns::StyleChange& change) override {
+        attributes.apply(start, length, change);
+    }
+    quint64 revision() override { return attributes.revision(); }
+    qint64 cachedBytes() override { return text.memoryUsage(); }
+
+    int textBuilds = 0;
+
+private:
+    QString content;
+    AttributeRuns attributes;
+    RevisionCache text;
+};
+
+} // namespace
+
+TEST(TextDecoratorTest, DecoratorsSetRunsInsteadOfTags) {
+    auto component = std::make_shared<FakeComponent>();
+    auto italic = std::make_shared<ItalicDecorator>(component);
+    BoldDecorator bold(italic);
+
+    bold.setText("Hello");
+    EXPECT_EQ(bold.getText().toStdString(), "Hello");
+    QVector<TextFormatRun> runs = component->getAttributes().runs();
+    ASSERT_EQ(runs.size(), 1);
+    EXPECT_TRUE(runs[0].style.bold);
+    EXPECT_TRUE(runs[0].style.italic);
+
+    ColorDecorator color(component, Qt::red);
+    color.applyTo(1, 2);
+    runs = component->getAttributes().query(0, 5);
+    ASSERT_EQ(runs.size(), 3);
+    EXPECT_EQ(runs[1].style.color, QColor(Qt::red));
+    EXPECT_TRUE(runs[1].style.bold);
+}
+
+TEST(TextDecoratorTest, OutputIsCachedPerRevision) {
+    auto component = std::make_shared<FakeComponent>();
+    BoldDecorator bold(std::make_shared<ItalicDecorator>(component));
+    bold.setText("text");
+
+    quint64 revision = bold.revision();
+    EXPECT_EQ(revision, component->revision());
+    bold.getText();
+    bold.getText();
+    bold.getFormattedText();
+    EXPECT_EQ(component->textBuilds, 1);
+
+    // Изменение форматирования через любой уровень цепочки сбрасывает кэш
+    bold.applyTo(0, 2);
+    EXPECT_NE(bold.revision(), revision);
+    bold.getText();
+    EXPECT_EQ(component->textBuilds, 2);
+}
+
+TEST(TextDecoratorTest, CompileTimeChainMatchesRuntimeChain) {
+    auto component = std::make_shared<FakeComponent>();
+    auto italic = std::make_shared<ItalicDecorator>(component);
+    auto color = std::make_shared<ColorDecorator>(italic, Qt::green);
+    BoldDecorator runtime(color);
+    runtime.setText("runtime chain");
+
+    Decorated<FakeComponent, Italic, Color, Bold> fused;
+    static_cast<Color&>(fused).color = Qt::green;
+    fused.setText("runtime chain");
+    fused.applyTo(3, 4);
+
+    QVector<TextFormatRun> expected = component->getAttributes().runs();
+    QVector<TextFormatRun> actual = fused.getAttributes().runs();
+    ASSERT_EQ(actual.size(), expected.size());
+    EXPECT_TRUE(actual[0].style == expected[0].style);
+    EXPECT_TRUE(actual[0].style.bold && actual[0].style.italic);
+    EXPECT_EQ(actual[0].style.color, QColor(Qt::green));
+    EXPECT_EQ(fused.getText(), runtime.getText());
+}
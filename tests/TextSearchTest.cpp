@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "TextSearch.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+
+QVector<int> starts(const QVector<SearchMatch>& matches) {
+    QVector<int> result;
+    for (const SearchMatch& match : matches) {
+        result.append(match.start);
+    }
+    return result;
+}
+
+SearchOptions regexOptions(bool caseSensitive = true) {
+    SearchOptions options;
+    options.regularExpression = true;
+    options.caseSensitive = caseSensitive;
+    return options;
+}
+
+} // namespace
+
+TEST(TextSearchTest, FindsLiteralMatches) {
+    TextSearch search("ab");
+    EXPECT_EQ(starts(search.findAll("ab cab abab b")), QVector<int>({0, 4, 7, 9}));
+}
+
+TEST(TextSearchTest, MatchesDoNotOverlap) {
+    TextSearch search("aa");
+    EXPECT_EQ(starts(search.findAll("aaaaa")), QVector<int>({0, 2}));
+}
+
+TEST(TextSearchTest, FindsNonAsciiPatterns) {
+    // Первый байт 'Ā' (U+0100) в UTF-16 нулевой, поиск идет по второму
+    QString text = QString::fromUtf8("xĀbĀb ĀĀb") + QChar(0x6100) + "b";
+    EXPECT_EQ(starts(TextSearch(QString::fromUtf8("Āb")).findAll(text)), QVector<int>({1, 3, 7}));
+    EXPECT_EQ(starts(TextSearch(QString::fromUtf8("мир")).findAll(QString::fromUtf8("мир, миру мир"))),
+              QVector<int>({0, 5, 10}));
+}
+
+TEST(TextSearchTest, IgnoresCaseWhenAsked) {
+    SearchOptions options;
+    options.caseSensitive = false;
+    EXPECT_EQ(starts(TextSearch("Hello", options).findAll("hello HELLO help")), QVector<int>({0, 6}));
+    EXPECT_TRUE(TextSearch("Hello").findAll("hello HELLO").isEmpty());
+}
+
+TEST(TextSearchTest, FindNextStartsAtPosition) {
+    TextSearch search("ab");
+    SearchMatch match;
+    ASSERT_TRUE(search.findNext("ab ab", 1, match));
+    EXPECT_EQ(match.start, 3);
+    EXPECT_EQ(match.length, 2);
+    EXPECT_FALSE(search.findNext("ab ab", 4, match));
+}
+
+TEST(TextSearchTest, RejectsEmptyAndInvalidPatterns) {
+    EXPECT_THROW(TextSearch(QString()), std::invalid_argument);
+    EXPECT_THROW(TextSearch("(unclosed", regexOptions()), std::invalid_argument);
+}
+
+TEST(TextSearchTest, RegularExpressionMatchesPerLine) {
+    TextSearch search("^\\w+", regexOptions());
+    QVector<SearchMatch> matches = search.findAll("first line\nsecond line");
+    ASSERT_EQ(matches.size(), 2);
+    EXPECT_EQ(matches[1].start, 11);
+    EXPECT_EQ(matches[1].length, 6);
+}
+
+TEST(TextSearchTest, ReplaceAllBuildsNewText) {
+    TextSearch search("cat");
+    EXPECT_EQ(search.replaceAll("cat, cats and a bobcat", "dog"), QString("dog, dogs and a bobdog"));
+    EXPECT_EQ(search.replaceAll("no match", "dog"), QString("no match"));
+}
+
+TEST(TextSearchTest, ReplaceAllExpandsCaptures) {
+    TextSearch search("(\\w+)@(\\w+)", regexOptions());
+    EXPECT_EQ(search.replaceAll("alice@home, bob@work", "\\2:\\1"), QString("home:alice, work:bob"));
+    // Литеральная замена вставляется как есть
+    EXPECT_EQ(TextSearch("a").replaceAll("a", "\\1"), QString("\\1"));
+}
+
+TEST(TextSearchTest, ExpandMatchesReplaceAll) {
+    TextSearch search("(\\d+)px", regexOptions());
+    QString text = "width: 10px; height: 200px";
+    QVector<SearchMatch> matches = search.findAll(text);
+    ASSERT_EQ(matches.size(), 2);
+    EXPECT_EQ(search.expand(text, matches[1], "\\1em"), QString("200em"));
+}
+
+TEST(TextSearchTest, ReplaceAllHandlesEmptyMatches) {
+    TextSearch search("^", regexOptions());
+    EXPECT_EQ(search.replaceAll("a\nb\nc", "> "), QString("> a\n> b\n> c"));
+}
+
+TEST(TextSearchTest, ReplaceAllReportsNewRanges) {
+    TextSearch search("o+", regexOptions());
+    QVector<Replacement> replaced;
+    EXPECT_EQ(search.replaceAll("foo boo o zoooo", "0", &replaced), QString("f0 b0 0 z0"));
+    ASSERT_EQ(replaced.size(), 4);
+    EXPECT_EQ(replaced[1].start, 4);
+    EXPECT_EQ(replaced[1].length, 1);
+    EXPECT_EQ(replaced[3].originalLength, 4);
+}
+
+TEST(TextSearchTest, BackgroundSearchDeliversAllMatches) {
+    QString text;
+    for (int i = 0; i < 20000; ++i) {
+        text += "needle hay ";
+    }
+
+    std::mutex mutex;
+    std::condition_variable done;
+    quint64 expected = 0;
+    int total = 0;
+    int batches = 0;
+    bool finished = false;
+    BackgroundSearch search([&](quint64 generation, const QVector<SearchMatch>& batch, bool last) {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Пачки отмененного поиска отбрасываются по поколению, как в редакторе
+        if (generation != expected) return;
+        total += batch.size();
+        ++batches;
+        finished = finished || last;
+        done.notify_all();
+    });
+
+    std::unique_lock<std::mutex> lock(mutex);
+    // Первый поиск отменяется вторым, его пачки не должны попасть в итог
+    search.start(text, TextSearch("hay"));
+    expected = search.start(text, TextSearch("needle"));
+    done.wait(lock, [&]() { return finished; });
+    EXPECT_EQ(total, 20000);
+    EXPECT_GE(batches, 20000 / BackgroundSearch::batchSize);
+}